@@ -4,6 +4,15 @@
 
 #include "IndexOutOfBound.h"
 #include "ElementNotExist.h"
+#include "VectorScan.h"
+#include "Parallel.h"
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
 
 /**
  * The ArrayList is just like vector in C++.
@@ -11,31 +20,78 @@
  * the length of the array of your internal implemention
  *
  * The iterator iterates in the order of the elements being loaded into this list
+ *
+ * The internal array is raw storage: only the first currentSize slots hold constructed
+ * elements, the spare ones are never default-constructed. Trivially-copyable elements are
+ * relocated with realloc, everything else is moved once into the new array.
+ *
+ * Iterator::remove() does not shift the tail on every call. It leaves a gap of removed
+ * slots that the iterator slides forward in O(1) per step, and which is compacted in one
+ * pass when the iteration reaches the end, when the iterator is destroyed, or by the next
+ * non-const call. Const methods read around the gap and never write to the list.
+ *
+ * ArrayList<T, N> with N > 0 keeps the first N elements inside the object itself and only
+ * moves to a heap array once the list grows past N, so short lists never allocate.
+ * ArrayList<T> (N = 0) always uses the heap.
  */
+template <class T, int N>
+class ArrayListInline
+{
+    alignas(T) unsigned char buffer[N * sizeof(T)];
+protected:
+    T *inlineData() const { return reinterpret_cast<T *>(const_cast<unsigned char *>(buffer)); }
+};
+
 template <class T>
-class ArrayList
+class ArrayListInline<T, 0>
+{
+protected:
+    T *inlineData() const { return NULL; }
+};
+
+template <class T, int N = 0>
+class ArrayList : private ArrayListInline<T, N>
 {
 private:
     T *data;
     int currentSize, maxSize;
+    int gapBegin, gapEnd;
 
 public:
 
+    /**
+     * An iterator that has removed elements compacts the list when it is destroyed, so it
+     * must not outlive the list.
+     */
     class Iterator
     {
     private:
         int position, status;
         ArrayList *arr;
 
+        /**
+         * Closes the gap once it reaches the end of the array, where no element has to move.
+         */
+        void settle()
+        {
+            if ((arr->gapBegin != arr->gapEnd) && (arr->gapEnd == arr->currentSize)) arr->closeGap();
+        }
+
     public:
         Iterator(ArrayList *ar):arr(ar), position(-1), status(0){};
+
+        ~Iterator()
+        {
+            arr->closeGap();
+        }
         /**
          * TODO Returns true if the iteration has more elements.
          */
         bool hasNext() const
         {
-            if (position == arr->currentSize - 1) return false;
-            return true;
+            int next = position + 1;
+            if ((arr->gapBegin != arr->gapEnd) && (next == arr->gapBegin)) next = arr->gapEnd;
+            return next < arr->currentSize;
         }
 
         /**
@@ -46,6 +102,11 @@ public:
         {
             if (!hasNext()) throw ElementNotExist("Arraylist:next:ElementNotExist");
 			status = 0;
+            if ((arr->gapBegin != arr->gapEnd) && (position + 1 == arr->gapBegin))
+            {
+                arr->data[arr->gapBegin++] = std::move(arr->data[arr->gapEnd++]);
+                settle();
+            }
             return arr->data[++position];
         }
 
@@ -60,22 +121,165 @@ public:
         void remove()
         {
             if ((position == -1) || (status == -1) || (position >= arr -> currentSize)) throw ElementNotExist("Arraylist:remove:ElimentNotExist");
-            arr->removeIndex(position);
+            if ((arr->gapBegin != arr->gapEnd) && (position + 1 == arr->gapBegin)) --arr->gapBegin;
+            else
+            {
+                arr->closeGap();
+                arr->gapBegin = position, arr->gapEnd = position + 1;
+            }
+            settle();
             status = -1;
 			position --;
         }
     };
 
 private:
+    static const bool trivial = std::is_trivially_copyable<T>::value;
+
+    static T *allocate(int n)
+    {
+        if (n == 0) return NULL;
+        T *p = static_cast<T *>(std::malloc(sizeof(T) * n));
+        if (p == NULL) throw std::bad_alloc();
+        return p;
+    }
+
+    bool isInline() const
+    {
+        return (N > 0) && (data == this->inlineData());
+    }
+
+    /**
+     * Leaves this list empty after its heap array has been handed over to another list.
+     */
+    void release()
+    {
+        data = this->inlineData();
+        currentSize = 0;
+        maxSize = N;
+    }
+
+    void destroy(int from, int to)
+    {
+        if (!std::is_trivially_destructible<T>::value)
+            for (int i = from; i < to; ++i) data[i].~T();
+    }
+
+    /**
+     * Moves the elements into an array of exactly newSize slots (newSize >= currentSize),
+     * or into the inline buffer when newSize <= N.
+     */
+    void reallocate(int newSize)
+    {
+        bool toInline = (N > 0) && (newSize <= N);
+        if (toInline && isInline()) return;
+        if (trivial && (newSize != 0) && !toInline && !isInline())
+        {
+            T *tmp = static_cast<T *>(std::realloc((void *)data, sizeof(T) * newSize));
+            if (tmp == NULL) throw std::bad_alloc();
+            data = tmp;
+        }
+        else
+        {
+            T *tmp = toInline ? this->inlineData() : allocate(newSize);
+            for (int i = 0; i < currentSize; ++i) new (tmp + i) T(std::move(data[i]));
+            destroy(0, currentSize);
+            if (!isInline()) std::free(data);
+            data = tmp;
+        }
+        maxSize = toInline ? N : newSize;
+    }
+
+    /**
+     * Moves the elements of the inline list x into this empty list, whose capacity is at least N.
+     */
+    void moveElements(ArrayList& x)
+    {
+        for (int i = 0; i < x.currentSize; ++i) new (data + i) T(std::move(x.data[i]));
+        currentSize = x.currentSize;
+        x.clear();
+    }
+
     void doubleSpace()
     {
-        T *tmp = new T[maxSize];
-        for (int i = 0; i < currentSize; ++i) tmp[i] = data[i];
-        maxSize <<= 1;
-        if (data != NULL) delete [] data;
-        data = new T[maxSize];
-        for (int i = 0; i < currentSize; ++i) data[i] = tmp[i];
-        delete [] tmp;
+        reallocate(maxSize == 0 ? 10 : maxSize << 1);
+    }
+
+    /**
+     * Shifts [index, currentSize) n slots to the right, index < currentSize.
+     * The vacated slots below currentSize stay constructed unless T is trivially copyable.
+     */
+    void shiftRight(int index, int n = 1)
+    {
+        if (trivial)
+        {
+            std::memmove((void *)(data + index + n), data + index, sizeof(T) * (currentSize - index));
+            return;
+        }
+        for (int i = currentSize - 1; i >= index; --i)
+            if (i + n >= currentSize) new (data + i + n) T(std::move(data[i]));
+            else data[i + n] = std::move(data[i]);
+    }
+
+    /**
+     * Stores v into slot i of a gap opened by shiftRight().
+     */
+    template <class U>
+    void put(int i, U&& v)
+    {
+        if (trivial || (i >= currentSize)) new (data + i) T(std::forward<U>(v));
+        else data[i] = std::forward<U>(v);
+    }
+
+    /**
+     * Removes [from, to) by shifting the tail left and destroying the vacated slots.
+     */
+    void eraseRange(int from, int to)
+    {
+        if (from == to) return;
+        if (trivial)
+            std::memmove((void *)(data + from), data + to, sizeof(T) * (currentSize - to));
+        else
+        {
+            for (int i = to; i < currentSize; ++i) data[i - to + from] = std::move(data[i]);
+            destroy(currentSize - (to - from), currentSize);
+        }
+        currentSize -= to - from;
+    }
+
+    /**
+     * Compacts away the slots removed through Iterator::remove().
+     */
+    void closeGap()
+    {
+        if (gapBegin == gapEnd) return;
+        int from = gapBegin, to = gapEnd;
+        gapBegin = gapEnd = 0;
+        eraseRange(from, to);
+    }
+
+    /**
+     * Returns the element at index, reading around the gap. The elements are the runs
+     * [0, gapBegin) and [gapEnd, currentSize) of the array.
+     */
+    const T& at(int index) const
+    {
+        return data[index < gapBegin ? index : index + (gapEnd - gapBegin)];
+    }
+
+    /**
+     * Copy-constructs the elements of x, read around its gap, into the raw slots at dest.
+     */
+    static void copyElements(T *dest, const ArrayList& x)
+    {
+        const T *runs[2][2] = { { x.data, x.data + x.gapBegin }, { x.data + x.gapEnd, x.data + x.currentSize } };
+        for (int r = 0; r < 2; ++r)
+        {
+            int n = (int)(runs[r][1] - runs[r][0]);
+            if (trivial) { if (n) std::memcpy((void *)dest, runs[r][0], sizeof(T) * n); }
+            else for (int i = 0; i < n; ++i) new (dest + i) T(runs[r][0][i]);
+            dest += n;
+        }
     }
 
 public:
@@ -83,9 +287,9 @@ public:
     /**
      * TODO Constructs an empty array list.
      */
-    ArrayList():currentSize(0), maxSize(10)
+    ArrayList():currentSize(0), maxSize(N > 0 ? N : 10), gapBegin(0), gapEnd(0)
     {
-        data = new T[maxSize];
+        data = N > 0 ? this->inlineData() : allocate(maxSize);
     }
 
     /**
@@ -93,7 +297,8 @@ public:
      */
     ~ArrayList()
     {
-        if (data != NULL) delete [] data;
+        destroy(0, currentSize);
+        if (!isInline()) std::free(data);
     }
 
     /**
@@ -102,24 +307,78 @@ public:
     ArrayList& operator=(const ArrayList& x)
     {
 		if (&x == this) return *this;
-        currentSize = x.currentSize;
-        maxSize = x.maxSize;
-        if (data != NULL) delete [] data;
-        data = new T[maxSize];
-        for (int i = 0; i < currentSize; ++i) data[i] = x.data[i];
+        clear();
+        if (maxSize < x.size()) reallocate(x.size());
+        copyElements(data, x);
+        currentSize = x.size();
         return *this;
     }
 
     /**
      * TODO Copy-constructor
      */
-    ArrayList(const ArrayList& x)
+    ArrayList(const ArrayList& x):gapBegin(0), gapEnd(0)
     {
-        currentSize = x.currentSize;
-        maxSize = x.maxSize;
-        // if (data != NULL) delete [] data;
-        data = new T[maxSize];
-        for (int i = 0; i < currentSize; ++i) data[i] = x.data[i];
+        currentSize = x.size();
+        if ((N > 0) && (currentSize <= N)) maxSize = N, data = this->inlineData();
+        else maxSize = x.maxSize, data = allocate(maxSize);
+        copyElements(data, x);
+    }
+
+    /**
+     * Move-constructor. x is left empty.
+     */
+    ArrayList(ArrayList&& x):gapBegin(0), gapEnd(0)
+    {
+        x.closeGap();
+        if (x.isInline())
+        {
+            data = this->inlineData(), maxSize = N, currentSize = 0;
+            moveElements(x);
+            return;
+        }
+        data = x.data, currentSize = x.currentSize, maxSize = x.maxSize;
+        x.release();
+    }
+
+    /**
+     * Move-assignment operator. x is left empty.
+     */
+    ArrayList& operator=(ArrayList&& x)
+    {
+        if (&x == this) return *this;
+        closeGap();
+        x.closeGap();
+        if (x.isInline())
+        {
+            clear();
+            moveElements(x);
+            return *this;
+        }
+        destroy(0, currentSize);
+        if (!isInline()) std::free(data);
+        data = x.data, currentSize = x.currentSize, maxSize = x.maxSize;
+        x.release();
+        return *this;
+    }
+
+    /**
+     * Exchanges the contents of this list and x, in O(1) unless one of them is inline.
+     */
+    void swap(ArrayList& x)
+    {
+        closeGap();
+        x.closeGap();
+        if (isInline() || x.isInline())
+        {
+            ArrayList tmp(std::move(x));
+            x = std::move(*this);
+            *this = std::move(tmp);
+            return;
+        }
+        std::swap(data, x.data);
+        std::swap(currentSize, x.currentSize);
+        std::swap(maxSize, x.maxSize);
     }
 
     /**
@@ -128,11 +387,39 @@ public:
      */
     bool add(const T& e)
     {
-        if (currentSize == maxSize) doubleSpace();
-        data[currentSize++] = e;
+        emplace(e);
         return true;
     }
 
+    /**
+     * Appends the specified element to the end of this list, moving from it.
+     * Always returns true.
+     */
+    bool add(T&& e)
+    {
+        emplace(std::move(e));
+        return true;
+    }
+
+    /**
+     * Constructs a new element from args in place at the end of this list.
+     */
+    template <class... Args>
+    void emplace(Args&&... args)
+    {
+        closeGap();
+        if (currentSize == maxSize)
+        {
+            // args may refer into data, so build the element before relocating
+            T tmp(std::forward<Args>(args)...);
+            doubleSpace();
+            new (data + currentSize++) T(std::move(tmp));
+            return;
+        }
+        new (data + currentSize) T(std::forward<Args>(args)...);
+        ++currentSize;
+    }
+
     /**
      * TODO Inserts the specified element to the specified position in this list.
      * The range of index parameter is [0, size], where index=0 means inserting to the head,
@@ -141,18 +428,111 @@ public:
      */
     void add(int index, const T& element)
     {
-        if ((index < 0) || (index > currentSize)) throw IndexOutOfBound("Arraylist:add:IndexOutOfBound");
+        emplaceAt(index, element);
+    }
+
+    /**
+     * Inserts the specified element to the specified position in this list, moving from it.
+     * @throw IndexOutOfBound
+     */
+    void add(int index, T&& element)
+    {
+        emplaceAt(index, std::move(element));
+    }
+
+    /**
+     * Constructs a new element from args at the specified position in this list.
+     * The range of index parameter is [0, size].
+     * @throw IndexOutOfBound
+     */
+    template <class... Args>
+    void emplaceAt(int index, Args&&... args)
+    {
+        closeGap();
+        if ((index < 0) || (index > currentSize)) throw IndexOutOfBound("Arraylist:emplaceAt:IndexOutOfBound");
+        if (index == currentSize)
+        {
+            emplace(std::forward<Args>(args)...);
+            return;
+        }
+        T tmp(std::forward<Args>(args)...);
         if (currentSize == maxSize) doubleSpace();
-        for (int i = currentSize; i > index; --i) data[i] = data[i - 1];
-        data[index] = element;
+        shiftRight(index);
+        put(index, std::move(tmp));
         ++currentSize;
     }
 
+    /**
+     * Inserts the elements of [first, last) at the specified position in this list,
+     * shifting the tail only once. The range must not point into this list.
+     * @throw IndexOutOfBound
+     */
+    template <class It>
+    void addAll(int index, It first, It last)
+    {
+        closeGap();
+        if ((index < 0) || (index > currentSize)) throw IndexOutOfBound("Arraylist:addAll:IndexOutOfBound");
+        int n = std::distance(first, last);
+        if (n == 0) return;
+        if (currentSize + n > maxSize) reallocate(std::max(currentSize + n, maxSize << 1));
+        if (index < currentSize) shiftRight(index, n);
+        for (int i = index; first != last; ++first, ++i) put(i, *first);
+        currentSize += n;
+    }
+
+    /**
+     * Inserts all elements of x at the specified position in this list.
+     * @throw IndexOutOfBound
+     */
+    void addAll(int index, const ArrayList& x)
+    {
+        if ((&x == this) || (x.gapBegin != x.gapEnd))
+        {
+            ArrayList tmp(x);
+            addAll(index, tmp);
+            return;
+        }
+        addAll(index, x.data, x.data + x.currentSize);
+    }
+
+    /**
+     * Removes the elements with index in [from, to) from this list.
+     * @throw IndexOutOfBound
+     */
+    void removeRange(int from, int to)
+    {
+        closeGap();
+        if ((from < 0) || (from > to) || (to > currentSize)) throw IndexOutOfBound("Arraylist:removeRange:IndexOutOfBound");
+        eraseRange(from, to);
+    }
+
+    /**
+     * Removes every element for which pred returns true, compacting the list in one pass.
+     * Returns the number of removed elements.
+     */
+    template <class P>
+    int removeIf(P pred)
+    {
+        closeGap();
+        int w = 0;
+        for (int r = 0; r < currentSize; ++r) if (!pred(static_cast<const T&>(data[r])))
+        {
+            if (w != r) data[w] = std::move(data[r]);
+            ++w;
+        }
+        int removed = currentSize - w;
+        destroy(w, currentSize);
+        currentSize = w;
+        return removed;
+    }
+
     /**
      * TODO Removes all of the elements from this list.
      */
     void clear()
     {
+        closeGap();
+        destroy(0, currentSize);
         currentSize = 0;
     }
 
@@ -161,9 +541,38 @@ public:
      */
     bool contains(const T& e) const
     {
-        for (int i = 0; i < currentSize; ++i)
-            if (data[i] == e) return true;
-        return false;
+        return indexOf(e) != -1;
+    }
+
+    /**
+     * Returns the index of the first occurrence of the specified element in this list,
+     * or -1 if it is not present. Arithmetic element types are scanned with vector compares.
+     */
+    int indexOf(const T& e) const
+    {
+        int i = VectorScan::Scan<T>::indexOf(data, gapBegin, e);
+        if (i != -1) return i;
+        i = VectorScan::Scan<T>::indexOf(data + gapEnd, currentSize - gapEnd, e);
+        return i == -1 ? -1 : gapBegin + i;
+    }
+
+    /**
+     * Returns the index of the last occurrence of the specified element in this list,
+     * or -1 if it is not present.
+     */
+    int lastIndexOf(const T& e) const
+    {
+        int i = VectorScan::Scan<T>::lastIndexOf(data + gapEnd, currentSize - gapEnd, e);
+        if (i != -1) return gapBegin + i;
+        return VectorScan::Scan<T>::lastIndexOf(data, gapBegin, e);
+    }
+
+    /**
+     * Returns the number of occurrences of the specified element in this list.
+     */
+    int count(const T& e) const
+    {
+        return VectorScan::Scan<T>::count(data, gapBegin, e) + VectorScan::Scan<T>::count(data + gapEnd, currentSize - gapEnd, e);
     }
 
     /**
@@ -173,6 +582,7 @@ public:
      */
     const T& get(int index) 
     {
+        closeGap();
         if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("Arraylist:get:IndexOutOfBound");
         return data[index];
     }
@@ -182,7 +592,7 @@ public:
      */
     bool isEmpty() const
     {
-        return currentSize == 0;
+        return size() == 0;
     }
 
     /**
@@ -192,9 +602,9 @@ public:
      */
     void removeIndex(int index)
     {
+        closeGap();
         if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("Arraylist:removeIndex:IndexOutOfBound");
-        for (int i = index; i < currentSize - 1; ++i) data[i] = data[i + 1];
-        --currentSize;
+        eraseRange(index, index + 1);
     }
 
     /**
@@ -203,13 +613,11 @@ public:
      */
     bool remove(const T &e)
     {
-        for (int i = 0; i < currentSize; ++i) if (data[i] == e)
-        {
-            for (int j = i; j < currentSize - 1; ++j) data[j] = data[j + 1];
-            --currentSize;
-            return true;
-        }
-        return false;
+        closeGap();
+        int i = indexOf(e);
+        if (i == -1) return false;
+        eraseRange(i, i + 1);
+        return true;
     }
 
     /**
@@ -219,16 +627,197 @@ public:
      */
     void set(int index, const T &element)
     {
+        closeGap();
         if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("Arraylist:set:IndexOutOfBound");
         data[index] = element;
     }
 
+    /**
+     * Replaces the element at the specified position in this list, moving from element.
+     * @throw IndexOutOfBound
+     */
+    void set(int index, T &&element)
+    {
+        closeGap();
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("Arraylist:set:IndexOutOfBound");
+        data[index] = std::move(element);
+    }
+
     /**
      * TODO Returns the number of elements in this list.
      */
     int size() const
     {
-        return currentSize;
+        return currentSize - (gapEnd - gapBegin);
+    }
+
+    /**
+     * Returns a pointer to the first element of the internal array, where the elements
+     * are stored contiguously in list order. It is valid until the list is next modified.
+     */
+    const T *array()
+    {
+        closeGap();
+        return data;
+    }
+
+    /**
+     * As array(), on a list that no live iterator has removed elements from: a const list
+     * cannot compact the gap such an iterator leaves.
+     */
+    const T *array() const
+    {
+        return data;
+    }
+
+    /**
+     * Returns the length of the internal array.
+     */
+    int capacity() const
+    {
+        return maxSize;
+    }
+
+    /**
+     * Grows the internal array so that at least n elements fit without reallocation.
+     */
+    void reserve(int n)
+    {
+        closeGap();
+        if (n > maxSize) reallocate(n);
+    }
+
+    /**
+     * Shrinks the internal array to exactly size() slots.
+     */
+    void shrinkToFit()
+    {
+        closeGap();
+        if (currentSize < maxSize) reallocate(currentSize);
+    }
+
+    /**
+     * Sorts this list by operator<. Not stable.
+     */
+    void sort()
+    {
+        sort([](const T& a, const T& b) { return a < b; });
+    }
+
+    /**
+     * Sorts this list by cmp, a strict weak ordering like Less<T>. Not stable.
+     * Large lists are sorted with a parallel merge sort over the given number of threads
+     * (0 means one per core), small ones with a sequential introsort.
+     */
+    template <class C>
+    void sort(C cmp, int threads = 0)
+    {
+        closeGap();
+        Parallel::sort(data, currentSize, cmp, threads);
+    }
+
+    /**
+     * Calls f(e) on every element, splitting the list across threads.
+     */
+    template <class F>
+    void parallelForEach(F f, int threads = 0)
+    {
+        closeGap();
+        Parallel::forEach(data, currentSize, f, threads);
+    }
+
+    /**
+     * Replaces every element e with f(e), splitting the list across threads.
+     */
+    template <class F>
+    void parallelTransform(F f, int threads = 0)
+    {
+        closeGap();
+        Parallel::transform(data, currentSize, f, threads);
+    }
+
+    /**
+     * Returns the fold of all elements with op, which must be associative with identity
+     * as its neutral element. The list is split across threads.
+     */
+    template <class Op>
+    T parallelReduce(const T& identity, Op op, int threads = 0) const
+    {
+        T front = Parallel::reduce(data, gapBegin, identity, op, threads);
+        if (gapEnd == currentSize) return front;
+        return op(front, Parallel::reduce(data + gapEnd, currentSize - gapEnd, identity, op, threads));
+    }
+
+    /**
+     * Returns the index of the first element of this list, sorted by cmp, that is not less
+     * than e, or size() if there is none.
+     */
+    template <class C>
+    int lowerBound(const T& e, C cmp) const
+    {
+        int lo = 0, hi = size();
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if (cmp(at(mid), e)) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    /**
+     * Returns the index of the first element of this list, sorted by cmp, that is greater
+     * than e, or size() if there is none.
+     */
+    template <class C>
+    int upperBound(const T& e, C cmp) const
+    {
+        int lo = 0, hi = size();
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if (cmp(e, at(mid))) hi = mid;
+            else lo = mid + 1;
+        }
+        return lo;
+    }
+
+    /**
+     * Returns the index of an element equivalent to e in this list, sorted by cmp,
+     * or -1 if there is none.
+     */
+    template <class C>
+    int binarySearch(const T& e, C cmp) const
+    {
+        int i = lowerBound(e, cmp);
+        if ((i == size()) || cmp(e, at(i))) return -1;
+        return i;
+    }
+
+    /**
+     * Merges x into this list in one backward pass, both sorted by cmp, and leaves x empty.
+     * Elements of x go after equivalent elements of this list.
+     */
+    template <class C>
+    void mergeSorted(ArrayList& x, C cmp)
+    {
+        if (&x == this)
+        {
+            ArrayList tmp(x);
+            mergeSorted(tmp, cmp);
+            return;
+        }
+        closeGap();
+        x.closeGap();
+        int n = currentSize, m = x.currentSize;
+        if (m == 0) return;
+        if (n + m > maxSize) reallocate(std::max(n + m, maxSize << 1));
+        int i = n - 1, j = m - 1;
+        for (int k = n + m - 1; j >= 0; --k)
+            if ((i >= 0) && cmp(x.data[j], data[i])) put(k, std::move(data[i--]));
+            else put(k, std::move(x.data[j--]));
+        currentSize = n + m;
+        x.clear();
     }
 
     /**
@@ -236,6 +825,7 @@ public:
      */
     Iterator iterator()
     {
+        closeGap();
         return Iterator(this);
     }
 };
@@ -0,0 +1,324 @@
+/** @file */
+#ifndef __BLOCKDEQUE_H
+#define __BLOCKDEQUE_H
+
+#include "Deque.h"
+#include "ElementNotExist.h"
+#include "IndexOutOfBound.h"
+#include <new>
+#include <cstdlib>
+#include <utility>
+
+/**
+ * A deque for very large sizes, made of fixed blocks of 2^B elements. A Deque of block
+ * pointers (the map) grows at either end in O(1) amortized time and only ever moves
+ * pointers, so addFirst/addLast never relocate an element and references to elements
+ * stay valid until the element is removed. Peak memory during growth is the elements
+ * plus a map that is 1/2^B of their count.
+ *
+ * Element i lives in block (first + i) >> B at slot (first + i) & (2^B - 1), where first
+ * is the offset of the first element in the first block. Blocks that become empty go to
+ * a small cache and are reused before new ones are allocated.
+ */
+template <class T, int B = 9>
+class BlockDeque
+{
+    static const int BLOCK = 1 << B;
+    static const int MASK = BLOCK - 1;
+    static const int CACHE = 4;
+
+    Deque<T *> map;
+    int first, currentSize;
+    T *cache[CACHE];
+    int cached;
+
+    T &at(int index) const
+    {
+        int k = first + index;
+        return map.get(k >> B)[k & MASK];
+    }
+
+    T *newBlock()
+    {
+        if (cached > 0) return cache[--cached];
+        T *block = static_cast<T *>(std::malloc(sizeof(T) * BLOCK));
+        if (block == NULL) throw std::bad_alloc();
+        return block;
+    }
+
+    void releaseBlock(T *block)
+    {
+        if (cached < CACHE) cache[cached++] = block;
+        else std::free(block);
+    }
+
+    /**
+     * Called once the deque is empty: hands every block back and restarts at offset 0.
+     */
+    void reset()
+    {
+        for (; !map.isEmpty(); map.removeLast()) releaseBlock(map.getLast());
+        first = 0;
+    }
+
+public:
+    class Iterator
+    {
+        BlockDeque *deq;
+        int status, position, deleted;
+
+    public:
+        Iterator(BlockDeque *deq, int status = 1):deq(deq), status(status), deleted(-1)
+        {
+            position = status == 1 ? -1 : deq -> currentSize;
+        }
+
+        /**
+         * Returns true if the iteration has more elements.
+         */
+        bool hasNext() const
+        {
+            return (position + status >= 0) && (position + status < deq -> currentSize);
+        }
+
+        /**
+         * Returns the next element in the iteration.
+         * @throw ElementNotExist exception when hasNext() == false
+         */
+        const T &next()
+        {
+            if (!hasNext()) throw ElementNotExist("BlockDeque:next:ElementNotExist");
+            position += status;
+            deleted = 0;
+            return deq -> at(position);
+        }
+
+        /**
+         * Removes from the underlying deque the last element returned by the iterator.
+         * @throw ElementNotExist
+         */
+        void remove()
+        {
+            if ((position < 0) || (position >= deq -> currentSize) || (deleted == -1)) throw ElementNotExist("BlockDeque:remove:ElementNotExist");
+            deleted = -1;
+            deq -> removeAt(position);
+            if (status == 1) --position;
+        }
+    };
+
+    /**
+     * Constructs an empty deque. No block is allocated until the first add.
+     */
+    BlockDeque():first(0), currentSize(0), cached(0) {}
+
+    /**
+     * Destructor
+     */
+    ~BlockDeque()
+    {
+        clear();
+        for (; cached > 0;) std::free(cache[--cached]);
+    }
+
+    /**
+     * Copy-constructor
+     */
+    BlockDeque(const BlockDeque& x):first(0), currentSize(0), cached(0)
+    {
+        for (int i = 0; i < x.currentSize; ++i) addLast(x.at(i));
+    }
+
+    /**
+     * Assignment operator
+     */
+    BlockDeque& operator=(const BlockDeque& x)
+    {
+        if (this == &x) return *this;
+        clear();
+        for (int i = 0; i < x.currentSize; ++i) addLast(x.at(i));
+        return *this;
+    }
+
+    /**
+     * Inserts the specified element at the front of this deque.
+     */
+    void addFirst(const T& e)
+    {
+        T tmp(e);
+        if (first == 0)
+        {
+            map.addFirst(newBlock());
+            first = BLOCK;
+        }
+        --first;
+        new (&at(0)) T(std::move(tmp));
+        ++currentSize;
+    }
+
+    /**
+     * Inserts the specified element at the end of this deque.
+     */
+    void addLast(const T& e)
+    {
+        T tmp(e);
+        if (((first + currentSize) >> B) == map.size()) map.addLast(newBlock());
+        new (&at(currentSize)) T(std::move(tmp));
+        ++currentSize;
+    }
+
+    /**
+     * Returns true if this deque contains the specified element.
+     */
+    bool contains(const T& e) const
+    {
+        for (int i = 0; i < currentSize; ++i) if (at(i) == e) return true;
+        return false;
+    }
+
+    /**
+     * Removes all of the elements from this deque.
+     */
+    void clear()
+    {
+        for (int i = 0; i < currentSize; ++i) at(i).~T();
+        currentSize = 0;
+        reset();
+    }
+
+    /**
+     * Returns true if this deque contains no elements.
+     */
+    bool isEmpty() const
+    {
+        return currentSize == 0;
+    }
+
+    /**
+     * Retrieves, but does not remove, the first element of this deque.
+     * @throw ElementNotExist
+     */
+    const T& getFirst() const
+    {
+        if (isEmpty()) throw ElementNotExist("BlockDeque:getFirst:ElementNotExist");
+        return at(0);
+    }
+
+    /**
+     * Retrieves, but does not remove, the last element of this deque.
+     * @throw ElementNotExist
+     */
+    const T& getLast() const
+    {
+        if (isEmpty()) throw ElementNotExist("BlockDeque:getLast:ElementNotExist");
+        return at(currentSize - 1);
+    }
+
+    /**
+     * Removes the first element of this deque, releasing its block once it is empty.
+     * @throw ElementNotExist
+     */
+    void removeFirst()
+    {
+        if (isEmpty()) throw ElementNotExist("BlockDeque:removeFirst:ElementNotExist");
+        at(0).~T();
+        --currentSize;
+        if (currentSize == 0)
+        {
+            reset();
+            return;
+        }
+        if (++first == BLOCK)
+        {
+            releaseBlock(map.getFirst());
+            map.removeFirst();
+            first = 0;
+        }
+    }
+
+    /**
+     * Removes the last element of this deque, releasing its block once it is empty.
+     * @throw ElementNotExist
+     */
+    void removeLast()
+    {
+        if (isEmpty()) throw ElementNotExist("BlockDeque:removeLast:ElementNotExist");
+        at(--currentSize).~T();
+        if (currentSize == 0)
+        {
+            reset();
+            return;
+        }
+        int end = first + currentSize;
+        if (((end & MASK) == 0) && ((end >> B) < map.size()))
+        {
+            releaseBlock(map.getLast());
+            map.removeLast();
+        }
+    }
+
+    /**
+     * Removes the element at the specified position, shifting the elements on the
+     * shorter side of index by one.
+     * @throw IndexOutOfBound
+     */
+    void removeAt(int index)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("BlockDeque:removeAt:IndexOutOfBound");
+        if (index < currentSize / 2)
+        {
+            for (int i = index; i > 0; --i) at(i) = std::move(at(i - 1));
+            removeFirst();
+        }
+        else
+        {
+            for (int i = index; i < currentSize - 1; ++i) at(i) = std::move(at(i + 1));
+            removeLast();
+        }
+    }
+
+    /**
+     * Returns a const reference to the element at the specified position in this deque.
+     * @throw IndexOutOfBound
+     */
+    const T& get(int index) const
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("BlockDeque:get:IndexOutOfBound");
+        return at(index);
+    }
+
+    /**
+     * Replaces the element at the specified position in this deque with the specified element.
+     * @throw IndexOutOfBound
+     */
+    void set(int index, const T& e)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("BlockDeque:set:IndexOutOfBound");
+        at(index) = e;
+    }
+
+    /**
+     * Returns the number of elements in this deque.
+     */
+    int size() const
+    {
+        return currentSize;
+    }
+
+    /**
+     * Returns an iterator over the elements in this deque in proper sequence.
+     */
+    Iterator iterator()
+    {
+        return Iterator(this, 1);
+    }
+
+    /**
+     * Returns an iterator over the elements in this deque in reverse sequential order.
+     */
+    Iterator descendingIterator()
+    {
+        return Iterator(this, -1);
+    }
+};
+
+#endif
@@ -0,0 +1,406 @@
+/** @file */
+#ifndef __CACHE_H
+#define __CACHE_H
+
+#include "IntrusiveList.h"
+#include "ElementNotExist.h"
+#include "IndexOutOfBound.h"
+#include <cstddef>
+
+/**
+ * Replacement policies for Cache.
+ *
+ * LRU evicts the least recently used entry. CLOCK approximates it: a hit only sets a
+ * reference bit, and the eviction hand gives each referenced entry a second chance,
+ * so hits never relink. SEGMENTED_LRU admits new entries to a probationary segment and
+ * promotes them to a protected segment (up to 80% of the capacity) on their second use,
+ * so a burst of one-off keys cannot flush the entries that are used repeatedly.
+ */
+enum class CachePolicy { LRU, CLOCK, SEGMENTED_LRU };
+
+/**
+ * A bounded key-value cache. get, put and remove take O(1) expected time and a single
+ * hash lookup: the entries are chained in the cache's own hash table, which grows with
+ * the number of entries and shrinks back on clear, and threaded on intrusive recency
+ * lists, so touching or evicting one never scans.
+ *
+ * Each entry carries a positive charge, 1 unless put says otherwise, and the cache
+ * evicts until the total charge fits the capacity, which is positive too. Leave the charge at 1 to bound the number of
+ * entries, or pass each value's size in bytes to bound the memory.
+ *
+ * H is the hash function, as for HashMap: a class with a static int hashCode(const K&).
+ */
+template <class K, class V, class H>
+class Cache
+{
+    class Entry
+    {
+    public:
+        K key;
+        V value;
+        long long charge;
+        bool referenced, hot;
+        ListHook hook;
+        Entry *chain;
+
+        Entry(const K& key, const V& value, long long charge):key(key), value(value), charge(charge), referenced(false), hot(false), chain(NULL) {}
+    };
+
+    typedef IntrusiveList<Entry, &Entry::hook> List;
+
+    static const int FIRST_BUCKETS = 16;
+
+    /**
+     * A power of two number of buckets, at least the number of entries.
+     */
+    Entry **buckets;
+    int bucketCount, entries;
+    List cold, hot;
+    CachePolicy policy;
+    long long maxCharge, hotCapacity, used, hotUsed;
+    long long hits, misses, evictions;
+
+    Entry **bucketOf(const K& key) const
+    {
+        // spread the bits, since the low ones pick the bucket
+        unsigned h = (unsigned)H::hashCode(key);
+        h ^= h >> 16, h *= 0x45d9f3bu, h ^= h >> 16;
+        return &buckets[h & (bucketCount - 1)];
+    }
+
+    /**
+     * Returns the entry for key, or NULL.
+     */
+    Entry *find(const K& key) const
+    {
+        for (Entry *e = *bucketOf(key); e != NULL; e = e -> chain)
+            if (e -> key == key) return e;
+        return NULL;
+    }
+
+    void resetBuckets(int count)
+    {
+        buckets = new Entry *[count]();
+        bucketCount = count;
+    }
+
+    void hash(Entry *e)
+    {
+        if (entries == bucketCount)
+        {
+            Entry **old = buckets;
+            int oldCount = bucketCount;
+            resetBuckets(2 * oldCount);
+            for (int i = 0; i < oldCount; ++i)
+                for (Entry *x = old[i], *next; x != NULL; x = next)
+                {
+                    next = x -> chain;
+                    Entry **b = bucketOf(x -> key);
+                    x -> chain = *b;
+                    *b = x;
+                }
+            delete [] old;
+        }
+        Entry **b = bucketOf(e -> key);
+        e -> chain = *b;
+        *b = e;
+        ++entries;
+    }
+
+    void unhash(Entry *e)
+    {
+        Entry **p = bucketOf(e -> key);
+        while (*p != e) p = &(*p) -> chain;
+        *p = e -> chain;
+        --entries;
+    }
+
+    /**
+     * Unlinks e from everything and deletes it.
+     */
+    void drop(Entry *e)
+    {
+        unlink(e);
+        unhash(e);
+        delete e;
+    }
+
+    List &listOf(Entry *e)
+    {
+        return e -> hot ? hot : cold;
+    }
+
+    void unlink(Entry *e)
+    {
+        listOf(e).remove(e);
+        used -= e -> charge;
+        if (e -> hot) hotUsed -= e -> charge;
+        e -> hot = false;
+    }
+
+    /**
+     * Links e in as a newly admitted entry.
+     */
+    void admit(Entry *e)
+    {
+        e -> referenced = false;
+        cold.addLast(e);
+        used += e -> charge;
+    }
+
+    /**
+     * Records a use of e, which is linked in.
+     */
+    void touch(Entry *e)
+    {
+        switch (policy)
+        {
+        case CachePolicy::LRU:
+            cold.remove(e);
+            cold.addLast(e);
+            break;
+        case CachePolicy::CLOCK:
+            e -> referenced = true;
+            break;
+        case CachePolicy::SEGMENTED_LRU:
+            listOf(e).remove(e);
+            if (!e -> hot)
+            {
+                e -> hot = true;
+                hotUsed += e -> charge;
+            }
+            hot.addLast(e);
+            while ((hotUsed > hotCapacity) && (hot.getFirst() != e))
+            {
+                Entry *x = hot.getFirst();
+                hot.removeFirst();
+                x -> hot = false;
+                hotUsed -= x -> charge;
+                cold.addLast(x);
+            }
+            break;
+        }
+    }
+
+    Entry *victim()
+    {
+        if (policy == CachePolicy::CLOCK)
+            for (;;)
+            {
+                Entry *e = cold.getFirst();
+                if (!e -> referenced) return e;
+                e -> referenced = false;
+                cold.removeFirst();
+                cold.addLast(e);
+            }
+        return cold.isEmpty() ? hot.getFirst() : cold.getFirst();
+    }
+
+    /**
+     * Evicts entries until charge more fits.
+     */
+    void makeRoom(long long charge)
+    {
+        while (used + charge > maxCharge)
+        {
+            drop(victim());
+            ++evictions;
+        }
+    }
+
+    void destroyAll()
+    {
+        while (!cold.isEmpty())
+        {
+            Entry *e = cold.getFirst();
+            cold.removeFirst();
+            delete e;
+        }
+        while (!hot.isEmpty())
+        {
+            Entry *e = hot.getFirst();
+            hot.removeFirst();
+            delete e;
+        }
+        entries = 0;
+        used = hotUsed = 0;
+    }
+
+public:
+    /**
+     * Constructs an empty cache holding entries of total charge at most capacity.
+     * @throw IndexOutOfBound if capacity is not positive
+     */
+    Cache(long long capacity, CachePolicy policy = CachePolicy::LRU):entries(0), policy(policy), maxCharge(capacity),
+        hotCapacity(capacity - capacity / 5), used(0), hotUsed(0), hits(0), misses(0), evictions(0)
+    {
+        if (capacity <= 0) throw IndexOutOfBound("Cache:Cache:IndexOutOfBound");
+        resetBuckets(FIRST_BUCKETS);
+    }
+
+    Cache(const Cache&) = delete;
+    Cache& operator=(const Cache&) = delete;
+
+    /**
+     * Destructor
+     */
+    ~Cache()
+    {
+        destroyAll();
+        delete [] buckets;
+    }
+
+    /**
+     * Looks key up. On a hit, copies the value into value, records the use and returns
+     * true; on a miss returns false. Counts toward hitCount or missCount.
+     */
+    bool get(const K& key, V& value)
+    {
+        Entry *e = find(key);
+        if (e == NULL)
+        {
+            ++misses;
+            return false;
+        }
+        touch(e);
+        ++hits;
+        value = e -> value;
+        return true;
+    }
+
+    /**
+     * Maps key to value with the given charge, evicting other entries as needed. An
+     * existing entry for key is replaced and counts as used.
+     * Returns false, and caches nothing for key, if charge alone exceeds the capacity.
+     * Returns false and changes nothing if charge is not positive.
+     */
+    bool put(const K& key, const V& value, long long charge = 1)
+    {
+        if (charge <= 0) return false;
+        Entry *e = find(key);
+        if (e != NULL)
+        {
+            if (charge > maxCharge)
+            {
+                drop(e);
+                return false;
+            }
+            bool wasHot = e -> hot;
+            unlink(e);
+            e -> value = value;
+            e -> charge = charge;
+            makeRoom(charge);
+            if (wasHot)
+            {
+                e -> hot = true;
+                hot.addLast(e);
+                used += charge, hotUsed += charge;
+            }
+            else admit(e);
+            touch(e);
+            return true;
+        }
+        if (charge > maxCharge) return false;
+        makeRoom(charge);
+        e = new Entry(key, value, charge);
+        hash(e);
+        admit(e);
+        return true;
+    }
+
+    /**
+     * Removes the entry for key if present. Does not count as an eviction.
+     * Returns true if there was one.
+     */
+    bool remove(const K& key)
+    {
+        Entry *e = find(key);
+        if (e == NULL) return false;
+        drop(e);
+        return true;
+    }
+
+    /**
+     * Returns true if key is cached, without recording a use or counting a hit or miss.
+     */
+    bool containsKey(const K& key) const
+    {
+        return find(key) != NULL;
+    }
+
+    /**
+     * Removes every entry. The counters are kept.
+     */
+    void clear()
+    {
+        destroyAll();
+        delete [] buckets;
+        resetBuckets(FIRST_BUCKETS);
+    }
+
+    /**
+     * Returns the number of cached entries.
+     */
+    int size() const
+    {
+        return entries;
+    }
+
+    /**
+     * Returns true if nothing is cached.
+     */
+    bool isEmpty() const
+    {
+        return entries == 0;
+    }
+
+    /**
+     * Returns the total charge of the cached entries.
+     */
+    long long usage() const
+    {
+        return used;
+    }
+
+    /**
+     * Returns the maximum total charge.
+     */
+    long long capacity() const
+    {
+        return maxCharge;
+    }
+
+    /**
+     * Returns the number of get calls that found their key.
+     */
+    long long hitCount() const
+    {
+        return hits;
+    }
+
+    /**
+     * Returns the number of get calls that did not find their key.
+     */
+    long long missCount() const
+    {
+        return misses;
+    }
+
+    /**
+     * Returns the number of entries evicted to make room.
+     */
+    long long evictionCount() const
+    {
+        return evictions;
+    }
+
+    /**
+     * Zeroes the hit, miss and eviction counters.
+     */
+    void resetStats()
+    {
+        hits = misses = evictions = 0;
+    }
+};
+
+#endif
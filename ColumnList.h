@@ -0,0 +1,190 @@
+/** @file */
+#ifndef __COLUMNLIST_H
+#define __COLUMNLIST_H
+
+#include "ArrayList.h"
+#include "IndexOutOfBound.h"
+#include <tuple>
+
+/**
+ * A column-oriented list of records with fields of types Fields..., stored as one
+ * ArrayList per field ("struct of arrays"). Scanning a single field reads only that
+ * field's contiguous array instead of striding over whole records.
+ *
+ * Rows go in as std::tuple<Fields...> (or as separate arguments) and come out of
+ * get(index) rebuilt as a tuple. column<I>() gives the raw array of field I for tight
+ * loops, and columnList<I>() the ArrayList itself, e.g. for its vectorized indexOf.
+ * @code
+ *      ColumnList<int, double> list;
+ *      list.add(1, 2.5);
+ *      const double *prices = list.column<1>();
+ * @endcode
+ */
+template <class... Fields>
+class ColumnList
+{
+    template <int... I> class Indices {};
+    template <int N, int... I> class MakeIndices : public MakeIndices<N - 1, N - 1, I...> {};
+    template <int... I> class MakeIndices<0, I...>
+    {
+    public:
+        typedef Indices<I...> type;
+    };
+    typedef typename MakeIndices<sizeof...(Fields)>::type All;
+
+    std::tuple<ArrayList<Fields>...> columns;
+
+    template <int... I>
+    void addRow(Indices<I...>, const Fields&... f)
+    {
+        int expand[] = { (std::get<I>(columns).add(f), 0)... };
+        (void)expand;
+    }
+
+    template <int... I>
+    void addRow(Indices<I...>, const std::tuple<Fields...>& row)
+    {
+        int expand[] = { (std::get<I>(columns).add(std::get<I>(row)), 0)... };
+        (void)expand;
+    }
+
+    template <int... I>
+    std::tuple<Fields...> getRow(Indices<I...>, int index) const
+    {
+        return std::tuple<Fields...>(std::get<I>(columns).array()[index]...);
+    }
+
+    template <int... I>
+    void setRow(Indices<I...>, int index, const std::tuple<Fields...>& row)
+    {
+        int expand[] = { (std::get<I>(columns).set(index, std::get<I>(row)), 0)... };
+        (void)expand;
+    }
+
+    template <int... I>
+    void removeRow(Indices<I...>, int index)
+    {
+        int expand[] = { (std::get<I>(columns).removeIndex(index), 0)... };
+        (void)expand;
+    }
+
+    template <int... I>
+    void clearAll(Indices<I...>)
+    {
+        int expand[] = { (std::get<I>(columns).clear(), 0)... };
+        (void)expand;
+    }
+
+    template <int... I>
+    void reserveAll(Indices<I...>, int n)
+    {
+        int expand[] = { (std::get<I>(columns).reserve(n), 0)... };
+        (void)expand;
+    }
+
+public:
+    typedef std::tuple<Fields...> Record;
+
+    /**
+     * Appends a row given field by field.
+     * Always returns true.
+     */
+    bool add(const Fields&... f)
+    {
+        addRow(All(), f...);
+        return true;
+    }
+
+    /**
+     * Appends a row.
+     * Always returns true.
+     */
+    bool add(const Record& row)
+    {
+        addRow(All(), row);
+        return true;
+    }
+
+    /**
+     * Returns the row at the specified position, rebuilt from its fields.
+     * @throw IndexOutOfBound
+     */
+    Record get(int index) const
+    {
+        if ((index < 0) || (index >= size())) throw IndexOutOfBound("ColumnList:get:IndexOutOfBound");
+        return getRow(All(), index);
+    }
+
+    /**
+     * Replaces the row at the specified position.
+     * @throw IndexOutOfBound
+     */
+    void set(int index, const Record& row)
+    {
+        if ((index < 0) || (index >= size())) throw IndexOutOfBound("ColumnList:set:IndexOutOfBound");
+        setRow(All(), index, row);
+    }
+
+    /**
+     * Removes the row at the specified position.
+     * @throw IndexOutOfBound
+     */
+    void removeIndex(int index)
+    {
+        if ((index < 0) || (index >= size())) throw IndexOutOfBound("ColumnList:removeIndex:IndexOutOfBound");
+        removeRow(All(), index);
+    }
+
+    /**
+     * Returns a pointer to the contiguous values of field I, size() of them.
+     * It is valid until the list is next modified.
+     */
+    template <int I>
+    const typename std::tuple_element<I, Record>::type *column() const
+    {
+        return std::get<I>(columns).array();
+    }
+
+    /**
+     * Returns the ArrayList holding field I.
+     */
+    template <int I>
+    const ArrayList<typename std::tuple_element<I, Record>::type>& columnList() const
+    {
+        return std::get<I>(columns);
+    }
+
+    /**
+     * Removes all of the rows.
+     */
+    void clear()
+    {
+        clearAll(All());
+    }
+
+    /**
+     * Makes room for n rows in every column.
+     */
+    void reserve(int n)
+    {
+        reserveAll(All(), n);
+    }
+
+    /**
+     * Returns true if this list contains no rows.
+     */
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Returns the number of rows.
+     */
+    int size() const
+    {
+        return std::get<0>(columns).size();
+    }
+};
+
+#endif
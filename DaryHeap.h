@@ -0,0 +1,381 @@
+/** @file */
+#ifndef __DARYHEAP_H
+#define __DARYHEAP_H
+
+#include "ArrayList.h"
+#include "ElementNotExist.h"
+#include "Less.h"
+#include <new>
+#include <cstdlib>
+#include <utility>
+
+/**
+ * A priority queue with the PriorityQueue interface that keeps the elements themselves
+ * in one contiguous array laid out as a D-ary heap: the children of slot i are slots
+ * D*i+1 .. D*i+D. The head is the least element under C.
+ *
+ * A sift step moves one element, with no per-element allocation or position field to
+ * maintain, and the D children of a slot share a cache line or two. With D = 4 the heap
+ * is half as deep as a binary one, so pop compares more but moves less. Iteration scans
+ * the array.
+ */
+template <class T, class C = Less<T>, int D = 4>
+class DaryHeap
+{
+    static_assert(D >= 2, "DaryHeap needs at least 2 children per node");
+
+    C cmp;
+    T *data;
+    int currentSize, maxSize;
+
+    /**
+     * The slot reported for an element taken out of the array while a hole moves.
+     */
+    static const int HELD = -1;
+
+    /**
+     * Receives moved(from, to) for every element a sift moves; this one ignores them.
+     */
+    class Unobserved
+    {
+    public:
+        void operator()(int, int) const {}
+    };
+
+    static T *allocate(int n)
+    {
+        T *p = static_cast<T *>(std::malloc(sizeof(T) * (n > 0 ? n : 1)));
+        if (p == NULL) throw std::bad_alloc();
+        return p;
+    }
+
+    void destroyAll()
+    {
+        for (int i = 0; i < currentSize; ++i) data[i].~T();
+        currentSize = 0;
+    }
+
+    void doubleSpace()
+    {
+        int newSize = maxSize < 5 ? 10 : maxSize << 1;
+        T *tmp = allocate(newSize);
+        for (int i = 0; i < currentSize; ++i)
+        {
+            new (tmp + i) T(std::move(data[i]));
+            data[i].~T();
+        }
+        std::free(data);
+        data = tmp;
+        maxSize = newSize;
+    }
+
+    /**
+     * Sifts the element at i toward the root, moving parents down into the hole.
+     * Returns its final slot.
+     */
+    template <class M = Unobserved>
+    int up(int i, M moved = M())
+    {
+        if ((i == 0) || !cmp(data[i], data[(i - 1) / D])) return i;
+        T x(std::move(data[i]));
+        moved(i, HELD);
+        do
+        {
+            int p = (i - 1) / D;
+            data[i] = std::move(data[p]);
+            moved(p, i);
+            i = p;
+        }
+        while ((i > 0) && cmp(x, data[(i - 1) / D]));
+        data[i] = std::move(x);
+        moved(HELD, i);
+        return i;
+    }
+
+    /**
+     * Sifts the element at i toward the leaves, moving the least child up into the hole.
+     * Returns its final slot.
+     */
+    template <class M = Unobserved>
+    int down(int i, M moved = M())
+    {
+        int first = D * i + 1;
+        if (first >= currentSize) return i;
+        T x(std::move(data[i]));
+        moved(i, HELD);
+        for (; first < currentSize; first = D * i + 1)
+        {
+            int best = first, end = first + D < currentSize ? first + D : currentSize;
+            for (int c = first + 1; c < end; ++c) if (cmp(data[c], data[best])) best = c;
+            if (!cmp(data[best], x)) break;
+            data[i] = std::move(data[best]);
+            moved(best, i);
+            i = best;
+        }
+        data[i] = std::move(x);
+        moved(HELD, i);
+        return i;
+    }
+
+    /**
+     * Removes the element at i by moving the last element into its slot.
+     * Returns the slot that element settled in, or -1 if i was the last slot.
+     */
+    template <class M = Unobserved>
+    int removeAt(int i, M moved = M())
+    {
+        int last = --currentSize;
+        if (i == last)
+        {
+            data[last].~T();
+            return -1;
+        }
+        data[i] = std::move(data[last]);
+        data[last].~T();
+        moved(last, i);
+        int j = down(i, moved);
+        return j == i ? up(i, moved) : j;
+    }
+
+    void heapify()
+    {
+        for (int i = (currentSize - 2) / D; i >= 0; --i) down(i);
+    }
+
+    void copyFrom(const DaryHeap &x)
+    {
+        maxSize = x.currentSize > 10 ? x.currentSize : 10;
+        data = allocate(maxSize);
+        for (currentSize = 0; currentSize < x.currentSize; ++currentSize) new (data + currentSize) T(x.data[currentSize]);
+    }
+
+public:
+    /**
+     * Scans the array. An element that a removal through the iterator lifts into the part
+     * already scanned is remembered by its slot, followed through later removals, and
+     * returned after the scan, so every element is still returned exactly once.
+     */
+    class Iterator
+    {
+        DaryHeap *heap;
+        int cursor, last, forgottenPos;
+
+        /**
+         * Slots of the lifted elements, those from forgottenPos on not yet returned.
+         * Allocated by the first removal that lifts one.
+         */
+        ArrayList<int> *forgotten;
+
+        /**
+         * Follows a forgotten element that a sift moves from one slot to another.
+         */
+        void track(int from, int to)
+        {
+            if (forgotten == NULL) return;
+            for (int k = forgottenPos; k < forgotten -> size(); ++k)
+                if (forgotten -> get(k) == from)
+                {
+                    forgotten -> set(k, to);
+                    return;
+                }
+        }
+
+        int forgottenSize() const
+        {
+            return forgotten == NULL ? 0 : forgotten -> size();
+        }
+
+    public:
+        Iterator(DaryHeap *heap):heap(heap), cursor(0), last(-1), forgottenPos(0), forgotten(NULL) {}
+
+        Iterator(const Iterator &x):heap(x.heap), cursor(x.cursor), last(x.last), forgottenPos(x.forgottenPos),
+            forgotten(x.forgotten == NULL ? NULL : new ArrayList<int>(*x.forgotten)) {}
+
+        Iterator &operator=(const Iterator &x)
+        {
+            if (&x == this) return *this;
+            ArrayList<int> *copy = x.forgotten == NULL ? NULL : new ArrayList<int>(*x.forgotten);
+            delete forgotten;
+            heap = x.heap, cursor = x.cursor, last = x.last, forgottenPos = x.forgottenPos;
+            forgotten = copy;
+            return *this;
+        }
+
+        ~Iterator()
+        {
+            delete forgotten;
+        }
+
+        /**
+         * Returns true if the iteration has more elements.
+         */
+        bool hasNext() const
+        {
+            return (cursor < heap -> currentSize) || (forgottenPos < forgottenSize());
+        }
+
+        /**
+         * Returns the next element in the iteration.
+         * @throw ElementNotExist exception when hasNext() == false
+         */
+        const T &next()
+        {
+            if (cursor < heap -> currentSize)
+            {
+                last = cursor++;
+                return heap -> data[last];
+            }
+            if (forgottenPos < forgottenSize())
+            {
+                last = -2;
+                return heap -> data[forgotten -> get(forgottenPos++)];
+            }
+            throw ElementNotExist("DaryHeap:next:ElementNotExist");
+        }
+
+        /**
+         * Removes from the underlying heap the last element returned by the iterator.
+         * @throw ElementNotExist
+         */
+        void remove()
+        {
+            if (last == -1) throw ElementNotExist("DaryHeap:remove:ElementNotExist");
+            auto moved = [this](int from, int to) { track(from, to); };
+            if (last == -2) heap -> removeAt(forgotten -> get(forgottenPos - 1), moved);
+            else
+            {
+                int lifted = heap -> removeAt(last, moved);
+                if ((lifted >= 0) && (lifted < last))
+                {
+                    if (forgotten == NULL) forgotten = new ArrayList<int>;
+                    forgotten -> add(lifted);
+                }
+                else cursor = last;
+            }
+            last = -1;
+        }
+    };
+
+    /**
+     * Constructs an empty heap with room for _size elements.
+     */
+    DaryHeap(int _size = 10):data(allocate(_size)), currentSize(0), maxSize(_size > 0 ? _size : 1) {}
+
+    /**
+     * Destructor
+     */
+    ~DaryHeap()
+    {
+        destroyAll();
+        std::free(data);
+    }
+
+    /**
+     * Assignment operator
+     */
+    DaryHeap &operator=(const DaryHeap &x)
+    {
+        if (&x == this) return *this;
+        destroyAll();
+        std::free(data);
+        copyFrom(x);
+        return *this;
+    }
+
+    /**
+     * Copy-constructor
+     */
+    DaryHeap(const DaryHeap &x)
+    {
+        copyFrom(x);
+    }
+
+    /**
+     * Constructs a heap over the elements in this Array List in O(n) time.
+     */
+    DaryHeap(ArrayList<T> &x):currentSize(0), maxSize(x.size() > 0 ? x.size() : 1)
+    {
+        data = allocate(maxSize);
+        for (typename ArrayList<T>::Iterator itr = x.iterator(); itr.hasNext(); ++currentSize) new (data + currentSize) T(itr.next());
+        heapify();
+    }
+
+    /**
+     * Returns an iterator over the elements in this heap.
+     */
+    Iterator iterator()
+    {
+        return Iterator(this);
+    }
+
+    /**
+     * Removes all of the elements from this heap.
+     */
+    void clear()
+    {
+        destroyAll();
+    }
+
+    /**
+     * Returns a const reference to the front of the heap.
+     * @throw ElementNotExist
+     */
+    const T &front() const
+    {
+        if (currentSize == 0) throw ElementNotExist("DaryHeap:front:ElementNotExist");
+        return data[0];
+    }
+
+    /**
+     * Returns true if this heap contains no elements.
+     */
+    bool empty() const
+    {
+        return currentSize == 0;
+    }
+
+    /**
+     * Adds an element to the heap.
+     */
+    void push(const T &value)
+    {
+        if (currentSize == maxSize)
+        {
+            T tmp(value);
+            doubleSpace();
+            new (data + currentSize) T(std::move(tmp));
+        }
+        else new (data + currentSize) T(value);
+        up(currentSize++);
+    }
+
+    /**
+     * Adds an element to the heap, moving it in.
+     */
+    void push(T &&value)
+    {
+        if (currentSize == maxSize) doubleSpace();
+        new (data + currentSize) T(std::move(value));
+        up(currentSize++);
+    }
+
+    /**
+     * Removes the front element of this heap.
+     * @throw ElementNotExist
+     */
+    void pop()
+    {
+        if (currentSize == 0) throw ElementNotExist("DaryHeap:pop:ElementNotExist");
+        removeAt(0);
+    }
+
+    /**
+     * Returns the number of elements in this heap.
+     */
+    int size() const
+    {
+        return currentSize;
+    }
+};
+
+#endif
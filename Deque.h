@@ -4,6 +4,10 @@
 
 #include "ElementNotExist.h"
 #include "IndexOutOfBound.h"
+#include <new>
+#include <cstdlib>
+#include <utility>
+#include <type_traits>
 
 /**
  * An deque is a linear collection that supports element insertion and removal at both ends.
@@ -11,25 +15,71 @@
  * Remember: all functions but "contains" and "clear" should be finished in O(1) time.
  *
  * You need to implement both iterators in proper sequential order and ones in reverse sequential order. 
+ *
+ * The elements live in a circular buffer whose capacity is a power of two: the element at
+ * index i is data[(head + i) & mask]. Both ends wrap around, so a deque whose size stays
+ * bounded never reallocates, whatever the mix of operations at either end.
+ *
+ * The buffer is raw storage and only the slots holding elements are constructed, so a
+ * removed element is destroyed at once and T needs no default constructor.
  */
 template <class T>
 class Deque
 {
 	T *data;
-	int left, right, maxSize;
-	
+	int head, currentSize, mask;
+
+	T &at(int index) const
+	{
+		return data[(head + index) & mask];
+	}
+
+	static T *allocate(int n)
+	{
+		T *p = static_cast<T *>(std::malloc(sizeof(T) * n));
+		if (p == NULL) throw std::bad_alloc();
+		return p;
+	}
+
+	/**
+	 * Destroys the elements and frees the buffer.
+	 */
+	void release()
+	{
+		clear();
+		std::free(data);
+	}
+
+	/**
+	 * Copies the elements of x into the unwrapped, empty buffer of this deque.
+	 */
+	void copyElements(const Deque& x)
+	{
+		for (; currentSize < x.currentSize; ++currentSize) new (data + currentSize) T(x.at(currentSize));
+	}
+
+	/**
+	 * Doubles the capacity, unwrapping the elements to the start of the new buffer.
+	 */
 	void doubleSpace()
 	{
-		T *tmp = new T[maxSize];
-		for (int i = left; i <= right; ++i) tmp[i] = data[i];
-		delete [] data;
-		maxSize <<= 2;
-		data = new T[maxSize];
-		int mid0 = (left + right) / 2, mid1 = maxSize / 2;
-		int left1 = mid1 - (mid0 - left), right1 = right - mid0 + mid1;
-		for (int i = left1; i <= right1; ++i) data[i] = tmp[i - left1 + left];
-		left = left1, right = right1;
-		delete [] tmp;
+		T *tmp = allocate((mask + 1) << 1);
+		for (int i = 0; i < currentSize; ++i)
+		{
+			new (tmp + i) T(std::move(at(i)));
+			at(i).~T();
+		}
+		std::free(data);
+		data = tmp;
+		head = 0;
+		mask = (mask << 1) | 1;
+	}
+
+	static int roundUp(int n)
+	{
+		int c = 1;
+		for (; c < n; c <<= 1);
+		return c;
 	}
 	
 public:
@@ -41,17 +91,15 @@ public:
 	
 		Iterator(Deque<T> *deq, int status = 1):status(status), deq(deq), deleted(-1)
 		{
-			if (status == 1) position = deq -> left - 1;
-			else position = deq -> right + 1;
+			if (status == 1) position = -1;
+			else position = deq -> currentSize;
 		};
         /**
          * TODO Returns true if the iteration has more elements.
          */
         bool hasNext() 
 		{
-			if (deq -> left == -1) return false;
-			if ((position + status >= deq -> left) && (position + status <= deq -> right)) return true;
-			return false;
+			return (position + status >= 0) && (position + status < deq -> currentSize);
 		}
 
         /**
@@ -63,7 +111,7 @@ public:
 			if (!hasNext()) throw ElementNotExist("Deque:next:ElementNotExist");
 			position += status;
 			deleted = 0;
-			return deq -> data[position];
+			return deq -> at(position);
 		}
 
         /**
@@ -76,21 +124,19 @@ public:
          */
         void remove() 
         {
-        	if ((position < deq -> left) || (position > deq -> right) || (deleted == -1)) throw ElementNotExist("Deque:remove:ElementNotExist");
+        	if ((position < 0) || (position >= deq -> currentSize) || (deleted == -1)) throw ElementNotExist("Deque:remove:ElementNotExist");
         	deleted = -1;
-        	if (deq -> left == deq -> right) deq -> left = deq -> right = -1;
-        	for (int i = position; i < deq -> right; ++i) deq -> data[i] = deq -> data[i + 1];
+        	deq -> removeAt(position);
         	if (status == 1) --position;
-        	--deq -> right;
         }
     };
 
     /**
      * TODO Constructs an empty deque.
      */
-    Deque(int maxSize = 10):left(-1), right(-1), maxSize(maxSize) 
+    Deque(int maxSize = 10):head(0), currentSize(0), mask(roundUp(maxSize) - 1) 
 	{
-		data = new T[maxSize];
+		data = allocate(mask + 1);
 	}
 
     /**
@@ -98,7 +144,7 @@ public:
      */
     ~Deque() 
 	{
-		delete [] data;
+		release();
 	}
 
     /**
@@ -107,21 +153,32 @@ public:
     Deque& operator=(const Deque& x) 
 	{
 		if (this == &x) return *this;
-		delete [] data;
-		maxSize = x.maxSize, left = x.left, right = x.right;
-		data = new T[maxSize];
-		if (left != -1) for (int i = left; i <= right; ++i) data[i] = x.data[i];
+		clear();
+		if (mask != x.mask)
+		{
+			T *tmp = allocate(x.mask + 1);
+			std::free(data);
+			data = tmp, mask = x.mask;
+		}
+		copyElements(x);
 		return *this;
 	}
 
     /**
      * TODO Copy-constructor
      */
-    Deque(const Deque& x) 
+    Deque(const Deque& x):head(0), currentSize(0), mask(x.mask)
 	{
-		maxSize = x.maxSize, left = x.left, right = x.right;
-		data = new T[maxSize];
-		if (left != -1) for (int i = left; i <= right; ++i) data[i] = x.data[i];
+		data = allocate(mask + 1);
+		try
+		{
+			copyElements(x);
+		}
+		catch (...)
+		{
+			release();
+			throw;
+		}
 	}
 	
 	/**
@@ -129,14 +186,15 @@ public:
 	 */
 	void addFirst(const T& e) 
 	{
-		if (left == -1)
+		if (currentSize > mask)
 		{
-			left = right = maxSize / 2;
-			data[left] = e;
-			return;
+			T tmp(e);
+			doubleSpace();
+			new (data + ((head - 1) & mask)) T(std::move(tmp));
 		}
-		if (left == 0) doubleSpace();
-		data[--left] = e;
+		else new (data + ((head - 1) & mask)) T(e);
+		head = (head - 1) & mask;
+		++currentSize;
 	}
 
 	/**
@@ -144,14 +202,68 @@ public:
 	 */
 	void addLast(const T& e) 
 	{
-		if (left == -1)
+		if (currentSize > mask)
+		{
+			T tmp(e);
+			doubleSpace();
+			new (&at(currentSize)) T(std::move(tmp));
+		}
+		else new (&at(currentSize)) T(e);
+		++currentSize;
+	}
+
+	/**
+	 * Inserts the specified element at the specified position in this deque.
+	 * The range of index parameter is [0, size]. Only the elements on the shorter side
+	 * of index are shifted, so this takes O(min(index, size - index)) time.
+	 * @throw IndexOutOfBound
+	 */
+	void insert(int index, const T& e)
+	{
+		if ((index < 0) || (index > currentSize)) throw IndexOutOfBound("Deque:insert:IndexOutOfBound");
+		T tmp(e);
+		if (currentSize > mask) doubleSpace();
+		if (index == currentSize) new (&at(index)) T(std::move(tmp));
+		else if (index == 0)
+		{
+			head = (head - 1) & mask;
+			new (&at(0)) T(std::move(tmp));
+		}
+		else if (index < currentSize / 2)
+		{
+			// the slot before the head is raw: construct into it, then assign down to index
+			head = (head - 1) & mask;
+			new (&at(0)) T(std::move(at(1)));
+			for (int i = 1; i < index; ++i) at(i) = std::move(at(i + 1));
+			at(index) = std::move(tmp);
+		}
+		else
+		{
+			new (&at(currentSize)) T(std::move(at(currentSize - 1)));
+			for (int i = currentSize - 1; i > index; --i) at(i) = std::move(at(i - 1));
+			at(index) = std::move(tmp);
+		}
+		++currentSize;
+	}
+
+	/**
+	 * Removes the element at the specified position in this deque, shifting only the
+	 * elements on the shorter side of index: O(min(index, size - index)) time.
+	 * @throw IndexOutOfBound
+	 */
+	void removeAt(int index)
+	{
+		if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("Deque:removeAt:IndexOutOfBound");
+		if (index < currentSize / 2)
+		{
+			for (int i = index; i > 0; --i) at(i) = std::move(at(i - 1));
+			removeFirst();
+		}
+		else
 		{
-			left = right = maxSize / 2;
-			data[right] = e;
-			return;
+			for (int i = index; i < currentSize - 1; ++i) at(i) = std::move(at(i + 1));
+			removeLast();
 		}
-		if (right == maxSize - 1) doubleSpace();
-		data[++right] = e;
 	}
 
 	/**
@@ -159,8 +271,7 @@ public:
 	 */
 	bool contains(const T& e) const 
 	{
-		if (left == -1) return false;
-		for (int i = left; i <= right; ++i) if (data[i] == e) return true;
+		for (int i = 0; i < currentSize; ++i) if (at(i) == e) return true;
 		return false;
 	}
 
@@ -169,7 +280,9 @@ public:
 	 */
 	 void clear() 
 	 {
-		left = right = -1;
+		if (!std::is_trivially_destructible<T>::value)
+			for (int i = 0; i < currentSize; ++i) at(i).~T();
+		head = currentSize = 0;
 	 }
 
 	 /**
@@ -177,7 +290,7 @@ public:
 	  */
 	bool isEmpty() const 
 	{
-		return left == -1;
+		return currentSize == 0;
 	}
 
 	/**
@@ -187,7 +300,7 @@ public:
 	 const T& getFirst() 
 	 {
 		if (isEmpty()) throw ElementNotExist("Deque:getFirst:ElementNotExist");
-		return data[left];
+		return data[head];
 	 }
 
 	 /**
@@ -197,7 +310,7 @@ public:
 	 const T& getLast() 
 	 {
 		if (isEmpty()) throw ElementNotExist("Deque:getLast:ElementNotExist");
-		return data[right];
+		return at(currentSize - 1);
 	 }
 
 	 /**
@@ -207,8 +320,9 @@ public:
 	void removeFirst() 
 	{
 		if (isEmpty()) throw ElementNotExist("Deque:removeFirst:ElementNotExist");
-		if (left == right) left = right = -1;
-		else ++left;
+		data[head].~T();
+		head = (head + 1) & mask;
+		--currentSize;
 	}
 
 	/**
@@ -218,8 +332,7 @@ public:
 	void removeLast() 
 	{
 		if (isEmpty()) throw ElementNotExist("Deque:removeLast:ElementNotExist");
-		if (left == right) left = right = -1;
-		else --right;
+		at(--currentSize).~T();
 	}
 
 	/**
@@ -229,8 +342,8 @@ public:
 	 */
 	const T& get(int index) const 
 	{
-		if ((index < 0) || (index >= (right - left + 1))) throw IndexOutOfBound("Deque:get:IndexOutOfBound");
-		return data[left + index];
+		if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("Deque:get:IndexOutOfBound");
+		return at(index);
 	}
 	
 	/**
@@ -240,8 +353,8 @@ public:
 	 */
 	void set(int index, const T& e) 
 	{
-		if ((index < 0) || (index >= (right - left + 1))) throw IndexOutOfBound("Deque:set:IndexOutOfBound");
-		data[left + index] = e;
+		if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("Deque:set:IndexOutOfBound");
+		at(index) = e;
 	}
 
 	/**
@@ -249,8 +362,7 @@ public:
 	 */
 	 int size() const 
 	 {
-	 	if (left == -1) return 0;
-		return right - left + 1;
+		return currentSize;
 	 }
 
 	 /**
@@ -0,0 +1,268 @@
+/** @file */
+#ifndef __EPOCHRECLAIMER_H
+#define __EPOCHRECLAIMER_H
+
+#include "ArrayList.h"
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * Epoch-based memory reclamation for lock-free structures: memory unlinked by one thread
+ * is freed only once no other thread can still be reading it.
+ *
+ * Every access to the shared structure runs inside a critical section (a Guard). On entry
+ * a thread publishes the global epoch it observed. Unlinked memory is retired into the
+ * thread's bucket for the global epoch read after the unlink, instead of being freed. The
+ * global epoch advances only once every thread inside a critical section has observed it,
+ * so by the time it is two ahead of a bucket, every critical section that could have seen
+ * the memory has ended, and the bucket is freed. Three buckets per thread, used
+ * round-robin, are enough.
+ *
+ * Each thread holds a record per reclaimer, cached for the last few reclaimers it used.
+ * A record evicted from that cache, or left by a thread that exits, goes back to its
+ * reclaimer idle, and the next thread that needs one claims it instead of allocating, so
+ * a reclaimer has no more records than the threads using it at once, not one per thread
+ * or per cache miss it ever saw. An idle record no longer holds back the epoch; its
+ * retired memory is freed by the next owner or with the reclaimer. The reclaimer must
+ * outlive every critical section, but threads may still cache its records when it is
+ * destroyed.
+ */
+class EpochReclaimer
+{
+    static const int BUCKETS = 3;
+    static const int ADVANCE_EVERY = 64;
+
+    typedef void (*Deleter)(void *);
+
+    class Bucket
+    {
+    public:
+        unsigned long epoch;
+        ArrayList<std::pair<void *, Deleter> > items;
+
+        Bucket():epoch(0) {}
+
+        void release()
+        {
+            for (int i = 0; i < items.size(); ++i) items.get(i).second(items.get(i).first);
+            items.clear();
+        }
+    };
+
+    /**
+     * state is HELD while a thread owns the record, and GONE once its reclaimer is
+     * destroyed; whichever of the owner and the reclaimer lets go last deletes it.
+     */
+    static const int HELD = 1, GONE = 2;
+
+    class Record
+    {
+    public:
+        std::atomic<unsigned long> epoch;
+        std::atomic<bool> active;
+        std::atomic<int> state;
+        Record *next;
+        Bucket buckets[BUCKETS];
+        int retiredSinceAdvance, depth;
+        bool cached;
+
+        Record():epoch(0), active(false), state(HELD), next(NULL), retiredSinceAdvance(0), depth(0), cached(false) {}
+    };
+
+    /**
+     * Gives up the calling thread's ownership of r, outside any critical section.
+     */
+    static void release(Record *r)
+    {
+        if (r->state.fetch_and(~HELD, std::memory_order_acq_rel) & GONE) delete r;
+    }
+
+    /**
+     * The calling thread's records for the last few reclaimers it used. Reclaimers are told
+     * apart by a serial number, so a new reclaimer at a reused address starts afresh. A
+     * record is released when it is evicted and when the thread exits.
+     */
+    class Registry
+    {
+    public:
+        static const int SLOTS = 8;
+        unsigned long ids[SLOTS];
+        Record *records[SLOTS];
+        int next;
+
+        Registry():next(0)
+        {
+            for (int i = 0; i < SLOTS; ++i) ids[i] = 0, records[i] = NULL;
+        }
+
+        ~Registry()
+        {
+            for (int i = 0; i < SLOTS; ++i) if (records[i] != NULL) records[i]->cached = false, release(records[i]);
+        }
+    };
+
+    static std::atomic<unsigned long> &serials()
+    {
+        static std::atomic<unsigned long> s(0);
+        return s;
+    }
+
+    static Registry &registry()
+    {
+        static thread_local Registry r;
+        return r;
+    }
+
+    alignas(64) std::atomic<unsigned long> global;
+    std::atomic<Record *> records;
+    unsigned long id;
+
+    /**
+     * Claims an idle record, or adds a new one if every record is held.
+     */
+    Record *acquire()
+    {
+        for (Record *r = records.load(std::memory_order_acquire); r != NULL; r = r->next)
+        {
+            int idle = 0;
+            if ((r->state.load(std::memory_order_relaxed) == 0) && r->state.compare_exchange_strong(idle, HELD, std::memory_order_acq_rel)) return r;
+        }
+        Record *r = new Record;
+        Record *head = records.load(std::memory_order_relaxed);
+        do r->next = head;
+        while (!records.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+        return r;
+    }
+
+    Record *self()
+    {
+        Registry &reg = registry();
+        for (int i = 0; i < Registry::SLOTS; ++i) if (reg.ids[i] == id) return reg.records[i];
+        Record *r = acquire();
+        // evict a record the thread is not inside a critical section of
+        for (int k = 0; k < Registry::SLOTS; ++k)
+        {
+            int slot = reg.next++ % Registry::SLOTS;
+            Record *old = reg.records[slot];
+            if ((old != NULL) && (old->depth > 0)) continue;
+            if (old != NULL) old->cached = false, release(old);
+            reg.ids[slot] = id, reg.records[slot] = r;
+            r->cached = true;
+            return r;
+        }
+        // guards of SLOTS other reclaimers are open: r is used uncached, released on exit
+        return r;
+    }
+
+    /**
+     * Advances the global epoch if every active thread has observed it.
+     */
+    void tryAdvance()
+    {
+        unsigned long e = global.load(std::memory_order_seq_cst);
+        for (Record *r = records.load(std::memory_order_acquire); r != NULL; r = r->next)
+            if (r->active.load(std::memory_order_seq_cst) && (r->epoch.load(std::memory_order_seq_cst) != e)) return;
+        global.compare_exchange_strong(e, e + 1);
+    }
+
+    /**
+     * Frees r's buckets retired two or more epochs before e.
+     */
+    static void collect(Record *r, unsigned long e)
+    {
+        for (int i = 0; i < BUCKETS; ++i)
+            if (r->buckets[i].epoch + 2 <= e) r->buckets[i].release();
+    }
+
+    void enter(Record *r)
+    {
+        if (r->depth++ > 0) return;
+        unsigned long e = global.load(std::memory_order_seq_cst);
+        r->epoch.store(e, std::memory_order_seq_cst);
+        r->active.store(true, std::memory_order_seq_cst);
+        collect(r, e);
+    }
+
+    void exit(Record *r)
+    {
+        if (--r->depth > 0) return;
+        r->active.store(false, std::memory_order_release);
+        if (!r->cached) release(r);
+    }
+
+public:
+    /**
+     * Marks the calling thread as inside a critical section for its lifetime.
+     * Guards nest.
+     */
+    class Guard
+    {
+        EpochReclaimer *reclaimer;
+        Record *record;
+
+    public:
+        Guard(EpochReclaimer &reclaimer):reclaimer(&reclaimer), record(reclaimer.self())
+        {
+            this->reclaimer->enter(record);
+        }
+
+        ~Guard()
+        {
+            reclaimer->exit(record);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        /**
+         * Hands p, already unlinked from the shared structure, over for deletion once no
+         * thread can still be reading it.
+         */
+        template <class N>
+        void retire(N *p)
+        {
+            unsigned long e = reclaimer->global.load(std::memory_order_seq_cst);
+            Bucket &b = record->buckets[e % BUCKETS];
+            if (b.epoch != e)
+            {
+                b.release();
+                b.epoch = e;
+            }
+            b.items.add(std::pair<void *, Deleter>(p, &destroy<N>));
+            if (++record->retiredSinceAdvance >= ADVANCE_EVERY)
+            {
+                record->retiredSinceAdvance = 0;
+                reclaimer->tryAdvance();
+            }
+        }
+    };
+
+    EpochReclaimer():global(BUCKETS), records(NULL), id(++serials()) {}
+
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+    /**
+     * Destructor. Frees everything still retired; no thread may be in a critical section.
+     * Records still cached by a thread are deleted by that thread when it lets them go.
+     */
+    ~EpochReclaimer()
+    {
+        for (Record *r = records.load(std::memory_order_acquire); r != NULL;)
+        {
+            Record *next = r->next;
+            for (int i = 0; i < BUCKETS; ++i) r->buckets[i].release();
+            if ((r->state.fetch_or(GONE, std::memory_order_acq_rel) & HELD) == 0) delete r;
+            r = next;
+        }
+    }
+
+    template <class N>
+    static void destroy(void *p)
+    {
+        delete static_cast<N *>(p);
+    }
+};
+
+#endif
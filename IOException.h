@@ -0,0 +1,19 @@
+/** @file IOException.h
+ * Thrown when a file backing a container cannot be opened, mapped or resized
+ * For example, MappedArrayList<int> list("/no/such/dir/data");
+ */
+
+#include <string>
+
+#ifndef __IOEXCEPTION_H
+#define __IOEXCEPTION_H
+
+class IOException {
+public:
+    IOException() {}
+    IOException(std::string msg) : msg(msg) {}
+    std::string getMessage() const { return msg; }
+private:
+    std::string msg;
+};
+#endif
@@ -0,0 +1,442 @@
+/** @file */
+#ifndef __INDEXEDLINKEDLIST_H
+#define __INDEXEDLINKEDLIST_H
+
+#include "IndexOutOfBound.h"
+#include "ElementNotExist.h"
+#include <new>
+#include <cstddef>
+
+/**
+ * A list with the LinkedList interface whose positional operations (get, set,
+ * add(index, e), removeIndex) take O(log n) expected time instead of O(n).
+ *
+ * It is an indexable skip list. The elements form a singly linked list (level 0), and
+ * a random quarter of the nodes at each level is also linked at the level above. Every
+ * link records its width, the number of level-0 steps it skips, so a search for an index
+ * descends the levels skipping whole runs of elements. Inserting or removing updates
+ * one link per level.
+ *
+ * Nodes are allocated with exactly as many links as their level, and the head links are
+ * kept in the list object, so no element needs to be default-constructible.
+ */
+template <class T>
+class IndexedLinkedList
+{
+    static const int MAX_LEVEL = 16;
+
+    class Node;
+
+    class Link
+    {
+    public:
+        Node *node;
+        int width;
+    };
+
+    /**
+     * The level links follow the node in the same allocation, LINKS bytes from its start.
+     */
+    class Node
+    {
+    public:
+        T data;
+        int level;
+
+        Node(const T& data, int level):data(data), level(level) {}
+
+        Link *next()
+        {
+            return reinterpret_cast<Link *>(reinterpret_cast<char *>(this) + LINKS);
+        }
+
+        const Link *next() const
+        {
+            return reinterpret_cast<const Link *>(reinterpret_cast<const char *>(this) + LINKS);
+        }
+    };
+
+    static const size_t LINKS = (sizeof(Node) + alignof(Link) - 1) / alignof(Link) * alignof(Link);
+
+    Link head[MAX_LEVEL];
+    Node *tail;
+    int levels, currentSize;
+    unsigned seed;
+
+    int randomLevel()
+    {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        int level = 1;
+        for (unsigned r = seed; ((r & 3) == 0) && (level < MAX_LEVEL); r >>= 2) ++level;
+        return level;
+    }
+
+    Link *links(Node *x)
+    {
+        return x == NULL ? head : x -> next();
+    }
+
+    const Link *links(const Node *x) const
+    {
+        return x == NULL ? head : x -> next();
+    }
+
+    Node *newNode(const T& e, int level)
+    {
+        void *p = ::operator new(LINKS + sizeof(Link) * level);
+        Node *x;
+        try
+        {
+            x = new (p) Node(e, level);
+        }
+        catch (...)
+        {
+            ::operator delete(p);
+            throw;
+        }
+        for (int lv = 0; lv < level; ++lv) new (x -> next() + lv) Link;
+        return x;
+    }
+
+    void freeNode(Node *x)
+    {
+        x -> ~Node();
+        ::operator delete(x);
+    }
+
+    /**
+     * Returns the node at position index (0-based).
+     */
+    Node *find(int index) const
+    {
+        const Node *x = NULL;
+        int pos = 0;
+        for (int lv = levels - 1; lv >= 0; --lv)
+            for (const Link *l = links(x); (l[lv].node != NULL) && (pos + l[lv].width <= index + 1); l = links(x))
+                pos += l[lv].width, x = l[lv].node;
+        return const_cast<Node *>(x);
+    }
+
+    /**
+     * Fills update[lv] with the last node (NULL for head) at level lv before position
+     * index, and rank[lv] with its position counted from 1 (0 for head).
+     */
+    void predecessors(int index, Node **update, int *rank)
+    {
+        Node *x = NULL;
+        int pos = 0;
+        for (int lv = levels - 1; lv >= 0; --lv)
+        {
+            for (Link *l = links(x); (l[lv].node != NULL) && (pos + l[lv].width <= index); l = links(x))
+                pos += l[lv].width, x = l[lv].node;
+            update[lv] = x, rank[lv] = pos;
+        }
+    }
+
+    void insert(int index, const T& e)
+    {
+        Node *update[MAX_LEVEL];
+        int rank[MAX_LEVEL];
+        predecessors(index, update, rank);
+        int level = randomLevel();
+        Node *x = newNode(e, level);
+        for (; levels < level; ++levels) update[levels] = NULL, rank[levels] = 0, head[levels].node = NULL, head[levels].width = 0;
+        for (int lv = 0; lv < levels; ++lv)
+        {
+            Link &l = links(update[lv])[lv];
+            if (lv < level)
+            {
+                x -> next()[lv].node = l.node;
+                x -> next()[lv].width = l.width + rank[lv] - index;
+                l.node = x;
+                l.width = index + 1 - rank[lv];
+            }
+            else ++l.width;
+        }
+        if (x -> next()[0].node == NULL) tail = x;
+        ++currentSize;
+    }
+
+    void erase(int index)
+    {
+        Node *update[MAX_LEVEL];
+        int rank[MAX_LEVEL];
+        predecessors(index, update, rank);
+        Node *x = links(update[0])[0].node;
+        for (int lv = 0; lv < levels; ++lv)
+        {
+            Link &l = links(update[lv])[lv];
+            if (lv < x -> level)
+            {
+                l.width += x -> next()[lv].width - 1;
+                l.node = x -> next()[lv].node;
+            }
+            else --l.width;
+        }
+        if (x == tail) tail = update[0];
+        for (; (levels > 1) && (head[levels - 1].node == NULL); --levels);
+        freeNode(x);
+        --currentSize;
+    }
+
+    void init()
+    {
+        head[0].node = NULL, head[0].width = 0;
+        tail = NULL;
+        levels = 1, currentSize = 0;
+    }
+
+public:
+    class Iterator
+    {
+        IndexedLinkedList *link;
+        Node *upcoming;
+        int position;
+        bool removable;
+
+    public:
+        Iterator(IndexedLinkedList *link):link(link), upcoming(link -> head[0].node), position(-1), removable(false) {}
+
+        /**
+         * Returns true if the iteration has more elements.
+         */
+        bool hasNext() const
+        {
+            return upcoming != NULL;
+        }
+
+        /**
+         * Returns the next element in the iteration.
+         * @throw ElementNotExist exception when hasNext() == false
+         */
+        const T &next()
+        {
+            if (!hasNext()) throw ElementNotExist("IndexedLinkedList:next:ElementNotExist");
+            Node *x = upcoming;
+            upcoming = x -> next()[0].node;
+            ++position;
+            removable = true;
+            return x -> data;
+        }
+
+        /**
+         * Removes from the underlying list the last element returned by the iterator.
+         * @throw ElementNotExist
+         */
+        void remove()
+        {
+            if (!removable) throw ElementNotExist("IndexedLinkedList:remove:ElementNotExist");
+            link -> erase(position--);
+            removable = false;
+        }
+    };
+
+    /**
+     * Constructs an empty list.
+     */
+    IndexedLinkedList():seed(2463534242u)
+    {
+        init();
+    }
+
+    /**
+     * Copy constructor
+     */
+    IndexedLinkedList(const IndexedLinkedList &c):seed(2463534242u)
+    {
+        init();
+        for (const Node *x = c.head[0].node; x != NULL; x = x -> next()[0].node) addLast(x -> data);
+    }
+
+    /**
+     * Assignment operator
+     */
+    IndexedLinkedList& operator=(const IndexedLinkedList &c)
+    {
+        if (this == &c) return *this;
+        clear();
+        for (const Node *x = c.head[0].node; x != NULL; x = x -> next()[0].node) addLast(x -> data);
+        return *this;
+    }
+
+    /**
+     * Destructor
+     */
+    ~IndexedLinkedList()
+    {
+        clear();
+    }
+
+    /**
+     * Appends the specified element to the end of this list.
+     * Always returns true.
+     */
+    bool add(const T& e)
+    {
+        insert(currentSize, e);
+        return true;
+    }
+
+    /**
+     * Inserts the specified element to the beginning of this list.
+     */
+    void addFirst(const T& e)
+    {
+        insert(0, e);
+    }
+
+    /**
+     * Inserts the specified element to the end of this list.
+     */
+    void addLast(const T& e)
+    {
+        insert(currentSize, e);
+    }
+
+    /**
+     * Inserts the specified element to the specified position in this list.
+     * The range of index parameter is [0, size].
+     * @throw IndexOutOfBound
+     */
+    void add(int index, const T& e)
+    {
+        if ((index < 0) || (index > currentSize)) throw IndexOutOfBound("IndexedLinkedList:add:IndexOutOfBound");
+        insert(index, e);
+    }
+
+    /**
+     * Removes all of the elements from this list.
+     */
+    void clear()
+    {
+        for (Node *x = head[0].node; x != NULL;)
+        {
+            Node *next = x -> next()[0].node;
+            freeNode(x);
+            x = next;
+        }
+        init();
+    }
+
+    /**
+     * Returns true if this list contains the specified element.
+     */
+    bool contains(const T& e) const
+    {
+        for (const Node *x = head[0].node; x != NULL; x = x -> next()[0].node)
+            if (x -> data == e) return true;
+        return false;
+    }
+
+    /**
+     * Returns a const reference to the element at the specified position in this list.
+     * @throw IndexOutOfBound
+     */
+    const T& get(int index) const
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("IndexedLinkedList:get:IndexOutOfBound");
+        return find(index) -> data;
+    }
+
+    /**
+     * Returns a const reference to the first element.
+     * @throw ElementNotExist
+     */
+    const T& getFirst() const
+    {
+        if (currentSize == 0) throw ElementNotExist("IndexedLinkedList:getFirst:ElementNotExist");
+        return head[0].node -> data;
+    }
+
+    /**
+     * Returns a const reference to the last element.
+     * @throw ElementNotExist
+     */
+    const T& getLast() const
+    {
+        if (currentSize == 0) throw ElementNotExist("IndexedLinkedList:getLast:ElementNotExist");
+        return tail -> data;
+    }
+
+    /**
+     * Returns true if this list contains no elements.
+     */
+    bool isEmpty() const
+    {
+        return currentSize == 0;
+    }
+
+    /**
+     * Removes the element at the specified position in this list.
+     * @throw IndexOutOfBound
+     */
+    void removeIndex(int index)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("IndexedLinkedList:removeIndex:IndexOutOfBound");
+        erase(index);
+    }
+
+    /**
+     * Removes the first occurrence of the specified element from this list, if it is present.
+     * Returns true if it was present in the list, otherwise false.
+     */
+    bool remove(const T& e)
+    {
+        int index = 0;
+        for (const Node *x = head[0].node; x != NULL; x = x -> next()[0].node, ++index)
+            if (x -> data == e)
+            {
+                erase(index);
+                return true;
+            }
+        return false;
+    }
+
+    /**
+     * Removes the first element from this list.
+     * @throw ElementNotExist
+     */
+    void removeFirst()
+    {
+        if (currentSize == 0) throw ElementNotExist("IndexedLinkedList:removeFirst:ElementNotExist");
+        erase(0);
+    }
+
+    /**
+     * Removes the last element from this list.
+     * @throw ElementNotExist
+     */
+    void removeLast()
+    {
+        if (currentSize == 0) throw ElementNotExist("IndexedLinkedList:removeLast:ElementNotExist");
+        erase(currentSize - 1);
+    }
+
+    /**
+     * Replaces the element at the specified position in this list with the specified element.
+     * @throw IndexOutOfBound
+     */
+    void set(int index, const T& e)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("IndexedLinkedList:set:IndexOutOfBound");
+        find(index) -> data = e;
+    }
+
+    /**
+     * Returns the number of elements in this list.
+     */
+    int size() const
+    {
+        return currentSize;
+    }
+
+    /**
+     * Returns an iterator over the elements in this list.
+     */
+    Iterator iterator()
+    {
+        return Iterator(this);
+    }
+};
+
+#endif
@@ -0,0 +1,407 @@
+/** @file */
+#ifndef __INTRUSIVELIST_H
+#define __INTRUSIVELIST_H
+
+#include "IndexOutOfBound.h"
+#include "ElementNotExist.h"
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * The links an object embeds to be a member of an IntrusiveList. An object can sit in
+ * several lists at once by embedding one hook per list. Copying an object gives the
+ * copy a fresh, unlinked hook.
+ */
+class ListHook
+{
+    template <class T, ListHook T::*Hook> friend class IntrusiveList;
+
+    ListHook *pre, *next;
+
+public:
+    ListHook():pre(NULL), next(NULL) {}
+    ListHook(const ListHook&):pre(NULL), next(NULL) {}
+    ListHook& operator=(const ListHook&) { return *this; }
+
+    /**
+     * Returns true if the owning object is currently in a list through this hook.
+     */
+    bool isLinked() const
+    {
+        return next != NULL;
+    }
+};
+
+/**
+ * A doubly linked list of objects that live elsewhere and embed a ListHook, selected by
+ * the Hook member pointer. The list never allocates, copies or deletes elements: adding
+ * links the object's hook in, removing unlinks it, both in O(1), and remove(e) needs only
+ * the object. splice moves elements between lists in O(1).
+ *
+ * The list is circular around a hook inside the list object, so it cannot be copied.
+ * An object must be removed from a list before it is destroyed, and must not be added
+ * through a hook that is already linked. To get from a hook back to its object the list
+ * subtracts the hook's offset inside T, which depends on Hook alone: it is measured once
+ * on raw storage for a T, never constructed, and the compiler folds it to a constant,
+ * so it holds for every list from the start, whatever T derives from.
+ * @code
+ *      class Job
+ *      {
+ *      public:
+ *          int id;
+ *          ListHook queued;
+ *      };
+ *      IntrusiveList<Job, &Job::queued> ready;
+ *      ready.add(&job);
+ *      ready.remove(&job);
+ * @endcode
+ */
+template <class T, ListHook T::*Hook>
+class IntrusiveList
+{
+    ListHook root;
+    int currentSize;
+
+    /**
+     * Returns where the Hook member sits inside a T, from the member pointer alone.
+     */
+    static std::ptrdiff_t offset()
+    {
+        static typename std::aligned_storage<sizeof(T), alignof(T)>::type probe;
+        T *t = reinterpret_cast<T *>(&probe);
+        return reinterpret_cast<char *>(&(t ->* Hook)) - reinterpret_cast<char *>(t);
+    }
+
+    static ListHook *hook(T *e)
+    {
+        return &(e ->* Hook);
+    }
+
+    /**
+     * Returns the object embedding h.
+     */
+    static T *owner(ListHook *h)
+    {
+        return reinterpret_cast<T *>(reinterpret_cast<char *>(h) - offset());
+    }
+
+    /**
+     * Returns e's hook, which must be linked.
+     * @throw ElementNotExist
+     */
+    ListHook *linked(T *e, const char *where)
+    {
+        ListHook *h = hook(e);
+        if (!h -> isLinked()) throw ElementNotExist(where);
+        return h;
+    }
+
+    static void linkBefore(ListHook *position, ListHook *h)
+    {
+        h -> next = position;
+        h -> pre = position -> pre;
+        position -> pre -> next = h;
+        position -> pre = h;
+    }
+
+    static void unlink(ListHook *h)
+    {
+        h -> pre -> next = h -> next;
+        h -> next -> pre = h -> pre;
+        h -> pre = h -> next = NULL;
+    }
+
+    ListHook *at(int index)
+    {
+        ListHook *h;
+        if (index < currentSize / 2) for (h = root.next; index > 0; --index) h = h -> next;
+        else for (h = root.pre, index = currentSize - 1 - index; index > 0; --index) h = h -> pre;
+        return h;
+    }
+
+public:
+    class Iterator
+    {
+        IntrusiveList *link;
+        ListHook *last, *upcoming;
+
+    public:
+        Iterator(IntrusiveList *link):link(link), last(NULL), upcoming(link -> root.next) {}
+
+        /**
+         * Returns true if the iteration has more elements.
+         */
+        bool hasNext() const
+        {
+            return upcoming != &link -> root;
+        }
+
+        /**
+         * Returns the next element in the iteration.
+         * @throw ElementNotExist exception when hasNext() == false
+         */
+        T *next()
+        {
+            if (!hasNext()) throw ElementNotExist("IntrusiveList:next:ElementNotExist");
+            last = upcoming;
+            upcoming = upcoming -> next;
+            return link -> owner(last);
+        }
+
+        /**
+         * Unlinks from the underlying list the last element returned by the iterator.
+         * @throw ElementNotExist
+         */
+        void remove()
+        {
+            if (last == NULL) throw ElementNotExist("IntrusiveList:remove:ElementNotExist");
+            unlink(last);
+            -- link -> currentSize;
+            last = NULL;
+        }
+    };
+
+    /**
+     * Constructs an empty list.
+     */
+    IntrusiveList():currentSize(0)
+    {
+        root.pre = root.next = &root;
+    }
+
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+    /**
+     * Destructor. Unlinks every element; the elements themselves are untouched.
+     */
+    ~IntrusiveList()
+    {
+        clear();
+    }
+
+    /**
+     * Links e in at the end of this list.
+     * Always returns true.
+     */
+    bool add(T *e)
+    {
+        linkBefore(&root, hook(e));
+        ++currentSize;
+        return true;
+    }
+
+    /**
+     * Links e in at the beginning of this list.
+     */
+    void addFirst(T *e)
+    {
+        linkBefore(root.next, hook(e));
+        ++currentSize;
+    }
+
+    /**
+     * Links e in at the end of this list. Equivalent to add.
+     */
+    void addLast(T *e)
+    {
+        add(e);
+    }
+
+    /**
+     * Links e in just before position, which must be in this list.
+     */
+    void addBefore(T *position, T *e)
+    {
+        linkBefore(hook(position), hook(e));
+        ++currentSize;
+    }
+
+    /**
+     * Links e in at the specified position, walking from the nearer end.
+     * @throw IndexOutOfBound
+     */
+    void add(int index, T *e)
+    {
+        if ((index < 0) || (index > currentSize)) throw IndexOutOfBound("IntrusiveList:add:IndexOutOfBound");
+        linkBefore(index == currentSize ? &root : at(index), hook(e));
+        ++currentSize;
+    }
+
+    /**
+     * Unlinks every element from this list.
+     */
+    void clear()
+    {
+        for (ListHook *h = root.next; h != &root;)
+        {
+            ListHook *next = h -> next;
+            h -> pre = h -> next = NULL;
+            h = next;
+        }
+        root.pre = root.next = &root;
+        currentSize = 0;
+    }
+
+    /**
+     * Returns true if e is in this list. O(n); ListHook::isLinked answers in O(1)
+     * whether it is in any list through this hook.
+     */
+    bool contains(const T *e) const
+    {
+        const ListHook *target = &(e ->* Hook);
+        for (const ListHook *h = root.next; h != &root; h = h -> next) if (h == target) return true;
+        return false;
+    }
+
+    /**
+     * Returns the element at the specified position, walking from the nearer end.
+     * @throw IndexOutOfBound
+     */
+    T *get(int index)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("IntrusiveList:get:IndexOutOfBound");
+        return owner(at(index));
+    }
+
+    /**
+     * Returns the first element.
+     * @throw ElementNotExist
+     */
+    T *getFirst()
+    {
+        if (currentSize == 0) throw ElementNotExist("IntrusiveList:getFirst:ElementNotExist");
+        return owner(root.next);
+    }
+
+    /**
+     * Returns the last element.
+     * @throw ElementNotExist
+     */
+    T *getLast()
+    {
+        if (currentSize == 0) throw ElementNotExist("IntrusiveList:getLast:ElementNotExist");
+        return owner(root.pre);
+    }
+
+    /**
+     * Returns the element after e in this list, or NULL if e is the last one.
+     * @throw ElementNotExist if e is not linked
+     */
+    T *nextOf(T *e)
+    {
+        ListHook *h = linked(e, "IntrusiveList:nextOf:ElementNotExist") -> next;
+        return h == &root ? NULL : owner(h);
+    }
+
+    /**
+     * Returns the element before e in this list, or NULL if e is the first one.
+     * @throw ElementNotExist if e is not linked
+     */
+    T *previousOf(T *e)
+    {
+        ListHook *h = linked(e, "IntrusiveList:previousOf:ElementNotExist") -> pre;
+        return h == &root ? NULL : owner(h);
+    }
+
+    /**
+     * Returns true if this list contains no elements.
+     */
+    bool isEmpty() const
+    {
+        return currentSize == 0;
+    }
+
+    /**
+     * Unlinks e, which must be in this list, in O(1). An e linked into another list
+     * through the same hook cannot be told apart and corrupts both sizes.
+     * @throw ElementNotExist if e is not linked
+     */
+    void remove(T *e)
+    {
+        unlink(linked(e, "IntrusiveList:remove:ElementNotExist"));
+        --currentSize;
+    }
+
+    /**
+     * Unlinks the element at the specified position.
+     * @throw IndexOutOfBound
+     */
+    void removeIndex(int index)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("IntrusiveList:removeIndex:IndexOutOfBound");
+        unlink(at(index));
+        --currentSize;
+    }
+
+    /**
+     * Unlinks the first element.
+     * @throw ElementNotExist
+     */
+    void removeFirst()
+    {
+        if (currentSize == 0) throw ElementNotExist("IntrusiveList:removeFirst:ElementNotExist");
+        unlink(root.next);
+        --currentSize;
+    }
+
+    /**
+     * Unlinks the last element.
+     * @throw ElementNotExist
+     */
+    void removeLast()
+    {
+        if (currentSize == 0) throw ElementNotExist("IntrusiveList:removeLast:ElementNotExist");
+        unlink(root.pre);
+        --currentSize;
+    }
+
+    /**
+     * Moves e from other to just before position in this list (the end if position is NULL).
+     * @throw ElementNotExist if e is not linked
+     */
+    void splice(T *position, IntrusiveList& other, T *e)
+    {
+        ListHook *h = linked(e, "IntrusiveList:splice:ElementNotExist");
+        unlink(h);
+        --other.currentSize;
+        linkBefore(position == NULL ? &root : hook(position), h);
+        ++currentSize;
+    }
+
+    /**
+     * Moves every element of other to just before position in this list (the end if
+     * position is NULL), in O(1).
+     */
+    void splice(T *position, IntrusiveList& other)
+    {
+        if ((&other == this) || other.isEmpty()) return;
+        ListHook *where = position == NULL ? &root : hook(position);
+        ListHook *first = other.root.next, *last = other.root.pre;
+        first -> pre = where -> pre;
+        where -> pre -> next = first;
+        last -> next = where;
+        where -> pre = last;
+        currentSize += other.currentSize;
+        other.root.pre = other.root.next = &other.root;
+        other.currentSize = 0;
+    }
+
+    /**
+     * Returns the number of elements in this list.
+     */
+    int size() const
+    {
+        return currentSize;
+    }
+
+    /**
+     * Returns an iterator over the elements in this list.
+     */
+    Iterator iterator()
+    {
+        return Iterator(this);
+    }
+};
+
+#endif
@@ -0,0 +1,15 @@
+/** @file */
+#ifndef __LESS_H
+#define __LESS_H
+
+/**
+ * Default Comparator with respect to natural order (operator<).
+ */
+template <class V>
+class Less
+{
+public:
+    bool operator()(const V& a, const V& b) { return a < b; }
+};
+
+#endif
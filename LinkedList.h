@@ -4,11 +4,40 @@
 
 #include "IndexOutOfBound.h"
 #include "ElementNotExist.h"
+#include "NodePool.h"
+#include "Less.h"
+#include <new>
 
 /**
  * A linked list.
  *
  * The iterator iterates in the order of the elements being loaded into this list.
+ *
+ * Nodes come from a NodePool instead of one new/delete each. A default list allocates
+ * its first LOOSE nodes one at a time, so that short lists cost no more than their nodes,
+ * and gets a private pool, which adopts those nodes, only when it grows past them. Lists
+ * constructed with a shared Pool allocate from it instead, so nodes freed by one list are
+ * reused by the others.
+ *
+ * Positional access (get, set, add(index, e), removeIndex) walks from whichever of head,
+ * tail or the "finger" (the node reached by the previous positional access) is closest,
+ * so sequential loops such as for (i...) list.get(i) take O(1) per step. Only non-const
+ * operations move the finger: get on a const list starts from it but never writes it,
+ * so several threads may read a list they share through a const reference, as with
+ * iterators. For O(log n) positional access at random indices use IndexedLinkedList.
+ *
+ * splice, splitAt and concat relink nodes within a list, between lists on one shared
+ * Pool, and out of a list that still allocates one node at a time. Taking every element
+ * of a list with a private pool relinks too: the pool moves over with them and the
+ * emptied list starts afresh. Anything else, such as part of a list with a private pool,
+ * is copied element by element, so two lists never share an allocator unless they were
+ * constructed on one shared Pool; put lists that exchange ranges often on one to make
+ * every move a relink. Lists on one shared Pool must not be used from different threads
+ * at the same time. sort relinks nodes and never copies an element.
+ * @code
+ *      LinkedList<int>::Pool pool;
+ *      LinkedList<int> a(pool), b(pool);
+ * @endcode
  */
 template <class T>
 class LinkedList
@@ -24,48 +53,205 @@ class LinkedList
     } *head, *tail;
     int currentSize;
 
+public:
+    typedef NodePool<Node> Pool;
+
+private:
+    /**
+     * The number of elements up to which a default list has no pool.
+     */
+    static const int LOOSE = 16;
+
+    /**
+     * pool is NULL while the nodes are allocated one at a time; ownsPool is false when
+     * pool is a shared Pool.
+     */
+    Pool *pool;
+    bool ownsPool;
+    Node *finger;
+    int fingerIndex;
+
+    /**
+     * Starts allocating from p, which adopts the nodes allocated one at a time so far.
+     */
+    void join(Pool *p, bool owns)
+    {
+        if (pool == NULL)
+            for (Node *x = head; x != NULL; x = x -> next) p -> adopt(x);
+        pool = p, ownsPool = owns;
+    }
+
+    void newPool()
+    {
+        join(new Pool, true);
+    }
+
+    /**
+     * Takes over the private pool of other, all of whose nodes are moving to this list,
+     * and leaves other allocating one node at a time again.
+     */
+    void takePool(LinkedList &other)
+    {
+        if (pool == NULL) join(other.pool, true);
+        else
+        {
+            pool -> absorb(*other.pool);
+            delete other.pool;
+        }
+        other.pool = NULL, other.ownsPool = false;
+    }
+
+    /**
+     * Returns the node at index, walking from the closest of head, tail and finger.
+     * Reads the finger but does not move it.
+     */
+    Node *find(int index) const
+    {
+        Node *now = head;
+        int at = 0, distance = index;
+        if (currentSize - 1 - index < distance) now = tail, at = currentSize - 1, distance = currentSize - 1 - index;
+        if ((finger != NULL) && (fingerIndex - index < distance) && (index - fingerIndex < distance)) now = finger, at = fingerIndex;
+        for (; at < index; ++at) now = now -> next;
+        for (; at > index; --at) now = now -> pre;
+        return now;
+    }
+
+    /**
+     * Returns the node at index like find, and leaves the finger there.
+     */
+    Node *locate(int index)
+    {
+        Node *now = find(index);
+        finger = now, fingerIndex = index;
+        return now;
+    }
+
+    Node *newNode(Node *pre, const T& data, Node *next)
+    {
+        void *p;
+        if (pool != NULL) p = pool -> allocate();
+        else if (currentSize < LOOSE) p = Pool::allocateOne();
+        else
+        {
+            newPool();
+            p = pool -> allocate();
+        }
+        try
+        {
+            return new (p) Node(pre, data, next);
+        }
+        catch (...)
+        {
+            releaseNode(p);
+            throw;
+        }
+    }
+
+    void releaseNode(void *p)
+    {
+        if (pool != NULL) pool -> release(p);
+        else Pool::releaseOne(p);
+    }
+
     void deleteElement(Node *now)
     {
-		if ((now == head) && (head == tail))
-		{
-			if (now -> pre != NULL) now -> pre -> next = NULL;
-			delete now;
-			head = tail = NULL;
-			return;
-		}
+        if (now == finger) finger = NULL;
         if (now == head) head = head -> next;
         if (now == tail) tail = tail -> pre;
         if (now -> pre != NULL) now -> pre -> next = now -> next;
         if (now -> next != NULL) now -> next -> pre = now -> pre;
-        delete now;
+        now -> ~Node();
+        releaseNode(now);
+    }
+
+    /**
+     * Moves the count nodes first..last of other to just before position in this list
+     * (the end if position is NULL). Relinked if both lists allocate from one pool, if
+     * the nodes were allocated one at a time (this list's pool adopts them), or if they
+     * are all of other's and other owns its pool (this list takes it over); copied
+     * otherwise, so that two lists never end up sharing a pool they did not share before.
+     */
+    void transfer(Node *position, LinkedList &other, Node *first, Node *last, int count)
+    {
+        if (count <= 0) return;
+        finger = other.finger = NULL;
+        if (pool != other.pool)
+        {
+            if (other.pool == NULL)
+                for (Node *x = first, *stop = last -> next; x != stop; x = x -> next) pool -> adopt(x);
+            else if ((count == other.currentSize) && other.ownsPool) takePool(other);
+            else
+            {
+                for (Node *x = first, *stop = last -> next; x != stop;)
+                {
+                    Node *next = x -> next;
+                    Node *before = position == NULL ? tail : position -> pre;
+                    Node *now = newNode(before, x -> data, position);
+                    if (before != NULL) before -> next = now;
+                    else head = now;
+                    if (position != NULL) position -> pre = now;
+                    else tail = now;
+                    ++currentSize;
+                    other.deleteElement(x);
+                    --other.currentSize;
+                    x = next;
+                }
+                return;
+            }
+        }
+        if (first -> pre != NULL) first -> pre -> next = last -> next;
+        else other.head = last -> next;
+        if (last -> next != NULL) last -> next -> pre = first -> pre;
+        else other.tail = first -> pre;
+        other.currentSize -= count;
+        Node *before = position == NULL ? tail : position -> pre;
+        first -> pre = before;
+        last -> next = position;
+        if (before != NULL) before -> next = first;
+        else head = first;
+        if (position != NULL) position -> pre = last;
+        else tail = last;
+        currentSize += count;
+    }
+
+    /**
+     * Merges the NULL-terminated runs a and b, a holding the earlier elements,
+     * following next pointers only. Equal elements keep a's first.
+     */
+    template <class C>
+    static Node *merge(Node *a, Node *b, C& cmp)
+    {
+        Node *result = NULL, **end = &result;
+        for (; (a != NULL) && (b != NULL); end = &(*end) -> next)
+            if (cmp(b -> data, a -> data)) *end = b, b = b -> next;
+            else *end = a, a = a -> next;
+        *end = a != NULL ? a : b;
+        return result;
     }
 
 public:
+    /**
+     * Walks the list with two node pointers: the node returned last (for remove) and
+     * the node to return next. Creating or copying one allocates nothing and never
+     * writes to the list, so several iterators may read the same list concurrently.
+     */
     class Iterator
     {
-        Node *now, *tmp;
+        friend class LinkedList;
+
         LinkedList<T> *link;
-		int status;
-		T *T_T;
+        Node *last, *upcoming;
+        int index;
     public:
 
-        Iterator(LinkedList<T> *_link):link(_link), status(-1)
-        {
-            now = new Node(NULL, *(T_T = new T), link -> head);
-            tmp = now;
-			if (link -> head != NULL) link -> head -> pre = now;
-        }
-        ~Iterator()
-        {
-        	delete tmp;
-        	delete T_T;
-        }
+        Iterator(LinkedList<T> *_link):link(_link), last(NULL), upcoming(_link -> head), index(0) {}
+
         /**
          * TODO Returns true if the iteration has more elements.
          */
-        bool hasNext()
+        bool hasNext() const
         {
-            return now -> next != NULL;
+            return upcoming != NULL;
         }
 
         /**
@@ -75,9 +261,10 @@ public:
         const T &next()
         {
             if (!hasNext()) throw ElementNotExist("LinkedList:next:ElementNotExist");
-            now = now -> next;
-			status = 0;
-            return now -> data;
+            last = upcoming;
+            upcoming = upcoming -> next;
+            ++index;
+            return last -> data;
         }
 
         /**
@@ -90,23 +277,31 @@ public:
          */
         void remove()
         {
-            if ((now == NULL) || (status == -1)) throw ElementNotExist("LInkedList:remove:ElementNotExist");
-            Node *tmp = now; now = now -> pre;
-            link -> deleteElement(tmp);
-			-- link -> currentSize;
-			status = -1;
+            if (last == NULL) throw ElementNotExist("LInkedList:remove:ElementNotExist");
+            link -> deleteElement(last);
+            -- link -> currentSize;
+            link -> finger = NULL;
+            last = NULL;
+            --index;
         }
     };
 
     /**
      * TODO Constructs an empty linked list
      */
-    LinkedList():head(NULL), tail(NULL), currentSize(0){}
+    LinkedList():head(NULL), tail(NULL), currentSize(0), pool(NULL), ownsPool(false), finger(NULL){}
+
+    /**
+     * Constructs an empty linked list that allocates its nodes from shared.
+     * shared must outlive the list.
+     */
+    LinkedList(Pool &shared):head(NULL), tail(NULL), currentSize(0), pool(&shared), ownsPool(false), finger(NULL){}
 
     /**
      * TODO Copy constructor
+     * The copy shares c's pool if c uses a shared one.
      */
-    LinkedList(const LinkedList<T> &c)
+    LinkedList(const LinkedList<T> &c):currentSize(0), pool(c.ownsPool ? NULL : c.pool), ownsPool(false), finger(NULL)
     {
 		head = tail = NULL;
     	/*
@@ -153,6 +348,7 @@ public:
             tmp = tmp -> next;
             deleteElement(temp);
         }
+        if (ownsPool) delete pool;
     }
 
     /**
@@ -172,14 +368,15 @@ public:
     {
         if (head == NULL)
         {
-            head = tail = new Node(NULL, elem, NULL);
+            head = tail = newNode(NULL, elem, NULL);
             ++currentSize;
             return;
         }
-        Node *tmp = new Node(NULL, elem, head);
+        Node *tmp = newNode(NULL, elem, head);
         head -> pre = tmp;
         head = tmp;
         ++currentSize;
+        if (finger != NULL) ++fingerIndex;
     }
 
     /**
@@ -190,11 +387,11 @@ public:
     {
         if (head == NULL)
         {
-            head = tail = new Node(NULL, elem, NULL);
+            head = tail = newNode(NULL, elem, NULL);
             ++currentSize;
             return;
         }
-        Node *tmp = new Node(tail, elem, NULL);
+        Node *tmp = newNode(tail, elem, NULL);
         tail -> next = tmp;
         tail = tmp;
         ++currentSize;
@@ -213,13 +410,13 @@ public:
             addFirst(element);
         else
         {
-            Node *tmp = head;
-            for (int i = 1; i < index; ++i) tmp = tmp -> next;
-            Node *now = new Node(tmp, element, tmp -> next);
+            Node *tmp = locate(index - 1);
+            Node *now = newNode(tmp, element, tmp -> next);
             if (tmp -> next != NULL) tmp -> next -> pre = now;
             else tail = now;
             tmp -> next = now;
 			++currentSize;
+            finger = now, fingerIndex = index;
         }
     }
 
@@ -251,14 +448,24 @@ public:
     /**
      * TODO Returns a const reference to the element at the specified position in this list.
      * The index is zero-based, with range [0, size).
+     * Moves the finger to index.
+     * @throw IndexOutOfBound
+     */
+    const T& get(int index)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("LinkedList:get:IndexOutOfBound");
+        return locate(index) -> data;
+    }
+
+    /**
+     * Returns a const reference to the element at the specified position, like get, but
+     * leaves the finger where it is, so concurrent calls on a shared const list are safe.
      * @throw IndexOutOfBound
      */
     const T& get(int index) const
     {
         if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("LinkedList:get:IndexOutOfBound");
-        Node *tmp = head;
-        for (int i = 0; i < index; ++i) tmp = tmp -> next;
-        return tmp -> data;
+        return find(index) -> data;
     }
 
     /**
@@ -297,10 +504,10 @@ public:
     void removeIndex(int index)
     {
         if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("LinkedList:removeIndex:IndexOutOfBound");
-        Node *tmp = head;
-        for (int i = 0; i < index; ++i) tmp = tmp -> next;
+        Node *tmp = locate(index), *next = tmp -> next;
         deleteElement(tmp);
         --currentSize;
+        if (next != NULL) finger = next, fingerIndex = index;
     }
 
     /**
@@ -309,10 +516,12 @@ public:
      */
     bool remove(const T &e)
     {
-        for (Node *tmp = head; tmp != NULL; tmp = tmp -> next) if (tmp -> data == e)
+        int index = 0;
+        for (Node *tmp = head; tmp != NULL; tmp = tmp -> next, ++index) if (tmp -> data == e)
         {
             deleteElement(tmp);
             --currentSize;
+            if ((finger != NULL) && (fingerIndex > index)) --fingerIndex;
             return true;
         }
         return false;
@@ -326,6 +535,7 @@ public:
     {
         deleteElement(head);
         --currentSize;
+        if (finger != NULL) --fingerIndex;
     }
 
     /**
@@ -346,9 +556,7 @@ public:
     void set(int index, const T &element)
     {
         if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("LinkedList:set:IndexOutOfBound");
-        Node *tmp = head;
-        for (int i = 0; i < index; ++i) tmp = tmp -> next;
-        tmp -> data = element;
+        locate(index) -> data = element;
     }
 
     /**
@@ -359,6 +567,96 @@ public:
         return currentSize;
     }
 
+    /**
+     * Moves the elements of other in [first, last), from the element first.next() would
+     * return up to but excluding the one last.next() would return, to just before the
+     * element position.next() would return (the end if none). position is an iterator over
+     * this list and first, last iterators over other, with first not after last; other
+     * may be this list if position is outside the range. Iterators over either list are
+     * invalidated. Relinks nodes; see the class comment for the pools.
+     */
+    void splice(const Iterator& position, LinkedList &other, const Iterator& first, const Iterator& last)
+    {
+        int count = last.index - first.index;
+        if ((count <= 0) || (position.upcoming == first.upcoming)) return;
+        transfer(position.upcoming, other, first.upcoming, last.upcoming == NULL ? other.tail : last.upcoming -> pre, count);
+    }
+
+    /**
+     * Moves every element of other to just before the element position.next() would
+     * return (the end if none). Relinks nodes; see the class comment for the pools.
+     */
+    void splice(const Iterator& position, LinkedList &other)
+    {
+        if (&other == this) return;
+        transfer(position.upcoming, other, other.head, other.tail, other.currentSize);
+    }
+
+    /**
+     * Moves the elements from the one position.next() would return to the end of this
+     * list onto the end of rest. Relinks nodes; see the class comment for the pools.
+     */
+    void splitAt(const Iterator& position, LinkedList &rest)
+    {
+        if (&rest == this) return;
+        rest.transfer(NULL, *this, position.upcoming, tail, currentSize - position.index);
+    }
+
+    /**
+     * Moves every element of other onto the end of this list, leaving other empty.
+     * Relinks nodes; see the class comment for the pools.
+     */
+    void concat(LinkedList &other)
+    {
+        if (&other == this) return;
+        transfer(NULL, other, other.head, other.tail, other.currentSize);
+    }
+
+    /**
+     * Sorts this list by the natural ordering (operator<). Stable.
+     */
+    void sort()
+    {
+        Less<T> less;
+        sort(less);
+    }
+
+    /**
+     * Sorts this list by cmp, a strict weak ordering called as cmp(a, b) for "a before b".
+     * A stable bottom-up merge sort that relinks the nodes in place: O(n log n) comparisons,
+     * O(1) extra memory, and no element is copied or moved.
+     */
+    template <class C>
+    void sort(C cmp)
+    {
+        if (currentSize < 2) return;
+        // bins[i] holds a sorted run of 2^i nodes; a higher bin holds earlier elements
+        Node *bins[32] = { NULL };
+        int used = 0;
+        for (Node *x = head; x != NULL;)
+        {
+            Node *carry = x;
+            x = x -> next;
+            carry -> next = NULL;
+            int i = 0;
+            for (; (i < used) && (bins[i] != NULL); ++i)
+            {
+                carry = merge(bins[i], carry, cmp);
+                bins[i] = NULL;
+            }
+            bins[i] = carry;
+            if (i == used) ++used;
+        }
+        Node *result = NULL;
+        for (int i = 0; i < used; ++i)
+            if (bins[i] != NULL) result = result == NULL ? bins[i] : merge(bins[i], result, cmp);
+        head = result;
+        Node *pre = NULL;
+        for (Node *x = head; x != NULL; pre = x, x = x -> next) x -> pre = pre;
+        tail = pre;
+        finger = NULL;
+    }
+
     /**
      * TODO Returns an iterator over the elements in this list.
      */
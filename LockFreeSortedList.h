@@ -0,0 +1,183 @@
+/** @file */
+#ifndef __LOCKFREESORTEDLIST_H
+#define __LOCKFREESORTEDLIST_H
+
+#include "EpochReclaimer.h"
+#include "Less.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A sorted set that any number of threads may add to, remove from and query at the same
+ * time without locks, after Harris ("A Pragmatic Implementation of Non-Blocking Linked
+ * Lists", 2001) with Michael's search ("High Performance Dynamic Lock-Free Hash Tables
+ * and List-Based Sets", 2002).
+ *
+ * The elements form a singly linked list in increasing order under C. Removal first marks
+ * the low bit of the victim's next pointer (logical deletion), which makes any concurrent
+ * insertion after it fail its CAS, and then swings the predecessor past it. Traversals
+ * unlink the marked nodes they meet. Unlinked nodes are handed to an EpochReclaimer and
+ * freed once no thread can still be looking at them.
+ *
+ * add and remove are lock-free, contains is wait-free. Each operation takes effect at a
+ * single successful CAS (or, for contains, a single read), so the set is linearizable.
+ */
+template <class T, class C = Less<T> >
+class LockFreeSortedList
+{
+    class Node
+    {
+    public:
+        T data;
+        std::atomic<uintptr_t> next;
+
+        Node(const T& data):data(data), next(0) {}
+    };
+
+    static Node *pointer(uintptr_t p)
+    {
+        return reinterpret_cast<Node *>(p & ~(uintptr_t)1);
+    }
+
+    static bool marked(uintptr_t p)
+    {
+        return (p & 1) != 0;
+    }
+
+    C cmp;
+    std::atomic<uintptr_t> head;
+    std::atomic<int> currentSize;
+    EpochReclaimer reclaimer;
+
+    /**
+     * Positions prev and cur so that *prev held cur, cur is the first node not less than e
+     * (NULL at the end), unlinking marked nodes on the way.
+     * Returns true if cur holds e.
+     */
+    bool find(const T& e, std::atomic<uintptr_t> *&prev, Node *&cur, EpochReclaimer::Guard& guard)
+    {
+    retry:
+        prev = &head;
+        cur = pointer(prev->load(std::memory_order_acquire));
+        while (cur != NULL)
+        {
+            uintptr_t next = cur->next.load(std::memory_order_acquire);
+            if (marked(next))
+            {
+                uintptr_t expected = reinterpret_cast<uintptr_t>(cur);
+                if (!prev->compare_exchange_strong(expected, next & ~(uintptr_t)1, std::memory_order_acq_rel, std::memory_order_acquire))
+                    goto retry;
+                guard.retire(cur);
+                cur = pointer(next);
+                continue;
+            }
+            if (!cmp(cur->data, e)) return !cmp(e, cur->data);
+            prev = &cur->next;
+            cur = pointer(next);
+        }
+        return false;
+    }
+
+public:
+    /**
+     * Constructs an empty list.
+     */
+    LockFreeSortedList():head(0), currentSize(0) {}
+
+    LockFreeSortedList(const LockFreeSortedList&) = delete;
+    LockFreeSortedList& operator=(const LockFreeSortedList&) = delete;
+
+    /**
+     * Destructor. No other thread may be using the list.
+     */
+    ~LockFreeSortedList()
+    {
+        for (Node *x = pointer(head.load(std::memory_order_relaxed)); x != NULL;)
+        {
+            Node *next = pointer(x->next.load(std::memory_order_relaxed));
+            delete x;
+            x = next;
+        }
+    }
+
+    /**
+     * Inserts e if no equal element is present.
+     * Returns true if e was inserted.
+     */
+    bool add(const T& e)
+    {
+        EpochReclaimer::Guard guard(reclaimer);
+        Node *node = NULL;
+        for (;;)
+        {
+            std::atomic<uintptr_t> *prev;
+            Node *cur;
+            if (find(e, prev, cur, guard))
+            {
+                delete node;
+                return false;
+            }
+            if (node == NULL) node = new Node(e);
+            node->next.store(reinterpret_cast<uintptr_t>(cur), std::memory_order_relaxed);
+            uintptr_t expected = reinterpret_cast<uintptr_t>(cur);
+            if (prev->compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node), std::memory_order_release, std::memory_order_relaxed))
+            {
+                currentSize.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Removes the element equal to e if there is one.
+     * Returns true if this call removed it.
+     */
+    bool remove(const T& e)
+    {
+        EpochReclaimer::Guard guard(reclaimer);
+        for (;;)
+        {
+            std::atomic<uintptr_t> *prev;
+            Node *cur;
+            if (!find(e, prev, cur, guard)) return false;
+            uintptr_t next = cur->next.load(std::memory_order_acquire);
+            if (marked(next)) continue;
+            if (!cur->next.compare_exchange_strong(next, next | 1, std::memory_order_acq_rel, std::memory_order_relaxed)) continue;
+            currentSize.fetch_sub(1, std::memory_order_relaxed);
+            uintptr_t expected = reinterpret_cast<uintptr_t>(cur);
+            if (prev->compare_exchange_strong(expected, next, std::memory_order_acq_rel, std::memory_order_relaxed)) guard.retire(cur);
+            else find(e, prev, cur, guard);
+            return true;
+        }
+    }
+
+    /**
+     * Returns true if an element equal to e is present.
+     */
+    bool contains(const T& e)
+    {
+        EpochReclaimer::Guard guard(reclaimer);
+        Node *cur = pointer(head.load(std::memory_order_acquire));
+        while ((cur != NULL) && cmp(cur->data, e)) cur = pointer(cur->next.load(std::memory_order_acquire));
+        return (cur != NULL) && !cmp(e, cur->data) && !marked(cur->next.load(std::memory_order_acquire));
+    }
+
+    /**
+     * Returns the number of elements; approximate while other threads are modifying the list.
+     */
+    int size() const
+    {
+        return currentSize.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns true if the list looks empty.
+     */
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+};
+
+#endif
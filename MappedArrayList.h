@@ -0,0 +1,307 @@
+/** @file */
+#ifndef __MAPPEDARRAYLIST_H
+#define __MAPPEDARRAYLIST_H
+
+#include "IndexOutOfBound.h"
+#include "ElementNotExist.h"
+#include "IOException.h"
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * An ArrayList of trivially-copyable elements whose storage is a memory-mapped file,
+ * for arrays larger than RAM. The kernel pages elements in and out on demand.
+ *
+ * The file starts with a small header (magic, element size, element count) followed by
+ * the elements. The count is kept in the mapping, so opening an existing file maps it
+ * as it is without reading it. Growth extends the file with ftruncate and the mapping
+ * with mremap; the destructor trims the file to the used length.
+ *
+ * Sizes and indices are long long, so a list may hold more than 2^31 elements.
+ *
+ * Linux only (mremap, MAP_SHARED). A MappedArrayList can not be copied.
+ */
+template <class T>
+class MappedArrayList
+{
+    static_assert(std::is_trivially_copyable<T>::value, "MappedArrayList needs a trivially copyable T");
+
+    class Header
+    {
+    public:
+        char magic[8];
+        long long elementSize, currentSize;
+    };
+
+    /**
+     * Elements start at this offset so that any element type is aligned.
+     */
+    static const int HEADER = 64;
+
+    /**
+     * The most elements whose file length still fits in an off_t.
+     */
+    static const long long MAX_SIZE = (std::numeric_limits<long long>::max() - HEADER) / (long long)sizeof(T);
+
+public:
+    /**
+     * Access pattern hints passed to madvise.
+     */
+    enum Advice { NORMAL = MADV_NORMAL, SEQUENTIAL = MADV_SEQUENTIAL, RANDOM = MADV_RANDOM, WILLNEED = MADV_WILLNEED };
+
+private:
+    int fd;
+    char *base;
+    size_t mapped;
+    Header *header;
+    T *data;
+    long long maxSize;
+    Advice advice;
+
+    void remap(size_t length)
+    {
+        if (ftruncate(fd, length) != 0) throw IOException("MappedArrayList:remap:ftruncate failed");
+        void *p = mremap(base, mapped, length, MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) throw IOException("MappedArrayList:remap:mremap failed");
+        setMapping(p, length);
+    }
+
+    void setMapping(void *p, size_t length)
+    {
+        base = static_cast<char *>(p);
+        mapped = length;
+        header = reinterpret_cast<Header *>(base);
+        data = reinterpret_cast<T *>(base + HEADER);
+        maxSize = (long long)((length - HEADER) / sizeof(T));
+        if (advice != NORMAL) madvise(base, mapped, advice);
+    }
+
+    void doubleSpace()
+    {
+        if (maxSize == MAX_SIZE) throw IOException("MappedArrayList:add:capacity overflow");
+        reserve(maxSize < 1024 ? 1024 : maxSize > MAX_SIZE / 2 ? MAX_SIZE : maxSize << 1);
+    }
+
+public:
+    class Iterator
+    {
+        MappedArrayList *arr;
+        long long position;
+        int status;
+
+    public:
+        Iterator(MappedArrayList *arr):arr(arr), position(-1), status(-1) {}
+
+        /**
+         * Returns true if the iteration has more elements.
+         */
+        bool hasNext() const
+        {
+            return position + 1 < arr->size();
+        }
+
+        /**
+         * Returns the next element in the iteration.
+         * @throw ElementNotExist exception when hasNext() == false
+         */
+        const T &next()
+        {
+            if (!hasNext()) throw ElementNotExist("MappedArrayList:next:ElementNotExist");
+            status = 0;
+            return arr->data[++position];
+        }
+
+        /**
+         * Removes from the underlying list the last element returned by the iterator.
+         * @throw ElementNotExist
+         */
+        void remove()
+        {
+            if ((position == -1) || (status == -1)) throw ElementNotExist("MappedArrayList:remove:ElementNotExist");
+            arr->removeIndex(position--);
+            status = -1;
+        }
+    };
+
+    /**
+     * Opens the list stored in the file at path, creating an empty one if the file does not exist.
+     * @throw IOException if the file can not be opened or mapped, or holds another element type
+     */
+    MappedArrayList(const char *path):fd(-1), base(NULL), mapped(0), advice(NORMAL)
+    {
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd == -1) throw IOException("MappedArrayList:open failed");
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw IOException("MappedArrayList:fstat failed");
+        }
+        bool fresh = st.st_size == 0;
+        size_t length = fresh ? HEADER + 1024 * sizeof(T) : st.st_size;
+        if ((fresh && (ftruncate(fd, length) != 0)) || (length < (size_t)HEADER))
+        {
+            close(fd);
+            throw IOException("MappedArrayList:bad file size");
+        }
+        void *p = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            throw IOException("MappedArrayList:mmap failed");
+        }
+        setMapping(p, length);
+        if (fresh)
+        {
+            std::memcpy(header->magic, "MAPLIST", 8);
+            header->elementSize = sizeof(T);
+            header->currentSize = 0;
+        }
+        else if ((std::memcmp(header->magic, "MAPLIST", 8) != 0) || (header->elementSize != (long long)sizeof(T))
+                 || (header->currentSize < 0) || (header->currentSize > maxSize))
+        {
+            munmap(base, mapped);
+            close(fd);
+            throw IOException("MappedArrayList:file holds another element type or is corrupt");
+        }
+    }
+
+    /**
+     * Unmaps the list and trims the file to the used length. The contents stay in the file.
+     */
+    ~MappedArrayList()
+    {
+        size_t used = HEADER + header->currentSize * sizeof(T);
+        munmap(base, mapped);
+        if (ftruncate(fd, used) != 0) {}
+        close(fd);
+    }
+
+    MappedArrayList(const MappedArrayList&) = delete;
+    MappedArrayList& operator=(const MappedArrayList&) = delete;
+
+    /**
+     * Appends the specified element to the end of this list.
+     * Always returns true.
+     */
+    bool add(const T& e)
+    {
+        if (header->currentSize == maxSize)
+        {
+            T tmp(e);
+            doubleSpace();
+            data[header->currentSize++] = tmp;
+            return true;
+        }
+        data[header->currentSize++] = e;
+        return true;
+    }
+
+    /**
+     * Returns a const reference to the element at the specified position in this list.
+     * @throw IndexOutOfBound
+     */
+    const T& get(long long index) const
+    {
+        if ((index < 0) || (index >= size())) throw IndexOutOfBound("MappedArrayList:get:IndexOutOfBound");
+        return data[index];
+    }
+
+    /**
+     * Replaces the element at the specified position in this list with the specified element.
+     * @throw IndexOutOfBound
+     */
+    void set(long long index, const T& e)
+    {
+        if ((index < 0) || (index >= size())) throw IndexOutOfBound("MappedArrayList:set:IndexOutOfBound");
+        data[index] = e;
+    }
+
+    /**
+     * Removes the element at the specified position in this list.
+     * @throw IndexOutOfBound
+     */
+    void removeIndex(long long index)
+    {
+        if ((index < 0) || (index >= size())) throw IndexOutOfBound("MappedArrayList:removeIndex:IndexOutOfBound");
+        std::memmove((void *)(data + index), data + index + 1, sizeof(T) * (size() - index - 1));
+        --header->currentSize;
+    }
+
+    /**
+     * Removes all of the elements from this list. The file keeps its length until destruction.
+     */
+    void clear()
+    {
+        header->currentSize = 0;
+    }
+
+    /**
+     * Returns true if this list contains no elements.
+     */
+    bool isEmpty() const
+    {
+        return header->currentSize == 0;
+    }
+
+    /**
+     * Returns the number of elements in this list.
+     */
+    long long size() const
+    {
+        return header->currentSize;
+    }
+
+    /**
+     * Returns the number of elements that fit in the current file length.
+     */
+    long long capacity() const
+    {
+        return maxSize;
+    }
+
+    /**
+     * Extends the file so that at least n elements fit without remapping.
+     * @throw IOException, also when n elements would not fit in a file
+     */
+    void reserve(long long n)
+    {
+        if (n <= maxSize) return;
+        if (n > MAX_SIZE) throw IOException("MappedArrayList:reserve:capacity overflow");
+        remap(HEADER + (size_t)n * sizeof(T));
+    }
+
+    /**
+     * Tells the kernel how the elements are going to be accessed.
+     * The hint is kept across growth.
+     */
+    void advise(Advice a)
+    {
+        advice = a;
+        madvise(base, mapped, a);
+    }
+
+    /**
+     * Writes the dirty pages back to the file and waits for the write to complete.
+     * @throw IOException
+     */
+    void flush()
+    {
+        if (msync(base, mapped, MS_SYNC) != 0) throw IOException("MappedArrayList:flush:msync failed");
+    }
+
+    /**
+     * Returns an iterator over the elements in this list.
+     */
+    Iterator iterator()
+    {
+        return Iterator(this);
+    }
+};
+
+#endif
@@ -0,0 +1,389 @@
+/** @file */
+#ifndef __MPMCQUEUE_H
+#define __MPMCQUEUE_H
+
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+/**
+ * A bounded queue for any number of producer and consumer threads, after Dmitry Vyukov's
+ * bounded MPMC queue.
+ *
+ * Like SpscQueue it is a power-of-two ring indexed by ever-growing tail and head counters
+ * on separate cache lines. Each slot also carries a sequence number that says whose turn
+ * it is: a slot at position p is free for the producer of p when its sequence is p, and
+ * full for the consumer of p when it is p + 1; the consumer then hands it to the next lap
+ * by setting it to p + capacity. A producer or consumer claims a position with one CAS on
+ * tail or head and touches no other shared state but its slot.
+ *
+ * tryPushBatch/tryPopBatch claim a whole run of positions with a single CAS. A slot in a
+ * claimed run may still be finishing its previous lap, in which case the batch spins on
+ * that slot briefly; the single-element functions never wait.
+ */
+template <class T>
+class MpmcQueue
+{
+    static const int LINE = 64;
+
+    class Cell
+    {
+    public:
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T *element() { return reinterpret_cast<T *>(&storage); }
+    };
+
+    Cell *cells;
+    size_t mask;
+
+    alignas(LINE) std::atomic<size_t> tail;
+    alignas(LINE) std::atomic<size_t> head;
+    char padding[LINE - sizeof(size_t)];
+
+    static void await(const Cell& cell, size_t sequence)
+    {
+        for (int spins = 0; cell.sequence.load(std::memory_order_acquire) != sequence;)
+            if (++spins > 64) std::this_thread::yield();
+    }
+
+public:
+    /**
+     * Constructs an empty queue holding up to capacity elements, rounded up to a power of two.
+     */
+    MpmcQueue(int capacity = 1024):tail(0), head(0)
+    {
+        size_t c = 2;
+        for (; c < (size_t)capacity; c <<= 1);
+        mask = c - 1;
+        cells = new Cell[c];
+        for (size_t i = 0; i < c; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /**
+     * Destructor. Must not run concurrently with any other call.
+     */
+    ~MpmcQueue()
+    {
+        for (size_t h = head.load(std::memory_order_relaxed), t = tail.load(std::memory_order_relaxed); h != t; ++h)
+            cells[h & mask].element()->~T();
+        delete [] cells;
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    /**
+     * Appends e if there is room.
+     * Returns false if the queue is full.
+     */
+    bool tryPush(const T& e)
+    {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+            cell = cells + (pos & mask);
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            ptrdiff_t dif = (ptrdiff_t)seq - (ptrdiff_t)pos;
+            if (dif == 0)
+            {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (dif < 0) return false;
+            else pos = tail.load(std::memory_order_relaxed);
+        }
+        new (cell->element()) T(e);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Moves the oldest element into out if there is one.
+     * Returns false if the queue is empty.
+     */
+    bool tryPop(T& out)
+    {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+            cell = cells + (pos & mask);
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            ptrdiff_t dif = (ptrdiff_t)seq - (ptrdiff_t)(pos + 1);
+            if (dif == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (dif < 0) return false;
+            else pos = head.load(std::memory_order_relaxed);
+        }
+        T *slot = cell->element();
+        out = std::move(*slot);
+        slot->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Appends up to n elements of items, as many as fit, in order.
+     * Returns the number of elements pushed, 0 if n <= 0.
+     */
+    int tryPushBatch(const T *items, int n)
+    {
+        if (n <= 0) return 0;
+        size_t pos = tail.load(std::memory_order_relaxed), k;
+        do
+        {
+            size_t room = mask + 1 - (pos - head.load(std::memory_order_acquire));
+            if ((ptrdiff_t)room <= 0) return 0;
+            k = room < (size_t)n ? room : (size_t)n;
+        } while (!tail.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed));
+        for (size_t i = 0; i < k; ++i)
+        {
+            Cell& cell = cells[(pos + i) & mask];
+            await(cell, pos + i);
+            new (cell.element()) T(items[i]);
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return (int)k;
+    }
+
+    /**
+     * Moves up to n of the oldest elements into out.
+     * Returns the number of elements popped, 0 if n <= 0.
+     */
+    int tryPopBatch(T *out, int n)
+    {
+        if (n <= 0) return 0;
+        size_t pos = head.load(std::memory_order_relaxed), k;
+        do
+        {
+            size_t ready = tail.load(std::memory_order_acquire) - pos;
+            if ((ptrdiff_t)ready <= 0) return 0;
+            k = ready < (size_t)n ? ready : (size_t)n;
+        } while (!head.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed));
+        for (size_t i = 0; i < k; ++i)
+        {
+            Cell& cell = cells[(pos + i) & mask];
+            await(cell, pos + i + 1);
+            T *slot = cell.element();
+            out[i] = std::move(*slot);
+            slot->~T();
+            cell.sequence.store(pos + i + mask + 1, std::memory_order_release);
+        }
+        return (int)k;
+    }
+
+    /**
+     * Returns the number of elements in the queue; approximate under concurrency.
+     */
+    int size() const
+    {
+        size_t h = head.load(std::memory_order_acquire);
+        ptrdiff_t n = (ptrdiff_t)(tail.load(std::memory_order_acquire) - h);
+        return n > 0 ? (int)n : 0;
+    }
+
+    /**
+     * Returns true if the queue looks empty.
+     */
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Returns the maximum number of elements the queue holds.
+     */
+    int capacity() const
+    {
+        return (int)(mask + 1);
+    }
+};
+
+/**
+ * An MpmcQueue whose push blocks while the queue is full (backpressure on producers)
+ * and whose pop blocks while it is empty.
+ *
+ * Both sides first spin on the lock-free queue for a short while and only then park on
+ * a condition variable. The other side takes the lock to notify only when someone is
+ * actually parked, so an uncontended push or pop costs the same as on MpmcQueue.
+ * close() wakes everyone: further pushes fail, and pops drain what is left and then fail.
+ */
+template <class T>
+class BlockingMpmcQueue
+{
+    static const int SPINS = 128;
+
+    MpmcQueue<T> queue;
+    std::atomic<bool> closed;
+    std::atomic<int> parkedProducers, parkedConsumers;
+    std::mutex lock;
+    std::condition_variable notFull, notEmpty;
+
+    void wake(std::atomic<int>& parked, std::condition_variable& cond, bool all)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) == 0) return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+        }
+        if (all) cond.notify_all();
+        else cond.notify_one();
+    }
+
+    /**
+     * Calls attempt() until it succeeds or the queue is closed: spins first, then parks on
+     * cond with parked counting the sleepers. Returns the value of the last attempt.
+     */
+    template <class F>
+    int until(F attempt, std::atomic<int>& parked, std::condition_variable& cond)
+    {
+        int r = 0;
+        for (int spins = 0; spins < SPINS; ++spins)
+        {
+            if ((r = attempt()) > 0) return r;
+            if (closed.load(std::memory_order_acquire)) return r;
+            if (spins > SPINS / 2) std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> guard(lock);
+        parked.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (((r = attempt()) == 0) && !closed.load(std::memory_order_acquire)) cond.wait(guard);
+        parked.fetch_sub(1, std::memory_order_relaxed);
+        return r;
+    }
+
+public:
+    /**
+     * Constructs an empty open queue holding up to capacity elements, rounded up to a power of two.
+     */
+    BlockingMpmcQueue(int capacity = 1024):queue(capacity), closed(false), parkedProducers(0), parkedConsumers(0) {}
+
+    BlockingMpmcQueue(const BlockingMpmcQueue&) = delete;
+    BlockingMpmcQueue& operator=(const BlockingMpmcQueue&) = delete;
+
+    /**
+     * Appends e, waiting while the queue is full.
+     * Returns false if the queue was closed.
+     */
+    bool push(const T& e)
+    {
+        if (closed.load(std::memory_order_acquire)) return false;
+        if (!until([&]() { return queue.tryPush(e) ? 1 : 0; }, parkedProducers, notFull)) return false;
+        wake(parkedConsumers, notEmpty, false);
+        return true;
+    }
+
+    /**
+     * Appends the n elements of items in order, waiting for room as needed.
+     * Returns the number pushed, which is less than n only if the queue was closed; 0 if n <= 0.
+     */
+    int pushBatch(const T *items, int n)
+    {
+        int done = 0;
+        while ((done < n) && !closed.load(std::memory_order_acquire))
+        {
+            int k = until([&]() { return queue.tryPushBatch(items + done, n - done); }, parkedProducers, notFull);
+            if (k == 0) break;
+            done += k;
+            wake(parkedConsumers, notEmpty, k > 1);
+        }
+        return done;
+    }
+
+    /**
+     * Moves the oldest element into out, waiting while the queue is empty.
+     * Returns false if the queue is closed and empty.
+     */
+    bool pop(T& out)
+    {
+        if (!until([&]() { return queue.tryPop(out) ? 1 : 0; }, parkedConsumers, notEmpty)) return false;
+        wake(parkedProducers, notFull, false);
+        return true;
+    }
+
+    /**
+     * Moves between 1 and n of the oldest elements into out, waiting while the queue is empty.
+     * Returns the number popped, 0 if the queue is closed and empty or if n <= 0.
+     */
+    int popBatch(T *out, int n)
+    {
+        if (n <= 0) return 0;
+        int k = until([&]() { return queue.tryPopBatch(out, n); }, parkedConsumers, notEmpty);
+        if (k > 0) wake(parkedProducers, notFull, k > 1);
+        return k;
+    }
+
+    /**
+     * Appends e if there is room, without waiting.
+     */
+    bool tryPush(const T& e)
+    {
+        if (closed.load(std::memory_order_acquire) || !queue.tryPush(e)) return false;
+        wake(parkedConsumers, notEmpty, false);
+        return true;
+    }
+
+    /**
+     * Moves the oldest element into out if there is one, without waiting.
+     */
+    bool tryPop(T& out)
+    {
+        if (!queue.tryPop(out)) return false;
+        wake(parkedProducers, notFull, false);
+        return true;
+    }
+
+    /**
+     * Closes the queue and wakes every waiting thread.
+     */
+    void close()
+    {
+        closed.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> guard(lock);
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    /**
+     * Returns true once close() has been called.
+     */
+    bool isClosed() const
+    {
+        return closed.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Returns the number of elements in the queue; approximate under concurrency.
+     */
+    int size() const
+    {
+        return queue.size();
+    }
+
+    /**
+     * Returns true if the queue looks empty.
+     */
+    bool isEmpty() const
+    {
+        return queue.isEmpty();
+    }
+
+    /**
+     * Returns the maximum number of elements the queue holds.
+     */
+    int capacity() const
+    {
+        return queue.capacity();
+    }
+};
+
+#endif
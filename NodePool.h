@@ -0,0 +1,241 @@
+/** @file */
+#ifndef __NODEPOOL_H
+#define __NODEPOOL_H
+
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+/**
+ * A slab allocator for objects of type T, used by the linked containers for their nodes.
+ *
+ * Memory comes from slabs that start at 16 blocks and double up to 4096 blocks each.
+ * A fresh slab is handed out by bumping a pointer, so it is not touched until used.
+ * Released blocks go onto an intrusive free list (the link lives in the freed block
+ * itself) and are reused first, most recently freed first, which keeps hot nodes in
+ * cache. Slabs are returned to the system only when the pool is destroyed.
+ *
+ * allocate() returns raw memory; the caller constructs and destroys the object. A pool
+ * is not thread-safe, and it must outlive every container that allocates from it.
+ * absorb() moves one pool's slabs into another, so that containers can move nodes
+ * allocated from either of them and release them into the surviving pool.
+ *
+ * A container too small to be worth a pool can allocate its nodes one at a time with
+ * allocateOne(), at the cost of a plain new each, and hand them to a pool with adopt()
+ * once it grows; until then it frees them with releaseOne(). The pool keeps the adopted
+ * blocks' addresses, ADOPTED to a record, to free them when it is destroyed.
+ */
+template <class T>
+class NodePool
+{
+    union Block
+    {
+        Block *next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    class Slab
+    {
+    public:
+        Slab *next;
+        Block *blocks()
+        {
+            return reinterpret_cast<Block *>(reinterpret_cast<char *>(this) + OFFSET);
+        }
+    };
+
+    /**
+     * Up to ADOPTED blocks from allocateOne(), stored right after the record.
+     */
+    class Adopted
+    {
+    public:
+        Adopted *next;
+        int count;
+        Block **blocks()
+        {
+            return reinterpret_cast<Block **>(reinterpret_cast<char *>(this) + sizeof(Adopted));
+        }
+    };
+
+    static const size_t OFFSET = (sizeof(Slab) + alignof(Block) - 1) / alignof(Block) * alignof(Block);
+    static const int FIRST = 16, LARGEST = 4096, ADOPTED = 16;
+
+    Block *freeList, *freeTail, *bump, *bumpEnd;
+    Slab *slabs;
+    Adopted *adopted;
+    int nextSlab, owned, used;
+
+    void grow()
+    {
+        Slab *slab = static_cast<Slab *>(::operator new(OFFSET + sizeof(Block) * nextSlab));
+        slab->next = slabs;
+        slabs = slab;
+        bump = slab->blocks();
+        bumpEnd = bump + nextSlab;
+        owned += nextSlab;
+        if (nextSlab < LARGEST) nextSlab <<= 1;
+    }
+
+public:
+    /**
+     * Constructs an empty pool. No slab is allocated until the first allocate().
+     */
+    NodePool():freeList(NULL), freeTail(NULL), bump(NULL), bumpEnd(NULL), slabs(NULL), adopted(NULL), nextSlab(FIRST), owned(0), used(0) {}
+
+    /**
+     * Destructor. Frees every slab and adopted block; objects still allocated must
+     * already be destroyed.
+     */
+    ~NodePool()
+    {
+        for (Slab *s = slabs; s != NULL;)
+        {
+            Slab *next = s->next;
+            ::operator delete(s);
+            s = next;
+        }
+        for (Adopted *a = adopted; a != NULL;)
+        {
+            Adopted *next = a->next;
+            for (int i = 0; i < a->count; ++i) ::operator delete(a->blocks()[i]);
+            ::operator delete(a);
+            a = next;
+        }
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    /**
+     * Returns uninitialized memory for one T, outside any pool.
+     */
+    static void *allocateOne()
+    {
+        return ::operator new(sizeof(Block));
+    }
+
+    /**
+     * Frees memory obtained from allocateOne() and not adopted, whose object has been
+     * destroyed.
+     */
+    static void releaseOne(void *p)
+    {
+        ::operator delete(p);
+    }
+
+    /**
+     * Takes over p, obtained from allocateOne() and still allocated: from now on it is
+     * released into this pool, and freed with it.
+     */
+    void adopt(void *p)
+    {
+        if ((adopted == NULL) || (adopted->count == ADOPTED))
+        {
+            Adopted *a = static_cast<Adopted *>(::operator new(sizeof(Adopted) + sizeof(Block *) * ADOPTED));
+            a->next = adopted;
+            a->count = 0;
+            adopted = a;
+        }
+        adopted->blocks()[adopted->count++] = static_cast<Block *>(p);
+        ++owned, ++used;
+    }
+
+    /**
+     * Returns uninitialized memory for one T.
+     */
+    void *allocate()
+    {
+        ++used;
+        if (freeList != NULL)
+        {
+            Block *b = freeList;
+            freeList = b->next;
+            return b;
+        }
+        if (bump == bumpEnd) grow();
+        return bump++;
+    }
+
+    /**
+     * Gives back memory obtained from allocate() whose object has been destroyed.
+     */
+    void release(void *p)
+    {
+        Block *b = static_cast<Block *>(p);
+        if (freeList == NULL) freeTail = b;
+        b->next = freeList;
+        freeList = b;
+        --used;
+    }
+
+    /**
+     * Takes over every slab of other, with its free blocks and its allocated count,
+     * leaving other empty. Blocks allocated from other may then be released here.
+     * O(number of slabs and adoption records of other), plus the unused part of the
+     * smaller fresh slab, which goes onto the free list.
+     */
+    void absorb(NodePool& other)
+    {
+        if ((&other == this) || ((other.slabs == NULL) && (other.adopted == NULL))) return;
+        if (other.slabs != NULL)
+        {
+            Slab *last = other.slabs;
+            while (last->next != NULL) last = last->next;
+            last->next = slabs;
+            slabs = other.slabs;
+        }
+        if (other.adopted != NULL)
+        {
+            Adopted *last = other.adopted;
+            while (last->next != NULL) last = last->next;
+            last->next = adopted;
+            adopted = other.adopted;
+        }
+        if (other.freeList != NULL)
+        {
+            other.freeTail->next = freeList;
+            if (freeList == NULL) freeTail = other.freeTail;
+            freeList = other.freeList;
+        }
+        // keep bumping through the larger fresh range and free the smaller one
+        if (other.bumpEnd - other.bump > bumpEnd - bump)
+        {
+            std::swap(bump, other.bump);
+            std::swap(bumpEnd, other.bumpEnd);
+        }
+        for (Block *b = other.bump; b != other.bumpEnd; ++b)
+        {
+            if (freeList == NULL) freeTail = b;
+            b->next = freeList;
+            freeList = b;
+        }
+        if (other.nextSlab > nextSlab) nextSlab = other.nextSlab;
+        owned += other.owned;
+        used += other.used;
+        other.freeList = other.freeTail = other.bump = other.bumpEnd = NULL;
+        other.slabs = NULL;
+        other.adopted = NULL;
+        other.nextSlab = FIRST;
+        other.owned = other.used = 0;
+    }
+
+    /**
+     * Returns the number of blocks currently allocated.
+     */
+    int size() const
+    {
+        return used;
+    }
+
+    /**
+     * Returns the number of blocks held in slabs, allocated or not.
+     */
+    int capacity() const
+    {
+        return owned;
+    }
+};
+
+#endif
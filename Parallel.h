@@ -0,0 +1,310 @@
+/** @file */
+#ifndef __PARALLEL_H
+#define __PARALLEL_H
+
+#include "TaskScheduler.h"
+#include <new>
+#include <cstdlib>
+#include <utility>
+#include <thread>
+
+/**
+ * Sorting and data-parallel loops over a contiguous array, used by ArrayList.
+ *
+ * The parallel functions split the array into one contiguous chunk per thread and run
+ * the chunks as tasks on a process-wide TaskScheduler, started on first use with one
+ * worker per hardware core (link with -pthread), so a call costs a few task hand-offs
+ * rather than thread creation. threads <= 0 means one chunk per hardware core; a larger
+ * count splits the work finer over the same workers. The callbacks run concurrently and
+ * must not throw.
+ */
+namespace Parallel
+{
+    /**
+     * Below this many elements per thread, work is done on the calling thread only.
+     */
+    static const int GRAIN = 1 << 15;
+
+    inline int threadCount(int n, int threads)
+    {
+        if (threads <= 0) threads = std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+        int most = n / GRAIN;
+        if (threads > most) threads = most > 1 ? most : 1;
+        return threads;
+    }
+
+    /**
+     * The shared worker pool, started by the first parallel call.
+     */
+    inline TaskScheduler &scheduler()
+    {
+        static TaskScheduler pool;
+        return pool;
+    }
+
+    /**
+     * Calls f(part, from, to) for parts 0..parts-1 covering [0, n) in order, one task each.
+     * The calling thread runs the last part, then helps with the others until all are done.
+     */
+    template <class F>
+    void forParts(int n, int parts, F f)
+    {
+        if (parts <= 1)
+        {
+            f(0, 0, n);
+            return;
+        }
+        TaskScheduler &pool = scheduler();
+        TaskScheduler::Counter done;
+        for (int p = 0; p < parts - 1; ++p)
+        {
+            int from = (int)((long long)n * p / parts), to = (int)((long long)n * (p + 1) / parts);
+            pool.spawn(done, [&f, p, from, to]() { f(p, from, to); });
+        }
+        f(parts - 1, (int)((long long)n * (parts - 1) / parts), n);
+        pool.wait(done);
+    }
+
+    template <class T, class C>
+    void insertionSort(T *a, int n, C &cmp)
+    {
+        for (int i = 1; i < n; ++i)
+        {
+            T tmp(std::move(a[i]));
+            int j = i;
+            for (; (j > 0) && cmp(tmp, a[j - 1]); --j) a[j] = std::move(a[j - 1]);
+            a[j] = std::move(tmp);
+        }
+    }
+
+    template <class T, class C>
+    void siftDown(T *a, int v, int n, C &cmp)
+    {
+        T tmp(std::move(a[v]));
+        for (; (v << 1) + 1 < n;)
+        {
+            int t = (v << 1) + 1;
+            if ((t + 1 < n) && cmp(a[t], a[t + 1])) ++t;
+            if (!cmp(tmp, a[t])) break;
+            a[v] = std::move(a[t]);
+            v = t;
+        }
+        a[v] = std::move(tmp);
+    }
+
+    template <class T, class C>
+    void heapSort(T *a, int n, C &cmp)
+    {
+        for (int i = n / 2 - 1; i >= 0; --i) siftDown(a, i, n, cmp);
+        for (int i = n - 1; i > 0; --i)
+        {
+            std::swap(a[0], a[i]);
+            siftDown(a, 0, i, cmp);
+        }
+    }
+
+    template <class T, class C>
+    void introSort(T *a, int n, int depth, C &cmp)
+    {
+        for (; n > 16;)
+        {
+            if (depth-- == 0)
+            {
+                heapSort(a, n, cmp);
+                return;
+            }
+            // median of three moved to a[0] as the pivot
+            int mid = n / 2;
+            if (cmp(a[mid], a[0])) std::swap(a[mid], a[0]);
+            if (cmp(a[n - 1], a[mid])) std::swap(a[n - 1], a[mid]);
+            if (cmp(a[mid], a[0])) std::swap(a[mid], a[0]);
+            std::swap(a[0], a[mid]);
+            int i = 0, j = n;
+            for (;;)
+            {
+                do ++i; while ((i < n) && cmp(a[i], a[0]));
+                do --j; while (cmp(a[0], a[j]));
+                if (i >= j) break;
+                std::swap(a[i], a[j]);
+            }
+            std::swap(a[0], a[j]);
+            // recurse into the smaller side, loop on the larger one
+            if (j < n - j - 1)
+            {
+                introSort(a, j, depth, cmp);
+                a += j + 1, n -= j + 1;
+            }
+            else
+            {
+                introSort(a + j + 1, n - j - 1, depth, cmp);
+                n = j;
+            }
+        }
+        insertionSort(a, n, cmp);
+    }
+
+    /**
+     * Sequential introsort: quicksort with median-of-three pivots, falling back to heapsort
+     * past 2 log n levels and to insertion sort below 16 elements. Not stable.
+     */
+    template <class T, class C>
+    void introSort(T *a, int n, C cmp)
+    {
+        int depth = 0;
+        for (int i = n; i > 1; i >>= 1) depth += 2;
+        introSort(a, n, depth, cmp);
+    }
+
+    /**
+     * Returns how many of the first k merged elements of a[0, m) and b[0, n) come from a.
+     * Ties are taken from a first.
+     */
+    template <class T, class C>
+    int coRank(int k, const T *a, int m, const T *b, int n, C &cmp)
+    {
+        int lo = k > n ? k - n : 0, hi = k < m ? k : m;
+        while (lo < hi)
+        {
+            int i = (lo + hi) / 2, j = k - i;
+            if ((j > 0) && (i < m) && !cmp(b[j - 1], a[i])) lo = i + 1;
+            else hi = i;
+        }
+        return lo;
+    }
+
+    /**
+     * Merges a[i, m) and b[j, n) into out by move assignment. Ties are taken from a first.
+     */
+    template <class T, class C>
+    void mergeRange(T *a, int i, int m, T *b, int j, int n, T *out, C &cmp)
+    {
+        for (; (i < m) && (j < n); ++out)
+            if (cmp(b[j], a[i])) *out = std::move(b[j++]);
+            else *out = std::move(a[i++]);
+        for (; i < m; ++out) *out = std::move(a[i++]);
+        for (; j < n; ++out) *out = std::move(b[j++]);
+    }
+
+    /**
+     * Sorts a[0, n). Small arrays use introSort on the calling thread. Large ones are split
+     * into one run per thread, the runs are sorted concurrently and then merged pairwise,
+     * with every merge round split evenly across all threads.
+     */
+    template <class T, class C>
+    void sort(T *a, int n, C cmp, int threads = 0)
+    {
+        int parts = threadCount(n, threads);
+        if (parts <= 1)
+        {
+            introSort(a, n, cmp);
+            return;
+        }
+        int *bound = new int[parts + 1];
+        for (int p = 0; p <= parts; ++p) bound[p] = (int)((long long)n * p / parts);
+        T *buf = static_cast<T *>(std::malloc(sizeof(T) * n));
+        if (buf == NULL)
+        {
+            delete [] bound;
+            throw std::bad_alloc();
+        }
+        forParts(n, parts, [&](int, int from, int to)
+        {
+            introSort(a + from, to - from, cmp);
+            for (int i = from; i < to; ++i) new (buf + i) T(std::move(a[i]));
+        });
+        T *src = buf, *dst = a;
+        int *split = new int[parts];
+        for (int runs = parts; runs > 1; runs = (runs + 1) / 2)
+        {
+            // pair r merges runs r and r + 1; the last pair of an odd round has an empty second run
+            auto pairOf = [&](int pos, int &lo, int &mid, int &hi)
+            {
+                int r = 0;
+                while (bound[r + 2 <= runs ? r + 2 : runs] <= pos) r += 2;
+                lo = bound[r], mid = bound[r + 1 < runs ? r + 1 : runs], hi = bound[r + 2 <= runs ? r + 2 : runs];
+            };
+            // every split point is found before any element is moved out of src
+            forParts(n, parts, [&](int p, int from, int)
+            {
+                int lo, mid, hi;
+                pairOf(from, lo, mid, hi);
+                split[p] = coRank(from - lo, src + lo, mid - lo, src + mid, hi - mid, cmp);
+            });
+            forParts(n, parts, [&](int p, int from, int to)
+            {
+                for (int f = from; f < to;)
+                {
+                    int lo, mid, hi;
+                    pairOf(f, lo, mid, hi);
+                    int t = to < hi ? to : hi;
+                    int iFrom = f == from ? split[p] : 0, iTo = t == hi ? mid - lo : split[p + 1];
+                    mergeRange(src + lo, iFrom, iTo, src + mid, f - lo - iFrom, t - lo - iTo, dst + f, cmp);
+                    f = t;
+                }
+            });
+            for (int r = 0; r <= (runs + 1) / 2; ++r) bound[r] = bound[2 * r < runs ? 2 * r : runs];
+            std::swap(src, dst);
+        }
+        delete [] split;
+        forParts(n, parts, [&](int, int from, int to)
+        {
+            if (src != a) for (int i = from; i < to; ++i) a[i] = std::move(buf[i]);
+            for (int i = from; i < to; ++i) buf[i].~T();
+        });
+        std::free(buf);
+        delete [] bound;
+    }
+
+    /**
+     * Calls f(a[i]) for every i in [0, n).
+     */
+    template <class T, class F>
+    void forEach(T *a, int n, F f, int threads = 0)
+    {
+        forParts(n, threadCount(n, threads), [&](int, int from, int to)
+        {
+            for (int i = from; i < to; ++i) f(a[i]);
+        });
+    }
+
+    /**
+     * Replaces every a[i] with f(a[i]).
+     */
+    template <class T, class F>
+    void transform(T *a, int n, F f, int threads = 0)
+    {
+        forParts(n, threadCount(n, threads), [&](int, int from, int to)
+        {
+            for (int i = from; i < to; ++i) a[i] = f(a[i]);
+        });
+    }
+
+    /**
+     * Folds a[0, n) with op, starting every thread from identity and combining the
+     * per-thread results in order. op must be associative and identity its neutral element.
+     */
+    template <class T, class Op>
+    T reduce(const T *a, int n, const T &identity, Op op, int threads = 0)
+    {
+        int parts = threadCount(n, threads);
+        T *partial = static_cast<T *>(std::malloc(sizeof(T) * parts));
+        if (partial == NULL) throw std::bad_alloc();
+        forParts(n, parts, [&](int p, int from, int to)
+        {
+            T acc(identity);
+            for (int i = from; i < to; ++i) acc = op(acc, a[i]);
+            new (partial + p) T(std::move(acc));
+        });
+        T result(identity);
+        for (int p = 0; p < parts; ++p)
+        {
+            result = op(result, partial[p]);
+            partial[p].~T();
+        }
+        std::free(partial);
+        return result;
+    }
+}
+
+#endif
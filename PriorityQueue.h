@@ -4,6 +4,7 @@
 
 #include "ArrayList.h"
 #include "ElementNotExist.h"
+#include "Less.h"
 #include <iostream>
 using namespace std;
 
@@ -20,17 +21,6 @@ using namespace std;
  */
 
 /*----------------------------------------------------------------------*/
-/**
- * Default Comparator with respect to natural order (operator<).
- */
- 
-template <class V>
-class Less
-{
-public:
-    bool operator()(const V& a, const V& b) { return a < b; }
-};
-
 /**
  * To use this priority queue, users need to either use the
  * default Comparator or provide their own Comparator of this
@@ -111,50 +101,31 @@ private:
 
     void doubleSpace()
     {
-        T *tmp = new T[currentSize + 1];
-		int i = 1;
-        for (Node *temp = head; temp != NULL; temp = temp -> next, ++i) tmp[i] = temp -> data;
-        for (int i = 1; i <= currentSize; ++i) if (heap[i] != NULL) delete heap[i];
-		delete [] heap;
+        Node **tmp = new Node*[maxSize << 1];
+        for (int i = 1; i <= currentSize; ++i) tmp[i] = heap[i];
+        delete [] heap;
+        heap = tmp;
         maxSize <<= 1;
-        heap = new Node*[maxSize];
-        head = tail = NULL;
-        for (int i = 1; i <= currentSize; ++i)
-        {
-			heap[i] = new Node(tail, tmp[i], NULL, i);
-			if (tail != NULL) tail -> next = heap[i];
-			tail = heap[i];
-        }
-        if (currentSize) head = heap[1];
-        delete [] tmp;
-        for (int i = currentSize / 2; i; --i) down(i);
     }
 
 public:
+    /**
+     * Follows the insertion-order links with two node pointers, like LinkedList::Iterator;
+     * it allocates nothing and never writes to the queue except through remove().
+     */
     class Iterator
     {
         PriorityQueue *pri;
-        Node *now, *tmp;
-        T *T_T;
-        int status;
+        Node *last, *upcoming;
     public:
-		~Iterator()
-		{
-			delete tmp; tmp = NULL;
-			delete T_T;
-		}
-        Iterator(PriorityQueue<T, C> *pri):pri(pri), status(-1)
-        {
-            now = new Node(NULL, *(T_T = new T), pri -> head, -1);
-            tmp = now;
-            if (pri -> head != NULL) pri -> head -> pre = now;
-        }
+        Iterator(PriorityQueue<T, C> *pri):pri(pri), last(NULL), upcoming(pri -> head) {}
+
         /**
          * TODO Returns true if the iteration has more elements.
          */
-        bool hasNext()
+        bool hasNext() const
         {
-            return now -> next != NULL;
+            return upcoming != NULL;
         }
 
         /**
@@ -165,9 +136,9 @@ public:
         {
             if (hasNext())
             {
-            	status = 0;
-                now = now -> next;
-                return now -> data;
+                last = upcoming;
+                upcoming = upcoming -> next;
+                return last -> data;
             }
             else throw ElementNotExist("PriorityQueue:next:ElementNotexist");
         }
@@ -182,7 +153,8 @@ public:
 		 */
 		void remove() 
 		{
-			if ((now == NULL) || (now -> next == pri -> head) || (status == -1)) throw ElementNotExist("PriorityQueue:remove:ElementNotExist");
+			if (last == NULL) throw ElementNotExist("PriorityQueue:remove:ElementNotExist");
+			Node *now = last;
 			int pos = now -> position;
 			if (pos != pri -> currentSize)
 			{
@@ -190,20 +162,13 @@ public:
 				pri -> heap[pos] -> position = pos;
 				pri -> up(pos), pri -> down(pos);
 			}
-			else --pri -> currentSize;
+			else pri -> heap[pri -> currentSize--] = NULL;
 			if (now -> pre != NULL) now -> pre -> next = now -> next;
 			if (now -> next != NULL) now -> next -> pre = now -> pre;
-			if ((now == pri -> head) && (pri -> head == pri -> tail))
-				pri -> head = pri -> tail = NULL;
-			else 
-			{
-				if (now == pri -> head) pri -> head = pri -> head -> next;
-				if (now == pri -> tail) pri -> tail = pri -> tail -> pre;
-			}
-			Node *tmp = now;
-			now = now -> pre;
-			delete tmp; tmp = NULL;
-			status = -1;
+			if (now == pri -> head) pri -> head = now -> next;
+			if (now == pri -> tail) pri -> tail = now -> pre;
+			delete now;
+			last = NULL;
 		}
     };
 
@@ -347,7 +312,8 @@ public:
     void push(const T &value)
     {
         if (currentSize >= maxSize - 1) doubleSpace();
-		heap[++currentSize] = new Node(tail, value, NULL, currentSize);
+		++currentSize;
+		heap[currentSize] = new Node(tail, value, NULL, currentSize);
 		if (tail != NULL) tail -> next = heap[currentSize];
 		tail = heap[currentSize];
         if (head == NULL) head = tail;
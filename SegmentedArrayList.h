@@ -0,0 +1,296 @@
+/** @file */
+#ifndef __SEGMENTEDARRAYLIST_H
+#define __SEGMENTEDARRAYLIST_H
+
+#include "IndexOutOfBound.h"
+#include "ElementNotExist.h"
+#include <new>
+#include <cstdlib>
+#include <utility>
+#include <type_traits>
+
+/**
+ * An ArrayList made of fixed-size chunks of 2^B elements, reached through a directory
+ * of chunk pointers, so that get(index) is chunks[index >> B][index & (2^B - 1)].
+ *
+ * Growing allocates one more chunk and at most doubles the directory, which holds only
+ * pointers: appending never moves an element, and references to elements stay valid
+ * until the element itself is removed or shifted by add(index, e) / removeIndex.
+ */
+template <class T, int B = 10>
+class SegmentedArrayList
+{
+    static const int CHUNK = 1 << B;
+    static const int MASK = CHUNK - 1;
+
+    T **chunks;
+    int chunkCount, dirSize, currentSize;
+
+    T &at(int index) const
+    {
+        return chunks[index >> B][index & MASK];
+    }
+
+    void addChunk()
+    {
+        if (chunkCount == dirSize)
+        {
+            int newSize = dirSize == 0 ? 8 : dirSize << 1;
+            T **tmp = new T*[newSize];
+            for (int i = 0; i < chunkCount; ++i) tmp[i] = chunks[i];
+            delete [] chunks;
+            chunks = tmp, dirSize = newSize;
+        }
+        T *chunk = static_cast<T *>(std::malloc(sizeof(T) * CHUNK));
+        if (chunk == NULL) throw std::bad_alloc();
+        chunks[chunkCount++] = chunk;
+    }
+
+    void release()
+    {
+        clear();
+        for (int i = 0; i < chunkCount; ++i) std::free(chunks[i]);
+        delete [] chunks;
+        chunks = NULL;
+        chunkCount = dirSize = 0;
+    }
+
+public:
+    class Iterator
+    {
+        SegmentedArrayList *arr;
+        T *chunk;
+        int position, status;
+
+    public:
+        Iterator(SegmentedArrayList *arr):arr(arr), chunk(NULL), position(-1), status(-1) {}
+
+        /**
+         * Returns true if the iteration has more elements.
+         */
+        bool hasNext() const
+        {
+            return position + 1 < arr->currentSize;
+        }
+
+        /**
+         * Returns the next element in the iteration. The chunk pointer is looked up
+         * once per chunk.
+         * @throw ElementNotExist exception when hasNext() == false
+         */
+        const T &next()
+        {
+            if (!hasNext()) throw ElementNotExist("SegmentedArrayList:next:ElementNotExist");
+            status = 0;
+            ++position;
+            if (((position & MASK) == 0) || (chunk == NULL)) chunk = arr->chunks[position >> B];
+            return chunk[position & MASK];
+        }
+
+        /**
+         * Removes from the underlying list the last element returned by the iterator.
+         * @throw ElementNotExist
+         */
+        void remove()
+        {
+            if ((position == -1) || (status == -1)) throw ElementNotExist("SegmentedArrayList:remove:ElementNotExist");
+            arr->removeIndex(position--);
+            chunk = NULL;
+            status = -1;
+        }
+    };
+
+    /**
+     * Constructs an empty list. No chunk is allocated until the first add.
+     */
+    SegmentedArrayList():chunks(NULL), chunkCount(0), dirSize(0), currentSize(0) {}
+
+    /**
+     * Destructor
+     */
+    ~SegmentedArrayList()
+    {
+        release();
+    }
+
+    /**
+     * Copy-constructor
+     */
+    SegmentedArrayList(const SegmentedArrayList& x):chunks(NULL), chunkCount(0), dirSize(0), currentSize(0)
+    {
+        for (int i = 0; i < x.currentSize; ++i) add(x.at(i));
+    }
+
+    /**
+     * Assignment operator
+     */
+    SegmentedArrayList& operator=(const SegmentedArrayList& x)
+    {
+        if (&x == this) return *this;
+        clear();
+        for (int i = 0; i < x.currentSize; ++i) add(x.at(i));
+        return *this;
+    }
+
+    /**
+     * Appends the specified element to the end of this list.
+     * Always returns true.
+     */
+    bool add(const T& e)
+    {
+        emplace(e);
+        return true;
+    }
+
+    /**
+     * Appends the specified element to the end of this list, moving from it.
+     */
+    bool add(T&& e)
+    {
+        emplace(std::move(e));
+        return true;
+    }
+
+    /**
+     * Constructs a new element from args in place at the end of this list.
+     * No existing element is moved.
+     */
+    template <class... Args>
+    void emplace(Args&&... args)
+    {
+        if (currentSize == chunkCount * CHUNK) addChunk();
+        new (&at(currentSize)) T(std::forward<Args>(args)...);
+        ++currentSize;
+    }
+
+    /**
+     * Inserts the specified element to the specified position in this list,
+     * shifting the following elements by one.
+     * @throw IndexOutOfBound
+     */
+    void add(int index, const T& element)
+    {
+        if ((index < 0) || (index > currentSize)) throw IndexOutOfBound("SegmentedArrayList:add:IndexOutOfBound");
+        T tmp(element);
+        if (index == currentSize)
+        {
+            emplace(std::move(tmp));
+            return;
+        }
+        emplace(std::move(at(currentSize - 1)));
+        for (int i = currentSize - 2; i > index; --i) at(i) = std::move(at(i - 1));
+        at(index) = std::move(tmp);
+    }
+
+    /**
+     * Removes all of the elements from this list. The chunks are kept for reuse.
+     */
+    void clear()
+    {
+        if (!std::is_trivially_destructible<T>::value)
+            for (int i = 0; i < currentSize; ++i) at(i).~T();
+        currentSize = 0;
+    }
+
+    /**
+     * Returns true if this list contains the specified element.
+     */
+    bool contains(const T& e) const
+    {
+        for (int c = 0; c * CHUNK < currentSize; ++c)
+        {
+            const T *chunk = chunks[c];
+            int n = currentSize - c * CHUNK < CHUNK ? currentSize - c * CHUNK : CHUNK;
+            for (int i = 0; i < n; ++i) if (chunk[i] == e) return true;
+        }
+        return false;
+    }
+
+    /**
+     * Returns a const reference to the element at the specified position in this list.
+     * @throw IndexOutOfBound
+     */
+    const T& get(int index) const
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("SegmentedArrayList:get:IndexOutOfBound");
+        return at(index);
+    }
+
+    /**
+     * Replaces the element at the specified position in this list with the specified element.
+     * @throw IndexOutOfBound
+     */
+    void set(int index, const T& element)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("SegmentedArrayList:set:IndexOutOfBound");
+        at(index) = element;
+    }
+
+    /**
+     * Returns true if this list contains no elements.
+     */
+    bool isEmpty() const
+    {
+        return currentSize == 0;
+    }
+
+    /**
+     * Removes the element at the specified position in this list,
+     * shifting the following elements by one.
+     * @throw IndexOutOfBound
+     */
+    void removeIndex(int index)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("SegmentedArrayList:removeIndex:IndexOutOfBound");
+        for (int i = index; i < currentSize - 1; ++i) at(i) = std::move(at(i + 1));
+        removeLast();
+    }
+
+    /**
+     * Removes the last element of this list.
+     * @throw ElementNotExist
+     */
+    void removeLast()
+    {
+        if (currentSize == 0) throw ElementNotExist("SegmentedArrayList:removeLast:ElementNotExist");
+        at(--currentSize).~T();
+    }
+
+    /**
+     * Frees the chunks past the last one in use.
+     */
+    void shrinkToFit()
+    {
+        int used = (currentSize + MASK) >> B;
+        for (; chunkCount > used; --chunkCount) std::free(chunks[chunkCount - 1]);
+    }
+
+    /**
+     * Calls f(chunk, n) on every chunk in order, where chunk points to its first element
+     * and n is the number of elements in it.
+     */
+    template <class F>
+    void forEachChunk(F f)
+    {
+        for (int c = 0; c * CHUNK < currentSize; ++c)
+            f(chunks[c], currentSize - c * CHUNK < CHUNK ? currentSize - c * CHUNK : CHUNK);
+    }
+
+    /**
+     * Returns the number of elements in this list.
+     */
+    int size() const
+    {
+        return currentSize;
+    }
+
+    /**
+     * Returns an iterator over the elements in this list.
+     */
+    Iterator iterator()
+    {
+        return Iterator(this);
+    }
+};
+
+#endif
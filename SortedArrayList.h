@@ -0,0 +1,175 @@
+/** @file */
+#ifndef __SORTEDARRAYLIST_H
+#define __SORTEDARRAYLIST_H
+
+#include "ArrayList.h"
+#include "Less.h"
+#include <cmath>
+
+/**
+ * An ArrayList kept sorted by the Comparator C (operator< by default), so that lookups
+ * are binary searches.
+ *
+ * New elements do not go straight into the main array. They are inserted into a small
+ * sorted side buffer of about sqrt(n) elements, and the buffer is merged into the main
+ * array in one pass once it is full, or before any positional access or iteration.
+ * contains() searches both without merging.
+ */
+template <class T, class C = Less<T> >
+class SortedArrayList
+{
+    ArrayList<T> data, pending;
+    C cmp;
+
+    int pendingLimit() const
+    {
+        int limit = (int)std::sqrt((double)data.size());
+        return limit < 32 ? 32 : limit;
+    }
+
+public:
+    typedef typename ArrayList<T>::Iterator Iterator;
+
+    SortedArrayList(C cmp = C()):cmp(cmp) {}
+
+    /**
+     * Merges the side buffer into the main array.
+     */
+    void flush()
+    {
+        if (!pending.isEmpty()) data.mergeSorted(pending, cmp);
+    }
+
+    /**
+     * Inserts the specified element at its sorted position.
+     * Always returns true.
+     */
+    bool add(const T& e)
+    {
+        pending.add(pending.upperBound(e, cmp), e);
+        if (pending.size() >= pendingLimit()) flush();
+        return true;
+    }
+
+    /**
+     * Inserts the elements of [first, last), sorting them once and merging them into the
+     * main array in a single pass.
+     */
+    template <class It>
+    void addAll(It first, It last)
+    {
+        pending.addAll(pending.size(), first, last);
+        pending.sort(cmp);
+        flush();
+    }
+
+    /**
+     * Removes all of the elements from this list.
+     */
+    void clear()
+    {
+        data.clear();
+        pending.clear();
+    }
+
+    /**
+     * Returns true if this list contains an element equivalent to e, in O(log n).
+     */
+    bool contains(const T& e) const
+    {
+        return (data.binarySearch(e, cmp) != -1) || (pending.binarySearch(e, cmp) != -1);
+    }
+
+    /**
+     * Returns the index of an element equivalent to e, or -1 if there is none.
+     */
+    int binarySearch(const T& e)
+    {
+        flush();
+        return data.binarySearch(e, cmp);
+    }
+
+    /**
+     * Returns the index of the first element that is not less than e, or size() if there is none.
+     */
+    int lowerBound(const T& e)
+    {
+        flush();
+        return data.lowerBound(e, cmp);
+    }
+
+    /**
+     * Returns the index of the first element that is greater than e, or size() if there is none.
+     */
+    int upperBound(const T& e)
+    {
+        flush();
+        return data.upperBound(e, cmp);
+    }
+
+    /**
+     * Returns a const reference to the element at the specified position in sorted order.
+     * @throw IndexOutOfBound
+     */
+    const T& get(int index)
+    {
+        flush();
+        return data.get(index);
+    }
+
+    /**
+     * Returns true if this list contains no elements.
+     */
+    bool isEmpty() const
+    {
+        return data.isEmpty() && pending.isEmpty();
+    }
+
+    /**
+     * Removes the element at the specified position in sorted order.
+     * @throw IndexOutOfBound
+     */
+    void removeIndex(int index)
+    {
+        flush();
+        data.removeIndex(index);
+    }
+
+    /**
+     * Removes one element equivalent to e, if it is present.
+     * Returns true if it was present in the list, otherwise false.
+     */
+    bool remove(const T& e)
+    {
+        int i = pending.binarySearch(e, cmp);
+        if (i != -1)
+        {
+            pending.removeIndex(i);
+            return true;
+        }
+        i = data.binarySearch(e, cmp);
+        if (i == -1) return false;
+        data.removeIndex(i);
+        return true;
+    }
+
+    /**
+     * Returns the number of elements in this list.
+     */
+    int size() const
+    {
+        return data.size() + pending.size();
+    }
+
+    /**
+     * Returns an iterator over the elements in sorted order.
+     * Removing through the iterator keeps the list sorted.
+     */
+    Iterator iterator()
+    {
+        flush();
+        return data.iterator();
+    }
+};
+
+#endif
@@ -0,0 +1,174 @@
+/** @file */
+#ifndef __SPSCQUEUE_H
+#define __SPSCQUEUE_H
+
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <utility>
+#include <atomic>
+
+/**
+ * A bounded lock-free queue between exactly one producer thread and one consumer thread.
+ *
+ * Like Deque it is a ring buffer with power-of-two capacity and mask indexing. The
+ * producer only writes tail and the consumer only writes head, each published with a
+ * release store and read by the other side with an acquire load. The two indices sit on
+ * separate cache lines, and each side keeps a private copy of the other side's index,
+ * refreshing it only when the queue looks full (producer) or empty (consumer), so the
+ * common case touches no shared cache line but the slot itself.
+ *
+ * tryPush/tryPop never block; the batch variants move as many elements as fit with a
+ * single index publication. Only the producer may call the push functions and only the
+ * consumer the pop functions.
+ */
+template <class T>
+class SpscQueue
+{
+    static const int LINE = 64;
+
+    T *data;
+    size_t mask;
+
+    alignas(LINE) std::atomic<size_t> tail;
+    size_t headCache;
+
+    alignas(LINE) std::atomic<size_t> head;
+    size_t tailCache;
+
+    char padding[LINE - sizeof(size_t) * 2];
+
+public:
+    /**
+     * Constructs an empty queue holding up to capacity elements, rounded up to a power of two.
+     */
+    SpscQueue(int capacity = 1024):tail(0), headCache(0), head(0), tailCache(0)
+    {
+        size_t c = 1;
+        for (; c < (size_t)capacity; c <<= 1);
+        mask = c - 1;
+        data = static_cast<T *>(std::malloc(sizeof(T) * c));
+        if (data == NULL) throw std::bad_alloc();
+    }
+
+    /**
+     * Destructor. Must not run concurrently with either side.
+     */
+    ~SpscQueue()
+    {
+        for (size_t h = head.load(std::memory_order_relaxed), t = tail.load(std::memory_order_relaxed); h != t; ++h)
+            data[h & mask].~T();
+        std::free(data);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * Appends e if there is room. Producer only.
+     * Returns false if the queue is full.
+     */
+    bool tryPush(const T& e)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - headCache > mask)
+        {
+            headCache = head.load(std::memory_order_acquire);
+            if (t - headCache > mask) return false;
+        }
+        new (data + (t & mask)) T(e);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Appends up to n elements of items, as many as fit. Producer only.
+     * Returns the number of elements pushed, 0 if n <= 0.
+     */
+    int tryPushBatch(const T *items, int n)
+    {
+        if (n <= 0) return 0;
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t room = mask + 1 - (t - headCache);
+        if (room < (size_t)n)
+        {
+            headCache = head.load(std::memory_order_acquire);
+            room = mask + 1 - (t - headCache);
+        }
+        int k = room < (size_t)n ? (int)room : n;
+        for (int i = 0; i < k; ++i) new (data + ((t + i) & mask)) T(items[i]);
+        if (k > 0) tail.store(t + k, std::memory_order_release);
+        return k;
+    }
+
+    /**
+     * Moves the oldest element into out if there is one. Consumer only.
+     * Returns false if the queue is empty.
+     */
+    bool tryPop(T& out)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tailCache)
+        {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h == tailCache) return false;
+        }
+        T *slot = data + (h & mask);
+        out = std::move(*slot);
+        slot->~T();
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Moves up to n of the oldest elements into out. Consumer only.
+     * Returns the number of elements popped, 0 if n <= 0.
+     */
+    int tryPopBatch(T *out, int n)
+    {
+        if (n <= 0) return 0;
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t ready = tailCache - h;
+        if (ready < (size_t)n)
+        {
+            tailCache = tail.load(std::memory_order_acquire);
+            ready = tailCache - h;
+        }
+        int k = ready < (size_t)n ? (int)ready : n;
+        for (int i = 0; i < k; ++i)
+        {
+            T *slot = data + ((h + i) & mask);
+            out[i] = std::move(*slot);
+            slot->~T();
+        }
+        if (k > 0) head.store(h + k, std::memory_order_release);
+        return k;
+    }
+
+    /**
+     * Returns the number of elements in the queue. Exact only when neither side is running.
+     */
+    int size() const
+    {
+        size_t h = head.load(std::memory_order_acquire);
+        return (int)(tail.load(std::memory_order_acquire) - h);
+    }
+
+    /**
+     * Returns true if the queue looks empty.
+     */
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Returns the maximum number of elements the queue holds.
+     */
+    int capacity() const
+    {
+        return (int)(mask + 1);
+    }
+};
+
+#endif
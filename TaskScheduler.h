@@ -0,0 +1,317 @@
+/** @file */
+#ifndef __TASKSCHEDULER_H
+#define __TASKSCHEDULER_H
+
+#include "WorkStealingDeque.h"
+#include "Deque.h"
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+/**
+ * A fixed-size pool of worker threads that run fork-join tasks.
+ *
+ * Every worker owns a WorkStealingDeque. A task spawned from inside a worker goes to
+ * the back of that worker's deque and is normally run by the same worker next (LIFO,
+ * cache-warm); idle workers steal the oldest tasks from the front of the others' deques.
+ * Tasks spawned from outside the pool go to a shared, mutex-protected injection queue.
+ * A worker that finds nothing to run spins briefly, then parks until a spawn wakes it.
+ *
+ * Tasks are grouped by a Counter. wait(counter) returns once every task spawned on it
+ * has finished, and the waiting thread runs pending tasks meanwhile instead of blocking,
+ * so a task may spawn children and wait for them without tying up its worker.
+ * @code
+ *      TaskScheduler pool;
+ *      TaskScheduler::Counter done;
+ *      long long left = 0, right = 0;
+ *      pool.spawn(done, [&]() { left = sum(a, mid); });
+ *      pool.spawn(done, [&]() { right = sum(a + mid, n - mid); });
+ *      pool.wait(done);
+ * @endcode
+ */
+class TaskScheduler
+{
+public:
+    /**
+     * Counts the unfinished tasks of one fork-join group.
+     */
+    class Counter
+    {
+        friend class TaskScheduler;
+        std::atomic<int> pending;
+
+    public:
+        Counter():pending(0) {}
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        /**
+         * Returns true once every task spawned on this counter has finished.
+         */
+        bool isDone() const
+        {
+            return pending.load(std::memory_order_acquire) == 0;
+        }
+    };
+
+private:
+    class Task
+    {
+    public:
+        Counter *counter;
+        virtual ~Task() {}
+        virtual void run() = 0;
+    };
+
+    template <class F>
+    class FunctionTask : public Task
+    {
+        F f;
+
+    public:
+        FunctionTask(F&& f):f(std::move(f)) {}
+        void run() { f(); }
+    };
+
+    class Worker
+    {
+    public:
+        WorkStealingDeque<Task *> deque;
+        std::thread thread;
+    };
+
+    /**
+     * The scheduler and worker index of the calling thread, or NULL / -1 outside any pool.
+     */
+    class Current
+    {
+    public:
+        TaskScheduler *pool;
+        int index;
+    };
+
+    static Current &current()
+    {
+        static thread_local Current c = { NULL, -1 };
+        return c;
+    }
+
+    static const int SPINS = 64;
+
+    Worker *workers;
+    int workerCount;
+    Counter all;
+    std::atomic<bool> stopping;
+    std::atomic<int> sleeping;
+
+    Deque<Task *> injected;
+    std::mutex injectedLock;
+    std::condition_variable wakeUp;
+
+    int self() const
+    {
+        return current().pool == this ? current().index : -1;
+    }
+
+    /**
+     * Returns true if the injection queue or any worker's deque holds a task.
+     * Called with injectedLock held.
+     */
+    bool hasWork() const
+    {
+        if (!injected.isEmpty()) return true;
+        for (int i = 0; i < workerCount; ++i) if (!workers[i].deque.isEmpty()) return true;
+        return false;
+    }
+
+    void push(Task *task)
+    {
+        int me = self();
+        if (me >= 0) workers[me].deque.addLast(task);
+        else
+        {
+            std::lock_guard<std::mutex> guard(injectedLock);
+            injected.addLast(task);
+        }
+        // pairs with the fence in park(): either the parking worker sees the task, or
+        // this sees it in sleeping and notifies under the lock it holds until it waits
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> guard(injectedLock);
+            wakeUp.notify_one();
+        }
+    }
+
+    /**
+     * Blocks the calling worker until a spawn or the destructor notifies it, unless a
+     * task is already waiting somewhere.
+     */
+    void park()
+    {
+        std::unique_lock<std::mutex> guard(injectedLock);
+        sleeping.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!hasWork() && !stopping.load(std::memory_order_acquire)) wakeUp.wait(guard);
+        sleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Looks for a task: own deque first, then the injection queue, then the other
+     * workers' deques starting from a rotating victim.
+     */
+    Task *find(int me)
+    {
+        Task *task;
+        if ((me >= 0) && workers[me].deque.removeLast(task)) return task;
+        {
+            std::lock_guard<std::mutex> guard(injectedLock);
+            if (!injected.isEmpty())
+            {
+                task = injected.getFirst();
+                injected.removeFirst();
+                return task;
+            }
+        }
+        static thread_local unsigned victim = 0;
+        for (int i = 0; i < workerCount; ++i)
+        {
+            int v = (int)(victim++ % workerCount);
+            if ((v != me) && workers[v].deque.steal(task)) return task;
+        }
+        return NULL;
+    }
+
+    void execute(Task *task)
+    {
+        Counter *counter = task->counter;
+        task->run();
+        delete task;
+        counter->pending.fetch_sub(1, std::memory_order_release);
+        all.pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    /**
+     * Runs pending tasks until counter is done, yielding when there is nothing to run.
+     */
+    void help(Counter& counter)
+    {
+        int me = self();
+        for (int idle = 0; !counter.isDone();)
+        {
+            Task *task = find(me);
+            if (task != NULL)
+            {
+                execute(task);
+                idle = 0;
+            }
+            else if (++idle > SPINS) std::this_thread::yield();
+        }
+    }
+
+    void loop(int index)
+    {
+        current().pool = this;
+        current().index = index;
+        for (int idle = 0; !stopping.load(std::memory_order_acquire);)
+        {
+            Task *task = find(index);
+            if (task != NULL)
+            {
+                execute(task);
+                idle = 0;
+            }
+            else if (idle < SPINS)
+            {
+                ++idle;
+                std::this_thread::yield();
+            }
+            // idle stays saturated, so a wake-up that finds nothing parks again at once
+            else park();
+        }
+    }
+
+public:
+    /**
+     * Starts threads worker threads; by default one per hardware thread.
+     */
+    TaskScheduler(int threads = 0):stopping(false), sleeping(0)
+    {
+        if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) threads = 1;
+        workerCount = threads;
+        workers = new Worker[threads];
+        for (int i = 0; i < threads; ++i) workers[i].thread = std::thread(&TaskScheduler::loop, this, i);
+    }
+
+    /**
+     * Destructor. Waits for every spawned task to finish, then stops the workers.
+     */
+    ~TaskScheduler()
+    {
+        help(all);
+        stopping.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> guard(injectedLock);
+            wakeUp.notify_all();
+        }
+        for (int i = 0; i < workerCount; ++i) workers[i].thread.join();
+        delete [] workers;
+    }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * Schedules f() to run on the pool as part of the group counted by counter.
+     * Safe to call from any thread, including from inside a task.
+     */
+    template <class F>
+    void spawn(Counter& counter, F f)
+    {
+        Task *task = new FunctionTask<F>(std::move(f));
+        task->counter = &counter;
+        counter.pending.fetch_add(1, std::memory_order_relaxed);
+        all.pending.fetch_add(1, std::memory_order_relaxed);
+        push(task);
+    }
+
+    /**
+     * Schedules f() to run on the pool; wait() waits for it.
+     */
+    template <class F>
+    void spawn(F f)
+    {
+        spawn(all, std::move(f));
+    }
+
+    /**
+     * Returns once every task spawned on counter has finished, running tasks meanwhile.
+     */
+    void wait(Counter& counter)
+    {
+        help(counter);
+    }
+
+    /**
+     * Returns once every task spawned on this scheduler has finished. Must not be
+     * called from inside a task, which would wait for itself.
+     */
+    void wait()
+    {
+        help(all);
+    }
+
+    /**
+     * Returns the number of worker threads.
+     */
+    int size() const
+    {
+        return workerCount;
+    }
+};
+
+#endif
@@ -0,0 +1,468 @@
+/** @file */
+#ifndef __UNROLLEDLINKEDLIST_H
+#define __UNROLLEDLINKEDLIST_H
+
+#include "IndexOutOfBound.h"
+#include "ElementNotExist.h"
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+/**
+ * A list with the LinkedList interface that stores up to N elements per node, contiguously,
+ * so a scan touches one pair of link pointers per N elements and walks memory in order.
+ * N between 32 and 64 suits small element types.
+ *
+ * Inserting into a full node splits it into two half-full nodes. A node that drops below
+ * half-full after a removal merges with its neighbour if they fit in one node, or borrows
+ * elements from it otherwise, so every node except the ones at either end stays at least
+ * half-full. Positional operations skip whole nodes by their counts, walking from the
+ * nearer end. addFirst/addLast into a full end node open a new node instead of splitting,
+ * so building a list from either end leaves its nodes full.
+ */
+template <class T, int N = 64>
+class UnrolledLinkedList
+{
+    static_assert(N >= 4, "UnrolledLinkedList needs at least 4 elements per node");
+
+    static const int HALF = N / 2;
+
+    class Node
+    {
+    public:
+        Node *pre, *next;
+        int count;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type slots[N];
+
+        Node(Node *pre, Node *next):pre(pre), next(next), count(0) {}
+        T *items() { return reinterpret_cast<T *>(slots); }
+    };
+
+    Node *head, *tail;
+    int currentSize;
+
+    /**
+     * Moves n elements from src to the raw slots at dst. The ranges may overlap.
+     */
+    static void relocate(T *dst, T *src, int n)
+    {
+        if (dst < src)
+            for (int i = 0; i < n; ++i)
+            {
+                new (dst + i) T(std::move(src[i]));
+                src[i].~T();
+            }
+        else
+            for (int i = n - 1; i >= 0; --i)
+            {
+                new (dst + i) T(std::move(src[i]));
+                src[i].~T();
+            }
+    }
+
+    Node *link(Node *pre, Node *next)
+    {
+        Node *x = new Node(pre, next);
+        if (pre != NULL) pre -> next = x;
+        else head = x;
+        if (next != NULL) next -> pre = x;
+        else tail = x;
+        return x;
+    }
+
+    void unlink(Node *x)
+    {
+        if (x -> pre != NULL) x -> pre -> next = x -> next;
+        else head = x -> next;
+        if (x -> next != NULL) x -> next -> pre = x -> pre;
+        else tail = x -> pre;
+        delete x;
+    }
+
+    /**
+     * Finds the node holding element index and the offset of the element in it,
+     * skipping whole nodes from the nearer end. index == size gives (tail, tail->count).
+     */
+    Node *locate(int index, int &offset) const
+    {
+        if (index <= currentSize / 2)
+        {
+            Node *x = head;
+            for (; index >= x -> count && x -> next != NULL; x = x -> next) index -= x -> count;
+            offset = index;
+            return x;
+        }
+        Node *x = tail;
+        int end = currentSize;
+        for (; index < end - x -> count; x = x -> pre) end -= x -> count;
+        offset = index - (end - x -> count);
+        return x;
+    }
+
+    void insert(Node *x, int offset, const T& e)
+    {
+        T tmp(e);
+        if (x -> count == N)
+        {
+            Node *y = link(x, x -> next);
+            relocate(y -> items(), x -> items() + HALF, N - HALF);
+            y -> count = N - HALF;
+            x -> count = HALF;
+            if (offset > HALF)
+            {
+                offset -= HALF;
+                x = y;
+            }
+        }
+        T *items = x -> items();
+        relocate(items + offset + 1, items + offset, x -> count - offset);
+        new (items + offset) T(std::move(tmp));
+        ++x -> count;
+        ++currentSize;
+    }
+
+    /**
+     * Removes the element at offset in x and rebalances. On return x and offset
+     * locate the element that followed the removed one (x is NULL if there is none).
+     */
+    void erase(Node *&x, int &offset)
+    {
+        T *items = x -> items();
+        items[offset].~T();
+        relocate(items + offset, items + offset + 1, x -> count - offset - 1);
+        --x -> count;
+        --currentSize;
+        if (x -> count == 0)
+        {
+            Node *next = x -> next;
+            unlink(x);
+            x = next, offset = 0;
+            return;
+        }
+        if (x -> count < HALF)
+        {
+            Node *next = x -> next;
+            if (next != NULL)
+            {
+                // merge with the next node, or borrow enough of it to be half-full again
+                int k = x -> count + next -> count <= N ? next -> count : HALF - x -> count;
+                relocate(x -> items() + x -> count, next -> items(), k);
+                relocate(next -> items(), next -> items() + k, next -> count - k);
+                x -> count += k, next -> count -= k;
+                if (next -> count == 0) unlink(next);
+            }
+            else if ((x -> pre != NULL) && (x -> pre -> count + x -> count <= N))
+            {
+                Node *pre = x -> pre;
+                relocate(pre -> items() + pre -> count, x -> items(), x -> count);
+                offset += pre -> count;
+                pre -> count += x -> count;
+                x -> count = 0;
+                unlink(x);
+                x = pre;
+            }
+        }
+        if (offset == x -> count) x = x -> next, offset = 0;
+    }
+
+    void destroyAll()
+    {
+        for (Node *x = head; x != NULL;)
+        {
+            Node *next = x -> next;
+            for (int i = 0; i < x -> count; ++i) x -> items()[i].~T();
+            delete x;
+            x = next;
+        }
+        head = tail = NULL;
+        currentSize = 0;
+    }
+
+public:
+    class Iterator
+    {
+        UnrolledLinkedList *link;
+        Node *node, *lastNode;
+        int offset, lastOffset;
+
+    public:
+        Iterator(UnrolledLinkedList *link):link(link), node(link -> head), lastNode(NULL), offset(0), lastOffset(0)
+        {
+            if ((node != NULL) && (node -> count == 0)) node = NULL;
+        }
+
+        /**
+         * Returns true if the iteration has more elements.
+         */
+        bool hasNext() const
+        {
+            return node != NULL;
+        }
+
+        /**
+         * Returns the next element in the iteration.
+         * @throw ElementNotExist exception when hasNext() == false
+         */
+        const T &next()
+        {
+            if (!hasNext()) throw ElementNotExist("UnrolledLinkedList:next:ElementNotExist");
+            lastNode = node, lastOffset = offset;
+            if (++offset == node -> count) node = node -> next, offset = 0;
+            return lastNode -> items()[lastOffset];
+        }
+
+        /**
+         * Removes from the underlying list the last element returned by the iterator.
+         * @throw ElementNotExist
+         */
+        void remove()
+        {
+            if (lastNode == NULL) throw ElementNotExist("UnrolledLinkedList:remove:ElementNotExist");
+            link -> erase(lastNode, lastOffset);
+            node = lastNode, offset = lastOffset;
+            lastNode = NULL;
+        }
+    };
+
+    /**
+     * Constructs an empty list.
+     */
+    UnrolledLinkedList():head(NULL), tail(NULL), currentSize(0) {}
+
+    /**
+     * Copy constructor
+     */
+    UnrolledLinkedList(const UnrolledLinkedList &c):head(NULL), tail(NULL), currentSize(0)
+    {
+        for (Node *x = c.head; x != NULL; x = x -> next)
+            for (int i = 0; i < x -> count; ++i) addLast(x -> items()[i]);
+    }
+
+    /**
+     * Assignment operator
+     */
+    UnrolledLinkedList& operator=(const UnrolledLinkedList &c)
+    {
+        if (this == &c) return *this;
+        clear();
+        for (Node *x = c.head; x != NULL; x = x -> next)
+            for (int i = 0; i < x -> count; ++i) addLast(x -> items()[i]);
+        return *this;
+    }
+
+    /**
+     * Destructor
+     */
+    ~UnrolledLinkedList()
+    {
+        destroyAll();
+    }
+
+    /**
+     * Appends the specified element to the end of this list.
+     * Always returns true.
+     */
+    bool add(const T& e)
+    {
+        addLast(e);
+        return true;
+    }
+
+    /**
+     * Inserts the specified element to the beginning of this list.
+     */
+    void addFirst(const T& e)
+    {
+        if ((head == NULL) || (head -> count == N))
+        {
+            T tmp(e);
+            link(NULL, head);
+            new (head -> items()) T(std::move(tmp));
+            ++head -> count;
+            ++currentSize;
+        }
+        else insert(head, 0, e);
+    }
+
+    /**
+     * Inserts the specified element to the end of this list.
+     */
+    void addLast(const T& e)
+    {
+        if ((tail == NULL) || (tail -> count == N))
+        {
+            T tmp(e);
+            link(tail, NULL);
+            new (tail -> items()) T(std::move(tmp));
+            ++tail -> count;
+            ++currentSize;
+        }
+        else
+        {
+            new (tail -> items() + tail -> count) T(e);
+            ++tail -> count;
+            ++currentSize;
+        }
+    }
+
+    /**
+     * Inserts the specified element to the specified position in this list.
+     * The range of index parameter is [0, size].
+     * @throw IndexOutOfBound
+     */
+    void add(int index, const T& e)
+    {
+        if ((index < 0) || (index > currentSize)) throw IndexOutOfBound("UnrolledLinkedList:add:IndexOutOfBound");
+        if (index == currentSize)
+        {
+            addLast(e);
+            return;
+        }
+        int offset;
+        Node *x = locate(index, offset);
+        insert(x, offset, e);
+    }
+
+    /**
+     * Removes all of the elements from this list.
+     */
+    void clear()
+    {
+        destroyAll();
+    }
+
+    /**
+     * Returns true if this list contains the specified element.
+     */
+    bool contains(const T& e) const
+    {
+        for (Node *x = head; x != NULL; x = x -> next)
+        {
+            const T *items = x -> items();
+            for (int i = 0; i < x -> count; ++i) if (items[i] == e) return true;
+        }
+        return false;
+    }
+
+    /**
+     * Returns a const reference to the element at the specified position in this list.
+     * @throw IndexOutOfBound
+     */
+    const T& get(int index) const
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("UnrolledLinkedList:get:IndexOutOfBound");
+        int offset;
+        Node *x = locate(index, offset);
+        return x -> items()[offset];
+    }
+
+    /**
+     * Returns a const reference to the first element.
+     * @throw ElementNotExist
+     */
+    const T& getFirst() const
+    {
+        if (currentSize == 0) throw ElementNotExist("UnrolledLinkedList:getFirst:ElementNotExist");
+        return head -> items()[0];
+    }
+
+    /**
+     * Returns a const reference to the last element.
+     * @throw ElementNotExist
+     */
+    const T& getLast() const
+    {
+        if (currentSize == 0) throw ElementNotExist("UnrolledLinkedList:getLast:ElementNotExist");
+        return tail -> items()[tail -> count - 1];
+    }
+
+    /**
+     * Returns true if this list contains no elements.
+     */
+    bool isEmpty() const
+    {
+        return currentSize == 0;
+    }
+
+    /**
+     * Removes the element at the specified position in this list.
+     * @throw IndexOutOfBound
+     */
+    void removeIndex(int index)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("UnrolledLinkedList:removeIndex:IndexOutOfBound");
+        int offset;
+        Node *x = locate(index, offset);
+        erase(x, offset);
+    }
+
+    /**
+     * Removes the first occurrence of the specified element from this list, if it is present.
+     * Returns true if it was present in the list, otherwise false.
+     */
+    bool remove(const T& e)
+    {
+        for (Node *x = head; x != NULL; x = x -> next)
+            for (int i = 0; i < x -> count; ++i) if (x -> items()[i] == e)
+            {
+                erase(x, i);
+                return true;
+            }
+        return false;
+    }
+
+    /**
+     * Removes the first element from this list.
+     * @throw ElementNotExist
+     */
+    void removeFirst()
+    {
+        if (currentSize == 0) throw ElementNotExist("UnrolledLinkedList:removeFirst:ElementNotExist");
+        Node *x = head;
+        int offset = 0;
+        erase(x, offset);
+    }
+
+    /**
+     * Removes the last element from this list.
+     * @throw ElementNotExist
+     */
+    void removeLast()
+    {
+        if (currentSize == 0) throw ElementNotExist("UnrolledLinkedList:removeLast:ElementNotExist");
+        Node *x = tail;
+        int offset = tail -> count - 1;
+        erase(x, offset);
+    }
+
+    /**
+     * Replaces the element at the specified position in this list with the specified element.
+     * @throw IndexOutOfBound
+     */
+    void set(int index, const T& e)
+    {
+        if ((index < 0) || (index >= currentSize)) throw IndexOutOfBound("UnrolledLinkedList:set:IndexOutOfBound");
+        int offset;
+        Node *x = locate(index, offset);
+        x -> items()[offset] = e;
+    }
+
+    /**
+     * Returns the number of elements in this list.
+     */
+    int size() const
+    {
+        return currentSize;
+    }
+
+    /**
+     * Returns an iterator over the elements in this list.
+     */
+    Iterator iterator()
+    {
+        return Iterator(this);
+    }
+};
+
+#endif
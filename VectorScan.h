@@ -0,0 +1,241 @@
+/** @file */
+#ifndef __VECTORSCAN_H
+#define __VECTORSCAN_H
+
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Linear equality scans (indexOf, lastIndexOf, count) over a contiguous array.
+ *
+ * For integral and floating-point element types the scan compares a whole vector
+ * register per step, with AVX2 when the compiler targets it (-mavx2), SSE2 otherwise.
+ * Every other type, and every build without either instruction set, uses the scalar loop.
+ * Floating-point comparison follows operator==: NaN never matches and -0.0 matches 0.0.
+ */
+namespace VectorScan
+{
+    enum Kind { NONE, I8, I16, I32, I64, F32, F64 };
+
+    template <class T>
+    class KindOf
+    {
+        static const int integral = !std::is_integral<T>::value || std::is_same<T, bool>::value ? NONE :
+                                    sizeof(T) == 1 ? I8 : sizeof(T) == 2 ? I16 : sizeof(T) == 4 ? I32 : sizeof(T) == 8 ? I64 : NONE;
+        static const int floating = std::is_same<T, float>::value ? F32 : std::is_same<T, double>::value ? F64 : NONE;
+    public:
+        static const int value = integral != NONE ? integral : floating;
+    };
+
+    /**
+     * The scalar scans, used for every type without a vector kernel.
+     */
+    template <class T>
+    class Scalar
+    {
+    public:
+        static int indexOf(const T *p, int n, const T &key)
+        {
+            for (int i = 0; i < n; ++i) if (p[i] == key) return i;
+            return -1;
+        }
+
+        static int lastIndexOf(const T *p, int n, const T &key)
+        {
+            for (int i = n - 1; i >= 0; --i) if (p[i] == key) return i;
+            return -1;
+        }
+
+        static int count(const T *p, int n, const T &key)
+        {
+            int c = 0;
+            for (int i = 0; i < n; ++i) if (p[i] == key) ++c;
+            return c;
+        }
+    };
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+#if defined(__AVX2__)
+    typedef __m256i Vec;
+    static const int WIDTH = 32;
+    inline Vec load(const void *p) { return _mm256_loadu_si256((const __m256i *)p); }
+    inline unsigned mask(Vec v) { return (unsigned)_mm256_movemask_epi8(v); }
+#else
+    typedef __m128i Vec;
+    static const int WIDTH = 16;
+    inline Vec load(const void *p) { return _mm_loadu_si128((const __m128i *)p); }
+    inline unsigned mask(Vec v) { return (unsigned)_mm_movemask_epi8(v); }
+#endif
+
+    /**
+     * splat() broadcasts the key into every lane, eq() sets every byte of the lanes that match.
+     */
+    template <int K> class Ops;
+
+#if defined(__AVX2__)
+    template <> class Ops<I8>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm256_set1_epi8(*(const char *)k); }
+        static Vec eq(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+    };
+
+    template <> class Ops<I16>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm256_set1_epi16(*(const short *)k); }
+        static Vec eq(Vec a, Vec b) { return _mm256_cmpeq_epi16(a, b); }
+    };
+
+    template <> class Ops<I32>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm256_set1_epi32(*(const int *)k); }
+        static Vec eq(Vec a, Vec b) { return _mm256_cmpeq_epi32(a, b); }
+    };
+
+    template <> class Ops<I64>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm256_set1_epi64x(*(const long long *)k); }
+        static Vec eq(Vec a, Vec b) { return _mm256_cmpeq_epi64(a, b); }
+    };
+
+    template <> class Ops<F32>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm256_castps_si256(_mm256_set1_ps(*(const float *)k)); }
+        static Vec eq(Vec a, Vec b)
+        {
+            return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+        }
+    };
+
+    template <> class Ops<F64>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm256_castpd_si256(_mm256_set1_pd(*(const double *)k)); }
+        static Vec eq(Vec a, Vec b)
+        {
+            return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+        }
+    };
+#else
+    template <> class Ops<I8>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm_set1_epi8(*(const char *)k); }
+        static Vec eq(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+    };
+
+    template <> class Ops<I16>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm_set1_epi16(*(const short *)k); }
+        static Vec eq(Vec a, Vec b) { return _mm_cmpeq_epi16(a, b); }
+    };
+
+    template <> class Ops<I32>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm_set1_epi32(*(const int *)k); }
+        static Vec eq(Vec a, Vec b) { return _mm_cmpeq_epi32(a, b); }
+    };
+
+    template <> class Ops<I64>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm_set1_epi64x(*(const long long *)k); }
+        // SSE2 has no 64-bit compare: a lane matches when both of its 32-bit halves do
+        static Vec eq(Vec a, Vec b)
+        {
+            Vec t = _mm_cmpeq_epi32(a, b);
+            return _mm_and_si128(t, _mm_shuffle_epi32(t, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+    };
+
+    template <> class Ops<F32>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm_castps_si128(_mm_set1_ps(*(const float *)k)); }
+        static Vec eq(Vec a, Vec b) { return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+    };
+
+    template <> class Ops<F64>
+    {
+    public:
+        static Vec splat(const void *k) { return _mm_castpd_si128(_mm_set1_pd(*(const double *)k)); }
+        static Vec eq(Vec a, Vec b) { return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+    };
+#endif
+
+    /**
+     * The vector scans. The byte mask of a compare has sizeof(T) bits per lane, so
+     * bit positions are divided by sizeof(T) to get element offsets.
+     */
+    template <class T, int K>
+    class Vector
+    {
+        static const int LANES = WIDTH / sizeof(T);
+        typedef Ops<K> O;
+
+    public:
+        static int indexOf(const T *p, int n, const T &key)
+        {
+            Vec k = O::splat(&key);
+            int i = 0;
+            for (; i + LANES <= n; i += LANES)
+            {
+                unsigned m = mask(O::eq(load(p + i), k));
+                if (m) return i + (int)(__builtin_ctz(m) / sizeof(T));
+            }
+            for (; i < n; ++i) if (p[i] == key) return i;
+            return -1;
+        }
+
+        static int lastIndexOf(const T *p, int n, const T &key)
+        {
+            Vec k = O::splat(&key);
+            int i = n;
+            for (; i >= LANES; i -= LANES)
+            {
+                unsigned m = mask(O::eq(load(p + i - LANES), k));
+                if (m) return i - LANES + (int)((31 - __builtin_clz(m)) / sizeof(T));
+            }
+            for (--i; i >= 0; --i) if (p[i] == key) return i;
+            return -1;
+        }
+
+        static int count(const T *p, int n, const T &key)
+        {
+            Vec k = O::splat(&key);
+            long long bits = 0;
+            int i = 0;
+            for (; i + LANES <= n; i += LANES) bits += __builtin_popcount(mask(O::eq(load(p + i), k)));
+            int c = (int)(bits / sizeof(T));
+            for (; i < n; ++i) if (p[i] == key) ++c;
+            return c;
+        }
+    };
+
+    template <class T, int K = KindOf<T>::value>
+    class Scan : public Vector<T, K> {};
+
+    template <class T>
+    class Scan<T, NONE> : public Scalar<T> {};
+
+#else
+
+    template <class T>
+    class Scan : public Scalar<T> {};
+
+#endif
+}
+
+#endif
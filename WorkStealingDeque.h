@@ -0,0 +1,160 @@
+/** @file */
+#ifndef __WORKSTEALINGDEQUE_H
+#define __WORKSTEALINGDEQUE_H
+
+#include <cstddef>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * A Chase-Lev work-stealing deque: one owner thread adds and removes at the back
+ * (addLast/removeLast, LIFO), any number of thief threads take from the front (steal).
+ * The owner's operations are wait-free except when they race a thief for the last
+ * element; steal is lock-free and may fail spuriously when another thief wins.
+ *
+ * Storage is a circular array of 2^k slots indexed by the ever-growing top and bottom
+ * counters, like Deque's ring buffer. When it fills up, the owner copies the live range
+ * into an array twice as large. Thieves may still be reading the old array, so retired
+ * arrays are only freed by the destructor.
+ *
+ * T must be trivially copyable; it is normally a pointer to a task.
+ * Memory orderings follow Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient
+ * Work-Stealing for Weak Memory Models" (PPoPP 2013), except that slots are written
+ * with release and read with acquire, which is free on x86 and lets ThreadSanitizer,
+ * which ignores fences, see that a stolen pointer's target was published.
+ */
+template <class T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque needs a trivially copyable T");
+
+    class Array
+    {
+    public:
+        long long mask;
+        std::atomic<T> *slots;
+        Array *retired;
+
+        Array(long long size, Array *retired):mask(size - 1), slots(new std::atomic<T>[size]), retired(retired) {}
+        ~Array() { delete [] slots; }
+
+        T get(long long i) const { return slots[i & mask].load(std::memory_order_acquire); }
+        void put(long long i, T x) { slots[i & mask].store(x, std::memory_order_release); }
+    };
+
+    std::atomic<long long> top, bottom;
+    std::atomic<Array *> array;
+
+    Array *grow(Array *a, long long t, long long b)
+    {
+        Array *bigger = new Array((a->mask + 1) << 1, a);
+        for (long long i = t; i < b; ++i) bigger->put(i, a->get(i));
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+public:
+    /**
+     * Constructs an empty deque with room for capacity elements (rounded up to a power of two).
+     */
+    WorkStealingDeque(int capacity = 256):top(0), bottom(0)
+    {
+        long long c = 1;
+        for (; c < capacity; c <<= 1);
+        array.store(new Array(c, NULL), std::memory_order_relaxed);
+    }
+
+    /**
+     * Destructor. Frees the current array and every retired one.
+     */
+    ~WorkStealingDeque()
+    {
+        for (Array *a = array.load(std::memory_order_relaxed); a != NULL;)
+        {
+            Array *next = a->retired;
+            delete a;
+            a = next;
+        }
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /**
+     * Pushes x at the back. Owner only.
+     */
+    void addLast(T x)
+    {
+        long long b = bottom.load(std::memory_order_relaxed);
+        long long t = top.load(std::memory_order_acquire);
+        Array *a = array.load(std::memory_order_relaxed);
+        if (b - t > a->mask) a = grow(a, t, b);
+        a->put(b, x);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Pops the most recently added element into out. Owner only.
+     * Returns false if the deque is empty or a thief took the last element.
+     */
+    bool removeLast(T& out)
+    {
+        long long b = bottom.load(std::memory_order_relaxed) - 1;
+        Array *a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long t = top.load(std::memory_order_relaxed);
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        T x = a->get(b);
+        if (t == b)
+        {
+            // last element: race the thieves for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won) return false;
+        }
+        out = x;
+        return true;
+    }
+
+    /**
+     * Takes the oldest element into out. Any thread.
+     * Returns false if the deque is empty or another thread took the element first.
+     */
+    bool steal(T& out)
+    {
+        long long t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return false;
+        Array *a = array.load(std::memory_order_acquire);
+        T x = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return false;
+        out = x;
+        return true;
+    }
+
+    /**
+     * Returns the number of elements at the moment of the call; approximate under concurrency.
+     */
+    int size() const
+    {
+        long long b = bottom.load(std::memory_order_relaxed), t = top.load(std::memory_order_relaxed);
+        return b > t ? (int)(b - t) : 0;
+    }
+
+    /**
+     * Returns true if the deque looks empty.
+     */
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+};
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file
+ * Builds lists of heap-owning strings and returns them from functions, comparing a
+ * deep copy with a move at each hand-off, and add(const T&) with add(T&&) and emplace.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/ArrayListMoveBench.cpp -o ArrayListMoveBench
+ */
+#include "ArrayList.h"
+#include "Bench.h"
+#include <string>
+
+static const std::string PAYLOAD(40, 'x');
+
+static ArrayList<std::string> build(int n)
+{
+    ArrayList<std::string> list;
+    for (int i = 0; i < n; ++i) list.emplace(PAYLOAD);
+    return list;
+}
+
+int main(int argc, char **argv)
+{
+    double scale = Bench::scale(argc, argv);
+    int n = (int)(1000 * scale), rounds = (int)(2000 * scale);
+
+    {
+        Bench::Stopwatch watch;
+        for (int r = 0; r < rounds; ++r)
+        {
+            ArrayList<std::string> list = build(n);
+            ArrayList<std::string> copy(list);
+            Bench::keep(copy.size());
+        }
+        Bench::report("build + copy-construct", (long long)n * rounds, watch.seconds());
+    }
+    {
+        Bench::Stopwatch watch;
+        for (int r = 0; r < rounds; ++r)
+        {
+            ArrayList<std::string> list = build(n);
+            ArrayList<std::string> moved(std::move(list));
+            Bench::keep(moved.size());
+        }
+        Bench::report("build + move-construct", (long long)n * rounds, watch.seconds());
+    }
+    {
+        Bench::Stopwatch watch;
+        for (int r = 0; r < rounds; ++r)
+        {
+            ArrayList<std::string> list;
+            for (int i = 0; i < n; ++i)
+            {
+                std::string s(PAYLOAD);
+                list.add(s);
+            }
+            Bench::keep(list.size());
+        }
+        Bench::report("add(const T&) of a temporary string", (long long)n * rounds, watch.seconds());
+    }
+    {
+        Bench::Stopwatch watch;
+        for (int r = 0; r < rounds; ++r)
+        {
+            ArrayList<std::string> list;
+            for (int i = 0; i < n; ++i)
+            {
+                std::string s(PAYLOAD);
+                list.add(std::move(s));
+            }
+            Bench::keep(list.size());
+        }
+        Bench::report("add(T&&) of a temporary string", (long long)n * rounds, watch.seconds());
+    }
+    {
+        Bench::Stopwatch watch;
+        for (int r = 0; r < rounds; ++r)
+        {
+            ArrayList<std::string> list;
+            for (int i = 0; i < n; ++i) list.emplace(40, 'x');
+            Bench::keep(list.size());
+        }
+        Bench::report("emplace(40, 'x')", (long long)n * rounds, watch.seconds());
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+/** @file */
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+/**
+ * Helpers shared by the benchmark programs in this directory.
+ *
+ * Every benchmark takes an optional scale factor as its first argument (default 1), which
+ * multiplies its problem sizes, so a quick run and a long one use the same binary.
+ */
+namespace Bench
+{
+    /**
+     * Wall-clock timer, started on construction.
+     */
+    class Stopwatch
+    {
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        Stopwatch():start(std::chrono::steady_clock::now()) {}
+
+        double seconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    /**
+     * Returns the scale factor given on the command line.
+     */
+    inline double scale(int argc, char **argv)
+    {
+        double s = argc > 1 ? std::atof(argv[1]) : 1;
+        return s > 0 ? s : 1;
+    }
+
+    /**
+     * Prints one result line: the case name, the time taken and the throughput.
+     */
+    inline void report(const char *name, long long ops, double seconds)
+    {
+        std::printf("%-48s %10.3f ms %10.2f Mops/s\n", name, seconds * 1e3, seconds > 0 ? ops / seconds / 1e6 : 0.0);
+    }
+
+    /**
+     * Returns the resident set size of the process in KB, from /proc/self/statm (Linux),
+     * or -1 if it cannot be read.
+     */
+    inline long residentKB()
+    {
+        long pages = 0, resident = 0;
+        FILE *f = std::fopen("/proc/self/statm", "r");
+        if (f == NULL) return -1;
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = -1;
+        std::fclose(f);
+        return resident < 0 ? -1 : resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+
+    /**
+     * Keeps the compiler from discarding a computed value.
+     */
+    template <class T>
+    inline void keep(const T& value)
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        static volatile char sink;
+        sink = *reinterpret_cast<const volatile char *>(&value);
+#endif
+    }
+
+    /**
+     * Small xorshift generator for reproducible inputs.
+     */
+    class Random
+    {
+        unsigned long long s;
+
+    public:
+        Random(unsigned long long seed = 88172645463325252ull):s(seed ? seed : 1) {}
+
+        unsigned next()
+        {
+            s ^= s << 13, s ^= s >> 7, s ^= s << 17;
+            return (unsigned)(s >> 32);
+        }
+    };
+}
+
+#endif
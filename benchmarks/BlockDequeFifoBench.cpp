@@ -0,0 +1,88 @@
+/**
+ * @file
+ * BlockDeque against Deque as a long-running FIFO work queue, as in DequeFifoBench: k
+ * items in flight, one addLast and one removeFirst per step, for k from 4 to 1M, with
+ * the resident memory before and after, which must stay flat at a steady size. A first
+ * case fills each to 4M elements and drains it, reporting the resident memory it adds
+ * when full.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/BlockDequeFifoBench.cpp -o BlockDequeFifoBench
+ */
+#include "BlockDeque.h"
+#include "Deque.h"
+#include "Bench.h"
+#include <cstdio>
+
+template <class Q>
+static void fifo(const char *name, int k, long long steps)
+{
+    Q queue;
+    for (int i = 0; i < k; ++i) queue.addLast(i);
+    long long sum = 0;
+    // warm up, so that the first sample already counts the code and stdio pages
+    for (int i = 0; i < 1000000; ++i)
+    {
+        queue.addLast(i);
+        queue.removeFirst();
+    }
+    long before = Bench::residentKB();
+    Bench::Stopwatch watch;
+    for (long long i = 0; i < steps; ++i)
+    {
+        queue.addLast(i);
+        sum += queue.getFirst();
+        queue.removeFirst();
+    }
+    double seconds = watch.seconds();
+    long after = Bench::residentKB();
+    Bench::keep(sum);
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s fifo in-flight=%d", name, k);
+    Bench::report(label, steps, seconds);
+    std::printf("    RSS before %ld KB, after %ld KB%s\n", before, after, after > before + 64 ? "  (GREW)" : "");
+}
+
+template <class Q>
+static void fillAndDrain(const char *name, int n)
+{
+    long before = Bench::residentKB();
+    Bench::Stopwatch watch;
+    long full;
+    long long sum = 0;
+    {
+        Q queue;
+        for (int i = 0; i < n; ++i) queue.addLast(i);
+        full = Bench::residentKB();
+        while (!queue.isEmpty())
+        {
+            sum += queue.getFirst();
+            queue.removeFirst();
+        }
+    }
+    double seconds = watch.seconds();
+    Bench::keep(sum);
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s fill + drain %d", name, n);
+    Bench::report(label, 2LL * n, seconds);
+    std::printf("    RSS when full +%ld KB\n", full - before);
+}
+
+int main(int argc, char **argv)
+{
+    double scale = Bench::scale(argc, argv);
+    long long steps = (long long)(50000000 * scale);
+    const int inFlight[] = { 4, 64, 4096, 1000000 };
+    std::printf("%lld steps per case\n", steps);
+    // touch stdio and the clock once, so their setup does not count as growth
+    Bench::residentKB();
+    Bench::keep(Bench::Stopwatch().seconds());
+    // the fill cases first, so neither reuses memory the other freed
+    fillAndDrain<BlockDeque<long long> >("BlockDeque", (int)(4000000 * scale));
+    fillAndDrain<Deque<long long> >("Deque", (int)(4000000 * scale));
+    for (int k : inFlight)
+    {
+        fifo<Deque<long long> >("Deque", k, steps);
+        fifo<BlockDeque<long long> >("BlockDeque", k, steps);
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file
+ * Cache under Zipfian access traces (1M distinct keys, skew 0.8 and 0.99), used as a
+ * read-through cache: get, and put on a miss. Reports throughput and hit ratio for each
+ * policy at 1% and 10% of the keys, against the hand-rolled LRU it replaces (a HashMap
+ * plus a LinkedList whose touch is a linear remove) on a shorter trace, and the resident
+ * memory of 1000 small caches.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/CacheBench.cpp -o CacheBench
+ */
+#include "Cache.h"
+#include "HashMap.h"
+#include "LinkedList.h"
+#include "Bench.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static const int KEYS = 1000000;
+
+class IntHash
+{
+public:
+    static int hashCode(int x)
+    {
+        return x;
+    }
+};
+
+/**
+ * n accesses over KEYS keys, rank r drawn with probability proportional to 1 / r^skew.
+ * Ranks are scattered over the key space so that popular keys are not neighbours.
+ */
+static std::vector<int> zipf(long long n, double skew)
+{
+    std::vector<double> cdf(KEYS);
+    double sum = 0;
+    for (int r = 0; r < KEYS; ++r) cdf[r] = sum += 1 / std::pow(r + 1.0, skew);
+    Bench::Random random;
+    std::vector<int> trace(n);
+    for (long long i = 0; i < n; ++i)
+    {
+        double u = (random.next() + 0.5) / 4294967296.0 * sum;
+        int rank = (int)(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+        trace[i] = (int)(((unsigned)rank * 2654435761u) & 0x7fffffff);
+    }
+    return trace;
+}
+
+static void run(const char *name, const std::vector<int>& trace, long long capacity, CachePolicy policy)
+{
+    Cache<int, int, IntHash> cache(capacity, policy);
+    Bench::Stopwatch watch;
+    for (size_t i = 0; i < trace.size(); ++i)
+    {
+        int value;
+        if (!cache.get(trace[i], value)) cache.put(trace[i], trace[i]);
+    }
+    double seconds = watch.seconds();
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s, capacity %lld", name, capacity);
+    Bench::report(label, (long long)trace.size(), seconds);
+    std::printf("    hit ratio %.3f, %lld evictions\n", (double)cache.hitCount() / trace.size(), cache.evictionCount());
+}
+
+/**
+ * The LRU this container replaces: touching an entry removes it from the LinkedList
+ * by value, a linear scan.
+ */
+static void runHandRolled(const std::vector<int>& trace, int capacity, long long n)
+{
+    HashMap<int, int, IntHash> map;
+    LinkedList<int> order;
+    long long hits = 0;
+    Bench::Stopwatch watch;
+    for (long long i = 0; i < n; ++i)
+    {
+        int key = trace[i];
+        if (map.containsKey(key))
+        {
+            ++hits;
+            order.remove(key);
+            order.addLast(key);
+            continue;
+        }
+        if (order.size() == capacity)
+        {
+            map.remove(order.getFirst());
+            order.removeFirst();
+        }
+        map.put(key, key);
+        order.addLast(key);
+    }
+    double seconds = watch.seconds();
+    char label[96];
+    std::snprintf(label, sizeof(label), "HashMap + LinkedList LRU, capacity %d", capacity);
+    Bench::report(label, n, seconds);
+    std::printf("    hit ratio %.3f\n", (double)hits / n);
+}
+
+int main(int argc, char **argv)
+{
+    long long n = (long long)(4000000 * Bench::scale(argc, argv));
+    long before = Bench::residentKB();
+    {
+        std::vector<Cache<int, int, IntHash> *> caches;
+        for (int i = 0; i < 1000; ++i)
+        {
+            caches.push_back(new Cache<int, int, IntHash>(100));
+            for (int k = 0; k < 100; ++k) caches.back()->put(k, k);
+        }
+        std::printf("1000 caches of 100 entries: RSS +%ld KB\n", Bench::residentKB() - before);
+        for (int i = 0; i < 1000; ++i) delete caches[i];
+    }
+
+    std::printf("%lld accesses per trace, %d keys\n", n, KEYS);
+    const double skews[] = { 0.8, 0.99 };
+    for (double skew : skews)
+    {
+        std::vector<int> trace = zipf(n, skew);
+        std::printf("skew %.2f\n", skew);
+        for (long long capacity = KEYS / 100; capacity <= KEYS / 10; capacity *= 10)
+        {
+            run("LRU", trace, capacity, CachePolicy::LRU);
+            run("CLOCK", trace, capacity, CachePolicy::CLOCK);
+            run("SEGMENTED_LRU", trace, capacity, CachePolicy::SEGMENTED_LRU);
+        }
+        runHandRolled(trace, KEYS / 1000, n / 20);
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * Sums one field, then two fields, of 64-byte records stored as ArrayList<Record>
+ * (array of structs) and as ColumnList (struct of arrays).
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/ColumnListBench.cpp -o ColumnListBench
+ */
+#include "ColumnList.h"
+#include "Bench.h"
+
+class Record
+{
+public:
+    long long id;
+    double price;
+    double quantity;
+    char padding[40];
+};
+
+int main(int argc, char **argv)
+{
+    double scale = Bench::scale(argc, argv);
+    int n = (int)(4000000 * scale), rounds = 10;
+    ArrayList<Record> rows;
+    ColumnList<long long, double, double> columns;
+    rows.reserve(n);
+    columns.reserve(n);
+    for (int i = 0; i < n; ++i)
+    {
+        Record r;
+        r.id = i, r.price = i * 0.5, r.quantity = i % 7;
+        rows.add(r);
+        columns.add(r.id, r.price, r.quantity);
+    }
+
+    const Record *r = rows.array();
+    {
+        Bench::Stopwatch watch;
+        for (int k = 0; k < rounds; ++k)
+        {
+            double sum = 0;
+            for (int i = 0; i < n; ++i) sum += r[i].price;
+            Bench::keep(sum);
+        }
+        Bench::report("ArrayList<Record>  sum(price)", (long long)n * rounds, watch.seconds());
+    }
+    {
+        Bench::Stopwatch watch;
+        for (int k = 0; k < rounds; ++k)
+        {
+            const double *price = columns.column<1>();
+            double sum = 0;
+            for (int i = 0; i < n; ++i) sum += price[i];
+            Bench::keep(sum);
+        }
+        Bench::report("ColumnList         sum(price)", (long long)n * rounds, watch.seconds());
+    }
+    {
+        Bench::Stopwatch watch;
+        for (int k = 0; k < rounds; ++k)
+        {
+            double sum = 0;
+            for (int i = 0; i < n; ++i) sum += r[i].price * r[i].quantity;
+            Bench::keep(sum);
+        }
+        Bench::report("ArrayList<Record>  sum(price * quantity)", (long long)n * rounds, watch.seconds());
+    }
+    {
+        Bench::Stopwatch watch;
+        for (int k = 0; k < rounds; ++k)
+        {
+            const double *price = columns.column<1>(), *quantity = columns.column<2>();
+            double sum = 0;
+            for (int i = 0; i < n; ++i) sum += price[i] * quantity[i];
+            Bench::keep(sum);
+        }
+        Bench::report("ColumnList         sum(price * quantity)", (long long)n * rounds, watch.seconds());
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file
+ * DaryHeap with D = 2 and 4 against PriorityQueue, for int and a 64-byte payload ordered
+ * by its first field:
+ *
+ *   - push 1M random elements, then pop them all;
+ *   - hold: a heap of 100K elements, each step popping the head and pushing a new element
+ *     slightly behind it, as an event queue does;
+ *   - iterate: walk 100K heaps of 0 to 8 elements with a fresh iterator each, which
+ *     shows what creating an iterator costs.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/DaryHeapBench.cpp -o DaryHeapBench
+ */
+#include "DaryHeap.h"
+#include "PriorityQueue.h"
+#include "Bench.h"
+#include <cstdio>
+#include <vector>
+
+/**
+ * 64 bytes, compared by key.
+ */
+class Payload
+{
+public:
+    int key;
+    int rest[15];
+
+    Payload(int key = 0):key(key)
+    {
+        for (int i = 0; i < 15; ++i) rest[i] = key + i;
+    }
+
+    bool operator<(const Payload& o) const
+    {
+        return key < o.key;
+    }
+};
+
+template <class T, class Q>
+static void run(const char *type, const char *name, int n, long long holdSteps)
+{
+    char label[96];
+    Bench::Random random;
+    long long sum = 0;
+    {
+        Q q;
+        Bench::Stopwatch watch;
+        for (int i = 0; i < n; ++i) q.push(T((int)(random.next() >> 1)));
+        while (!q.empty())
+        {
+            sum += q.front().key;
+            q.pop();
+        }
+        std::snprintf(label, sizeof(label), "%s %s push + pop", name, type);
+        Bench::report(label, 2LL * n, watch.seconds());
+    }
+    {
+        const int HOLD = 100000;
+        Q q;
+        for (int i = 0; i < HOLD; ++i) q.push(T((int)(random.next() % (1u << 20))));
+        Bench::Stopwatch watch;
+        for (long long i = 0; i < holdSteps; ++i)
+        {
+            int head = q.front().key;
+            q.pop();
+            q.push(T(head + (int)(random.next() % (1u << 20))));
+        }
+        sum += q.front().key;
+        std::snprintf(label, sizeof(label), "%s %s hold, 100K", name, type);
+        Bench::report(label, holdSteps, watch.seconds());
+    }
+    {
+        const int HEAPS = 100000, PASSES = 20;
+        std::vector<Q> heaps(HEAPS);
+        for (int i = 0; i < HEAPS; ++i)
+            for (int k = (int)(random.next() % 9); k > 0; --k) heaps[i].push(T((int)(random.next() & 1023)));
+        Bench::Stopwatch watch;
+        for (int p = 0; p < PASSES; ++p)
+            for (int i = 0; i < HEAPS; ++i)
+                for (typename Q::Iterator itr = heaps[i].iterator(); itr.hasNext();) sum += itr.next().key;
+        std::snprintf(label, sizeof(label), "%s %s iterate small heaps", name, type);
+        Bench::report(label, (long long)HEAPS * PASSES, watch.seconds());
+    }
+    Bench::keep(sum);
+}
+
+/**
+ * int with the .key the cases read.
+ */
+class Int
+{
+public:
+    int key;
+
+    Int(int key = 0):key(key) {}
+
+    bool operator<(const Int& o) const
+    {
+        return key < o.key;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    double scale = Bench::scale(argc, argv);
+    int n = (int)(1000000 * scale);
+    long long hold = (long long)(2000000 * scale);
+    std::printf("%d elements pushed, %lld hold steps\n", n, hold);
+    run<Int, PriorityQueue<Int>>("int", "PriorityQueue", n, hold);
+    run<Int, DaryHeap<Int, Less<Int>, 2>>("int", "DaryHeap<2>", n, hold);
+    run<Int, DaryHeap<Int>>("int", "DaryHeap<4>", n, hold);
+    run<Payload, PriorityQueue<Payload>>("64B", "PriorityQueue", n, hold);
+    run<Payload, DaryHeap<Payload, Less<Payload>, 2>>("64B", "DaryHeap<2>", n, hold);
+    run<Payload, DaryHeap<Payload>>("64B", "DaryHeap<4>", n, hold);
+    return 0;
+}
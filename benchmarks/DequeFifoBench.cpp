@@ -0,0 +1,49 @@
+/**
+ * @file
+ * A long-running FIFO work queue: a handful of items in flight, one addLast and one
+ * removeFirst per step. Reports throughput and the process's resident memory before and
+ * after, which must stay flat because the ring never reallocates at a steady size.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/DequeFifoBench.cpp -o DequeFifoBench
+ */
+#include "Deque.h"
+#include "Bench.h"
+#include <cstdio>
+
+int main(int argc, char **argv)
+{
+    long long steps = (long long)(200000000 * Bench::scale(argc, argv));
+    const int inFlight[] = { 4, 64, 4096 };
+    std::printf("%lld steps per case\n", steps);
+    // touch stdio and the clock once, so their setup does not count as growth
+    Bench::residentKB();
+    Bench::keep(Bench::Stopwatch().seconds());
+    for (int k : inFlight)
+    {
+        Deque<long long> queue;
+        for (int i = 0; i < k; ++i) queue.addLast(i);
+        long long sum = 0;
+        // warm up, so that the first sample already counts the code and stdio pages
+        for (int i = 0; i < 1000000; ++i)
+        {
+            queue.addLast(i);
+            queue.removeFirst();
+        }
+        long before = Bench::residentKB();
+        Bench::Stopwatch watch;
+        for (long long i = 0; i < steps; ++i)
+        {
+            queue.addLast(i);
+            sum += queue.getFirst();
+            queue.removeFirst();
+        }
+        double seconds = watch.seconds();
+        long after = Bench::residentKB();
+        Bench::keep(sum);
+        char name[64];
+        std::snprintf(name, sizeof(name), "fifo in-flight=%d", k);
+        Bench::report(name, steps, seconds);
+        std::printf("    RSS before %ld KB, after %ld KB%s\n", before, after, after > before + 64 ? "  (GREW)" : "");
+    }
+    return 0;
+}
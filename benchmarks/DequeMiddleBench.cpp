@@ -0,0 +1,51 @@
+/**
+ * @file
+ * Deque::removeAt and insert at the front, middle and back of a large deque, and
+ * Iterator::remove near either end, which shift only the shorter side.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/DequeMiddleBench.cpp -o DequeMiddleBench
+ */
+#include "Deque.h"
+#include "Bench.h"
+#include <cstdio>
+
+int main(int argc, char **argv)
+{
+    double scale = Bench::scale(argc, argv);
+    int n = (int)(100000 * scale), ops = (int)(20000 * scale);
+    const char *where[] = { "front (index 10)", "middle (index n/2)", "back (index n-10)" };
+    char name[96];
+    for (int w = 0; w < 3; ++w)
+    {
+        Deque<int> d;
+        for (int i = 0; i < n; ++i) d.addLast(i);
+        // a middle operation moves n/2 elements, so it gets fewer repetitions
+        int reps = w == 1 ? ops / 100 + 1 : ops;
+        Bench::Stopwatch watch;
+        for (int k = 0; k < reps; ++k)
+        {
+            int size = d.size(), index = w == 0 ? 10 : w == 1 ? size / 2 : size - 10;
+            d.removeAt(index);
+            d.insert(index, k);
+        }
+        std::snprintf(name, sizeof(name), "removeAt + insert at %s", where[w]);
+        Bench::report(name, 2LL * reps, watch.seconds());
+    }
+    for (int w = 0; w < 2; ++w)
+    {
+        Deque<int> d;
+        for (int i = 0; i < n + ops; ++i) d.addLast(i);
+        Bench::Stopwatch watch;
+        // remove ops elements next to one end of the deque through an iterator
+        Deque<int>::Iterator itr = w == 0 ? d.iterator() : d.descendingIterator();
+        for (int k = 0; k < 10; ++k) itr.next();
+        for (int k = 0; k < ops; ++k)
+        {
+            itr.next();
+            itr.remove();
+        }
+        std::snprintf(name, sizeof(name), "Iterator::remove near the %s", w == 0 ? "front" : "back");
+        Bench::report(name, ops, watch.seconds());
+    }
+    return 0;
+}
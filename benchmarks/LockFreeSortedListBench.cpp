@@ -0,0 +1,133 @@
+/**
+ * @file
+ * LockFreeSortedList against a sorted LinkedList behind a mutex, the structure it
+ * replaces, at 1, 2, 4 and 8 threads: a read-mostly mix (90% contains, 5% add, 5%
+ * remove) and an update-heavy one (50% contains), over 512 keys with about half present.
+ * A last case has one thread cycle over 16 lists, more than a thread caches epoch
+ * records for, and reports the resident memory it adds. On a machine with fewer cores
+ * than threads the figures are time-sliced.
+ *
+ *      g++ -std=c++11 -O2 -pthread -I. benchmarks/LockFreeSortedListBench.cpp -o LockFreeSortedListBench
+ */
+#include "LockFreeSortedList.h"
+#include "LinkedList.h"
+#include "Bench.h"
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const int KEYS = 512;
+
+/**
+ * A LinkedList kept sorted, with every operation under one lock.
+ */
+class LockedSortedList
+{
+    LinkedList<int> list;
+    std::mutex lock;
+
+public:
+    bool add(int e)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        int index = 0;
+        for (LinkedList<int>::Iterator itr = list.iterator(); itr.hasNext(); ++index)
+        {
+            int x = itr.next();
+            if (x == e) return false;
+            if (x > e) break;
+        }
+        list.add(index, e);
+        return true;
+    }
+
+    bool remove(int e)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (LinkedList<int>::Iterator itr = list.iterator(); itr.hasNext();)
+        {
+            int x = itr.next();
+            if (x > e) return false;
+            if (x == e)
+            {
+                itr.remove();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool contains(int e)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (LinkedList<int>::Iterator itr = list.iterator(); itr.hasNext();)
+        {
+            int x = itr.next();
+            if (x >= e) return x == e;
+        }
+        return false;
+    }
+};
+
+/**
+ * threads threads each run perThread operations on s, reads percent of them contains
+ * and the rest split evenly between add and remove.
+ */
+template <class S>
+static void run(const char *name, int threads, long long perThread, int reads)
+{
+    S s;
+    for (int k = 0; k < KEYS; k += 2) s.add(k);
+    std::vector<std::thread> workers;
+    Bench::Stopwatch watch;
+    for (int t = 0; t < threads; ++t)
+        workers.push_back(std::thread([&, t]()
+        {
+            Bench::Random random;
+            for (int i = 0; i <= t; ++i) random.next();
+            long long hits = 0;
+            for (long long i = 0; i < perThread; ++i)
+            {
+                unsigned r = random.next();
+                int key = (int)(r % KEYS), op = (int)(r / KEYS % 100);
+                if (op < reads) hits += s.contains(key);
+                else if ((op - reads) % 2 == 0) hits += s.add(key);
+                else hits += s.remove(key);
+            }
+            Bench::keep(hits);
+        }));
+    for (int t = 0; t < threads; ++t) workers[t].join();
+    double seconds = watch.seconds();
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s, %d%% reads, %d threads", name, reads, threads);
+    Bench::report(label, perThread * threads, seconds);
+}
+
+int main(int argc, char **argv)
+{
+    long long total = (long long)(2000000 * Bench::scale(argc, argv));
+    std::printf("%u hardware threads, %lld operations per case, %d keys\n", std::thread::hardware_concurrency(), total, KEYS);
+    const int reads[] = { 90, 50 };
+    for (int r : reads)
+        for (int threads = 1; threads <= 8; threads *= 2)
+        {
+            run<LockFreeSortedList<int>>("LockFreeSortedList", threads, total / threads, r);
+            run<LockedSortedList>("LinkedList + mutex", threads, total / threads, r);
+        }
+
+    // every Guard misses the thread's record cache
+    const int LISTS = 16;
+    LockFreeSortedList<int> lists[LISTS];
+    for (int i = 0; i < LISTS; ++i)
+        for (int k = 0; k < 16; ++k) lists[i].add(k);
+    long before = Bench::residentKB();
+    Bench::Stopwatch watch;
+    long long hits = 0;
+    for (long long i = 0; i < total; ++i) hits += lists[i % LISTS].contains((int)(i % 20));
+    double seconds = watch.seconds();
+    Bench::keep(hits);
+    Bench::report("contains cycling over 16 lists, 1 thread", total, seconds);
+    std::printf("    RSS +%ld KB\n", Bench::residentKB() - before);
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * BlockingMpmcQueue throughput and push-to-pop latency at several producer/consumer
+ * counts, element by element and in batches of 32, against a Deque behind a mutex and
+ * condition variable. Every element carries its push time; consumers sample the latency
+ * of one element in 16 and the median, 99th and 99.9th percentiles are reported. On a
+ * machine with fewer cores than threads the figures are time-sliced.
+ *
+ *      g++ -std=c++11 -O2 -pthread -I. benchmarks/MpmcQueueBench.cpp -o MpmcQueueBench
+ */
+#include "MpmcQueue.h"
+#include "Deque.h"
+#include "Bench.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const int BATCH = 32, SAMPLE = 16;
+
+static long long now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * The baseline this queue replaces: a Deque, one lock, and two condition variables.
+ */
+class LockedQueue
+{
+    Deque<long long> deque;
+    std::mutex lock;
+    std::condition_variable notFull, notEmpty;
+    int limit;
+    bool closed;
+
+public:
+    LockedQueue(int limit):limit(limit), closed(false) {}
+
+    void push(long long e)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        while (deque.size() >= limit) notFull.wait(guard);
+        deque.addLast(e);
+        notEmpty.notify_one();
+    }
+
+    bool pop(long long& out)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        while (deque.isEmpty() && !closed) notEmpty.wait(guard);
+        if (deque.isEmpty()) return false;
+        out = deque.getFirst();
+        deque.removeFirst();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        closed = true;
+        notEmpty.notify_all();
+    }
+};
+
+/**
+ * Runs producers threads pushing perProducer timestamps each and consumers threads
+ * popping until the queue closes, then reports throughput and latency percentiles.
+ * Push(q, stamps, n) pushes n elements; Pop(q, out) pops up to BATCH and returns how many.
+ */
+template <class Q, class Push, class Pop>
+static void run(const char *name, Q& q, int producers, int consumers, long long perProducer, Push push, Pop pop)
+{
+    std::vector<std::vector<long long>> latencies(consumers);
+    std::vector<std::thread> producerThreads, consumerThreads;
+    Bench::Stopwatch watch;
+    for (int c = 0; c < consumers; ++c)
+        consumerThreads.push_back(std::thread([&, c]()
+        {
+            long long out[BATCH], seen = 0;
+            for (int k; (k = pop(q, out)) > 0;)
+                for (int j = 0; j < k; ++j)
+                    if (++seen % SAMPLE == 0) latencies[c].push_back(now() - out[j]);
+        }));
+    for (int p = 0; p < producers; ++p)
+        producerThreads.push_back(std::thread([&]()
+        {
+            long long stamps[BATCH];
+            for (long long i = 0; i < perProducer;)
+            {
+                int n = perProducer - i < BATCH ? (int)(perProducer - i) : BATCH;
+                long long t = now();
+                for (int j = 0; j < n; ++j) stamps[j] = t;
+                i += push(q, stamps, n);
+            }
+        }));
+    for (size_t t = 0; t < producerThreads.size(); ++t) producerThreads[t].join();
+    q.close();
+    for (size_t t = 0; t < consumerThreads.size(); ++t) consumerThreads[t].join();
+    double seconds = watch.seconds();
+
+    std::vector<long long> all;
+    for (int c = 0; c < consumers; ++c) all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+    std::sort(all.begin(), all.end());
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s, %dP/%dC", name, producers, consumers);
+    Bench::report(label, perProducer * producers, seconds);
+    if (!all.empty())
+        std::printf("    latency p50 %.1f us, p99 %.1f us, p99.9 %.1f us\n", all[all.size() / 2] / 1e3,
+                    all[all.size() * 99 / 100] / 1e3, all[all.size() * 999 / 1000] / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    long long total = (long long)(4000000 * Bench::scale(argc, argv));
+    const int shapes[][2] = { { 1, 1 }, { 2, 2 }, { 4, 4 }, { 1, 4 }, { 4, 1 } };
+    std::printf("%u hardware threads, %lld elements per case\n", std::thread::hardware_concurrency(), total);
+    for (const int *shape : shapes)
+    {
+        int producers = shape[0], consumers = shape[1];
+        long long perProducer = total / producers;
+        {
+            // single elements: each push carries one timestamp, taken just before it
+            BlockingMpmcQueue<long long> q(1024);
+            run("BlockingMpmcQueue push/pop", q, producers, consumers, perProducer,
+                [](BlockingMpmcQueue<long long>& q, long long *stamps, int n)
+                {
+                    for (int j = 0; j < n; ++j) q.push(stamps[j] = now());
+                    return n;
+                },
+                [](BlockingMpmcQueue<long long>& q, long long *out) { return q.pop(out[0]) ? 1 : 0; });
+        }
+        {
+            BlockingMpmcQueue<long long> q(1024);
+            run("BlockingMpmcQueue batches of 32", q, producers, consumers, perProducer,
+                [](BlockingMpmcQueue<long long>& q, long long *stamps, int n) { return q.pushBatch(stamps, n); },
+                [](BlockingMpmcQueue<long long>& q, long long *out) { return q.popBatch(out, BATCH); });
+        }
+        {
+            LockedQueue q(1024);
+            run("Deque + mutex + condvar", q, producers, consumers, perProducer,
+                [](LockedQueue& q, long long *stamps, int n)
+                {
+                    for (int j = 0; j < n; ++j) q.push(stamps[j] = now());
+                    return n;
+                },
+                [](LockedQueue& q, long long *out) { return q.pop(out[0]) ? 1 : 0; });
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file
+ * Node churn through LinkedList's slab pool against std::list, whose nodes are one
+ * new/delete each, with the resident memory each case adds. Every case runs in a forked
+ * child, so one case's freed memory does not flatter the next (Linux only).
+ *
+ *   - LRU: a list of 100K ints; each step adds one at the front and drops the last.
+ *   - shared: 1000 lists; each step moves an element from one random list to another,
+ *     the LinkedLists all allocating from one shared pool.
+ *   - fill/clear: 1M elements added and then cleared, repeatedly.
+ *   - short lists: 100K default lists of 4 elements; each step rotates a random list, the
+ *     memory showing what a short list costs beyond its nodes.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/NodeChurnBench.cpp -o NodeChurnBench
+ */
+#include "LinkedList.h"
+#include "Bench.h"
+#include <cstdio>
+#include <list>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static long long steps;
+
+/**
+ * Resident memory sampled by a case while its lists are at their largest.
+ */
+static long liveKB;
+
+template <class F>
+static void isolated(const char *name, F body)
+{
+    std::fflush(stdout);
+    pid_t child = fork();
+    if (child == 0)
+    {
+        long before = Bench::residentKB();
+        Bench::Stopwatch watch;
+        long long ops = body();
+        double seconds = watch.seconds();
+        Bench::report(name, ops, seconds);
+        std::printf("    RSS +%ld KB with the lists alive\n", liveKB - before);
+        std::fflush(stdout);
+        _exit(0);
+    }
+    waitpid(child, NULL, 0);
+}
+
+template <class L>
+static long long lru(L& list)
+{
+    const int SIZE = 100000;
+    for (int i = 0; i < SIZE; ++i) list.push_front(i);
+    for (long long i = 0; i < steps; ++i)
+    {
+        list.push_front((int)i);
+        list.pop_back();
+    }
+    liveKB = Bench::residentKB();
+    Bench::keep(list.front());
+    return steps;
+}
+
+template <class L>
+static long long shared(std::vector<L>& lists)
+{
+    Bench::Random random;
+    for (size_t i = 0; i < lists.size(); ++i)
+        for (int k = 0; k < 100; ++k) lists[i].push_back(k);
+    for (long long i = 0; i < steps; ++i)
+    {
+        L& from = lists[random.next() % lists.size()];
+        L& to = lists[random.next() % lists.size()];
+        if (from.empty()) continue;
+        to.push_back(from.front());
+        from.pop_front();
+    }
+    liveKB = Bench::residentKB();
+    return steps;
+}
+
+template <class L>
+static long long fillClear(L& list)
+{
+    const int SIZE = 1000000;
+    long long rounds = steps / SIZE + 1;
+    for (long long r = 0; r < rounds; ++r)
+    {
+        for (int i = 0; i < SIZE; ++i) list.push_back(i);
+        if (r == rounds - 1) liveKB = Bench::residentKB();
+        list.clear();
+    }
+    return rounds * SIZE;
+}
+
+template <class L>
+static long long shortLists(std::vector<L>& lists)
+{
+    Bench::Random random;
+    for (size_t i = 0; i < lists.size(); ++i)
+        for (int k = 0; k < 4; ++k) lists[i].push_back(k);
+    liveKB = Bench::residentKB();
+    for (long long i = 0; i < steps; ++i)
+    {
+        L& list = lists[random.next() % lists.size()];
+        list.push_back(list.front());
+        list.pop_front();
+    }
+    return steps;
+}
+
+/**
+ * LinkedList under std::list's names, so each case is one template for both.
+ */
+class PooledList
+{
+    LinkedList<int> list;
+
+public:
+    PooledList() {}
+    PooledList(LinkedList<int>::Pool& pool):list(pool) {}
+    PooledList(const PooledList& o):list(o.list) {}
+
+    void push_front(int x) { list.addFirst(x); }
+    void push_back(int x) { list.addLast(x); }
+    void pop_front() { list.removeFirst(); }
+    void pop_back() { list.removeLast(); }
+    int front() const { return list.getFirst(); }
+    bool empty() const { return list.isEmpty(); }
+    void clear() { list.clear(); }
+};
+
+int main(int argc, char **argv)
+{
+    steps = (long long)(20000000 * Bench::scale(argc, argv));
+    std::printf("%lld steps per case\n", steps);
+    isolated("LRU, LinkedList (pool)", []() { PooledList l; return lru(l); });
+    isolated("LRU, std::list (new/delete)", []() { std::list<int> l; return lru(l); });
+    isolated("1000 lists, LinkedList (one shared pool)", []()
+    {
+        LinkedList<int>::Pool pool;
+        std::vector<PooledList> lists(1000, PooledList(pool));
+        return shared(lists);
+    });
+    isolated("1000 lists, std::list (new/delete)", []()
+    {
+        std::vector<std::list<int>> lists(1000);
+        return shared(lists);
+    });
+    isolated("fill/clear 1M, LinkedList (pool)", []() { PooledList l; return fillClear(l); });
+    isolated("fill/clear 1M, std::list (new/delete)", []() { std::list<int> l; return fillClear(l); });
+    isolated("100K short lists, LinkedList (default)", []()
+    {
+        std::vector<PooledList> lists(100000);
+        return shortLists(lists);
+    });
+    isolated("100K short lists, std::list (new/delete)", []()
+    {
+        std::vector<std::list<int>> lists(100000);
+        return shortLists(lists);
+    });
+    return 0;
+}
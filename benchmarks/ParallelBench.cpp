@@ -0,0 +1,97 @@
+/**
+ * @file
+ * ArrayList::sort, parallelReduce and parallelTransform at 1 to 16 threads, and the
+ * per-call cost of running chunks on the shared pool against starting fresh threads.
+ * The default size is 10M elements; a scale of 10 gives the 100M-element run.
+ *
+ *      g++ -std=c++11 -O2 -pthread -I. benchmarks/ParallelBench.cpp -o ParallelBench
+ */
+#include "ArrayList.h"
+#include "Bench.h"
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static void fill(ArrayList<int>& list, int n)
+{
+    Bench::Random random;
+    list.clear();
+    list.reserve(n);
+    for (int i = 0; i < n; ++i) list.add((int)random.next());
+}
+
+/**
+ * The strategy the shared pool replaced: a std::thread per chunk, per call.
+ */
+template <class F>
+static void forPartsWithThreads(int n, int parts, F f)
+{
+    std::vector<std::thread> threads;
+    for (int p = 0; p < parts - 1; ++p)
+        threads.push_back(std::thread(f, p, (int)((long long)n * p / parts), (int)((long long)n * (p + 1) / parts)));
+    f(parts - 1, (int)((long long)n * (parts - 1) / parts), n);
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+}
+
+int main(int argc, char **argv)
+{
+    int n = (int)(10000000 * Bench::scale(argc, argv));
+    ArrayList<int> list;
+    char name[64];
+    for (int t = 1; t <= 16; t <<= 1)
+    {
+        fill(list, n);
+        {
+            Bench::Stopwatch watch;
+            list.sort([](int a, int b) { return a < b; }, t);
+            std::snprintf(name, sizeof(name), "sort n=%d threads=%d", n, t);
+            Bench::report(name, n, watch.seconds());
+        }
+        {
+            Bench::Stopwatch watch;
+            long long sum = list.parallelReduce(0, [](int a, int b) { return a ^ b; }, t);
+            Bench::keep(sum);
+            std::snprintf(name, sizeof(name), "reduce n=%d threads=%d", n, t);
+            Bench::report(name, n, watch.seconds());
+        }
+        {
+            Bench::Stopwatch watch;
+            list.parallelTransform([](int x) { return x * 2654435761u; }, t);
+            std::snprintf(name, sizeof(name), "transform n=%d threads=%d", n, t);
+            Bench::report(name, n, watch.seconds());
+        }
+    }
+
+    // many mid-sized calls, where starting threads would dominate
+    int mid = Parallel::GRAIN * 8, calls = 2000;
+    fill(list, mid);
+    const int *a = list.array();
+    for (int t = 2; t <= 8; t <<= 1)
+    {
+        {
+            Bench::Stopwatch watch;
+            for (int c = 0; c < calls; ++c)
+                Parallel::forParts(mid, t, [&](int, int from, int to)
+                {
+                    long long s = 0;
+                    for (int i = from; i < to; ++i) s += a[i];
+                    Bench::keep(s);
+                });
+            std::snprintf(name, sizeof(name), "sum n=%d parts=%d shared pool", mid, t);
+            Bench::report(name, (long long)mid * calls, watch.seconds());
+        }
+        {
+            Bench::Stopwatch watch;
+            for (int c = 0; c < calls; ++c)
+                forPartsWithThreads(mid, t, [&](int, int from, int to)
+                {
+                    long long s = 0;
+                    for (int i = from; i < to; ++i) s += a[i];
+                    Bench::keep(s);
+                });
+            std::snprintf(name, sizeof(name), "sum n=%d parts=%d thread per call", mid, t);
+            Bench::report(name, (long long)mid * calls, watch.seconds());
+        }
+    }
+    return 0;
+}
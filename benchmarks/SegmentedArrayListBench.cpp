@@ -0,0 +1,72 @@
+/**
+ * @file
+ * SegmentedArrayList against ArrayList: appending n ints and n 40-byte strings, where
+ * ArrayList relocates every element each time it doubles; random get; and a sequential
+ * sum through the iterator and, for SegmentedArrayList, forEachChunk.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/SegmentedArrayListBench.cpp -o SegmentedArrayListBench
+ */
+#include "SegmentedArrayList.h"
+#include "ArrayList.h"
+#include "Bench.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static const std::string PAYLOAD(40, 'x');
+
+template <template <class, int> class L, int P>
+static void run(const char *name, int n, const std::vector<int>& indices)
+{
+    char label[96];
+    long long sum = 0;
+    {
+        Bench::Stopwatch watch;
+        L<int, P> list;
+        for (int i = 0; i < n; ++i) list.add(i);
+        double seconds = watch.seconds();
+        std::snprintf(label, sizeof(label), "%s append int", name);
+        Bench::report(label, n, seconds);
+
+        watch = Bench::Stopwatch();
+        for (size_t i = 0; i < indices.size(); ++i) sum += list.get(indices[i]);
+        std::snprintf(label, sizeof(label), "%s random get", name);
+        Bench::report(label, (long long)indices.size(), watch.seconds());
+
+        watch = Bench::Stopwatch();
+        for (typename L<int, P>::Iterator itr = list.iterator(); itr.hasNext();) sum += itr.next();
+        std::snprintf(label, sizeof(label), "%s iterate", name);
+        Bench::report(label, n, watch.seconds());
+    }
+    {
+        Bench::Stopwatch watch;
+        L<std::string, P> list;
+        for (int i = 0; i < n; ++i) list.add(PAYLOAD);
+        std::snprintf(label, sizeof(label), "%s append string", name);
+        Bench::report(label, n, watch.seconds());
+    }
+    Bench::keep(sum);
+}
+
+int main(int argc, char **argv)
+{
+    int n = (int)(4000000 * Bench::scale(argc, argv));
+    std::vector<int> indices(n);
+    Bench::Random random;
+    for (int i = 0; i < n; ++i) indices[i] = (int)(random.next() % (unsigned)n);
+    std::printf("%d elements\n", n);
+    run<ArrayList, 0>("ArrayList", n, indices);
+    run<SegmentedArrayList, 10>("SegmentedArrayList", n, indices);
+
+    SegmentedArrayList<int> list;
+    for (int i = 0; i < n; ++i) list.add(i);
+    Bench::Stopwatch watch;
+    long long sum = 0;
+    list.forEachChunk([&](const int *chunk, int k)
+    {
+        for (int i = 0; i < k; ++i) sum += chunk[i];
+    });
+    Bench::keep(sum);
+    Bench::report("SegmentedArrayList forEachChunk", n, watch.seconds());
+    return 0;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file
+ * Iterating many short lists: 100K LinkedLists and PriorityQueues of 0 to 8 ints each,
+ * every one walked with a fresh iterator, against std::list. A fourth case adds the two
+ * allocations (a sentinel node and a default T) the iterators used to make per walk, to
+ * show what creating an iterator used to cost. An op is one list walked.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/ShortListIterateBench.cpp -o ShortListIterateBench
+ */
+#include "LinkedList.h"
+#include "PriorityQueue.h"
+#include "Bench.h"
+#include <list>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    double scale = Bench::scale(argc, argv);
+    const int LISTS = 100000, MAXLEN = 8;
+    int passes = (int)(50 * scale) + 1;
+    Bench::Random random;
+    std::vector<LinkedList<int>> lists(LISTS);
+    std::vector<PriorityQueue<int>> queues(LISTS);
+    std::vector<std::list<int>> stdLists(LISTS);
+    long long elements = 0;
+    for (int i = 0; i < LISTS; ++i)
+        for (int n = (int)(random.next() % (MAXLEN + 1)), k = 0; k < n; ++k, ++elements)
+        {
+            int v = (int)(random.next() & 1023);
+            lists[i].addLast(v), queues[i].push(v), stdLists[i].push_back(v);
+        }
+    std::printf("%d lists, %lld elements, %d passes\n", LISTS, elements, passes);
+    long long ops = (long long)LISTS * passes, sum = 0;
+
+    Bench::Stopwatch linked;
+    for (int p = 0; p < passes; ++p)
+        for (int i = 0; i < LISTS; ++i)
+            for (LinkedList<int>::Iterator itr = lists[i].iterator(); itr.hasNext();) sum += itr.next();
+    Bench::report("LinkedList::Iterator", ops, linked.seconds());
+
+    Bench::Stopwatch queue;
+    for (int p = 0; p < passes; ++p)
+        for (int i = 0; i < LISTS; ++i)
+            for (PriorityQueue<int>::Iterator itr = queues[i].iterator(); itr.hasNext();) sum += itr.next();
+    Bench::report("PriorityQueue::Iterator", ops, queue.seconds());
+
+    Bench::Stopwatch standard;
+    for (int p = 0; p < passes; ++p)
+        for (int i = 0; i < LISTS; ++i)
+            for (int x : stdLists[i]) sum += x;
+    Bench::report("std::list range-for", ops, standard.seconds());
+
+    Bench::Stopwatch legacy;
+    for (int p = 0; p < passes; ++p)
+        for (int i = 0; i < LISTS; ++i)
+        {
+            // the sentinel node and default T that the old iterator allocated and freed
+            void *sentinel = ::operator new(sizeof(int) + 2 * sizeof(void *));
+            int *dummy = new int();
+            Bench::keep(sentinel), Bench::keep(dummy);
+            for (LinkedList<int>::Iterator itr = lists[i].iterator(); itr.hasNext();) sum += itr.next();
+            delete dummy;
+            ::operator delete(sentinel);
+        }
+    Bench::report("LinkedList + old per-iterator allocations", ops, legacy.seconds());
+    Bench::keep(sum);
+    return 0;
+}
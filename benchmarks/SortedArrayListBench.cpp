@@ -0,0 +1,64 @@
+/**
+ * @file
+ * Builds a sorted list of random ints three ways: inserting each element at its
+ * upperBound in a plain ArrayList, which shifts the tail every time; SortedArrayList::add,
+ * which inserts into the side buffer and merges it every sqrt(n) elements; and
+ * SortedArrayList::addAll in batches of 1000. A last case interleaves contains with add,
+ * so that lookups hit a partly full buffer.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/SortedArrayListBench.cpp -o SortedArrayListBench
+ */
+#include "SortedArrayList.h"
+#include "Bench.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    int n = (int)(200000 * Bench::scale(argc, argv));
+    std::vector<int> input(n);
+    Bench::Random random;
+    for (int i = 0; i < n; ++i) input[i] = (int)(random.next() >> 1);
+    std::printf("%d random ints\n", n);
+    {
+        Bench::Stopwatch watch;
+        ArrayList<int> list;
+        for (int i = 0; i < n; ++i) list.add(list.upperBound(input[i], Less<int>()), input[i]);
+        double seconds = watch.seconds();
+        Bench::keep(list.get(n / 2));
+        Bench::report("ArrayList insert at upperBound", n, seconds);
+    }
+    {
+        Bench::Stopwatch watch;
+        SortedArrayList<int> list;
+        for (int i = 0; i < n; ++i) list.add(input[i]);
+        list.flush();
+        double seconds = watch.seconds();
+        Bench::keep(list.get(n / 2));
+        Bench::report("SortedArrayList add", n, seconds);
+    }
+    {
+        const int BATCH = 1000;
+        Bench::Stopwatch watch;
+        SortedArrayList<int> list;
+        for (int i = 0; i < n; i += BATCH) list.addAll(input.begin() + i, input.begin() + std::min(n, i + BATCH));
+        double seconds = watch.seconds();
+        Bench::keep(list.get(n / 2));
+        Bench::report("SortedArrayList addAll, batches of 1000", n, seconds);
+    }
+    {
+        Bench::Stopwatch watch;
+        SortedArrayList<int> list;
+        long long hits = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            list.add(input[i]);
+            hits += list.contains(input[i / 2]);
+        }
+        double seconds = watch.seconds();
+        Bench::keep(hits);
+        Bench::report("SortedArrayList add + contains", 2LL * n, seconds);
+    }
+    return 0;
+}
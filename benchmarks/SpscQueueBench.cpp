@@ -0,0 +1,133 @@
+/**
+ * @file
+ * SpscQueue throughput between a producer and a consumer thread, element by element and
+ * in batches, against a Deque behind a mutex. A side that finds the queue full or empty
+ * yields. Pin the process to two cores on different physical CPUs for the cross-core
+ * figure, e.g. taskset -c 0,2. An op is one element pushed and popped.
+ *
+ *      g++ -std=c++11 -O2 -pthread -I. benchmarks/SpscQueueBench.cpp -o SpscQueueBench
+ */
+#include "SpscQueue.h"
+#include "Deque.h"
+#include "Bench.h"
+#include <mutex>
+#include <thread>
+
+static const int BATCH = 64;
+
+static void single(long long n)
+{
+    SpscQueue<long long> q(4096);
+    Bench::Stopwatch watch;
+    std::thread producer([&]()
+    {
+        for (long long i = 0; i < n;)
+            if (q.tryPush(i)) ++i;
+            else std::this_thread::yield();
+    });
+    long long sum = 0, v;
+    for (long long i = 0; i < n;)
+        if (q.tryPop(v)) sum += v, ++i;
+        else std::this_thread::yield();
+    producer.join();
+    Bench::keep(sum);
+    Bench::report("SpscQueue tryPush/tryPop", n, watch.seconds());
+}
+
+static void batched(long long n)
+{
+    SpscQueue<long long> q(4096);
+    Bench::Stopwatch watch;
+    std::thread producer([&]()
+    {
+        long long items[BATCH];
+        for (long long i = 0; i < n;)
+        {
+            int k = n - i < BATCH ? (int)(n - i) : BATCH;
+            for (int j = 0; j < k; ++j) items[j] = i + j;
+            int pushed = q.tryPushBatch(items, k);
+            if (pushed == 0) std::this_thread::yield();
+            i += pushed;
+        }
+    });
+    long long sum = 0, out[BATCH];
+    for (long long i = 0; i < n;)
+    {
+        int k = q.tryPopBatch(out, BATCH);
+        if (k == 0) std::this_thread::yield();
+        for (int j = 0; j < k; ++j) sum += out[j];
+        i += k;
+    }
+    producer.join();
+    Bench::keep(sum);
+    Bench::report("SpscQueue batches of 64", n, watch.seconds());
+}
+
+static void locked(long long n)
+{
+    Deque<long long> q;
+    std::mutex lock;
+    Bench::Stopwatch watch;
+    std::thread producer([&]()
+    {
+        for (long long i = 0; i < n; ++i)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            q.addLast(i);
+        }
+    });
+    long long sum = 0;
+    for (long long i = 0; i < n;)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!q.isEmpty())
+        {
+            sum += q.getFirst();
+            q.removeFirst();
+            ++i;
+        }
+    }
+    producer.join();
+    Bench::keep(sum);
+    Bench::report("Deque + mutex", n, watch.seconds());
+}
+
+/**
+ * Push and pop on one thread: the per-operation cost without any cache-line transfer,
+ * an upper bound for the two-thread figures.
+ */
+static void sameThread(long long n)
+{
+    SpscQueue<long long> q(4096);
+    long long sum = 0, v = 0, items[BATCH], out[BATCH];
+    Bench::Stopwatch watch;
+    for (long long i = 0; i < n; ++i)
+    {
+        q.tryPush(i);
+        q.tryPop(v);
+        sum += v;
+    }
+    Bench::report("one thread, tryPush + tryPop", n, watch.seconds());
+    Bench::Stopwatch batchWatch;
+    for (long long i = 0; i < n; i += BATCH)
+    {
+        for (int j = 0; j < BATCH; ++j) items[j] = i + j;
+        q.tryPushBatch(items, BATCH);
+        q.tryPopBatch(out, BATCH);
+        sum += out[0];
+    }
+    Bench::report("one thread, batches of 64", n, batchWatch.seconds());
+    Bench::keep(sum);
+}
+
+int main(int argc, char **argv)
+{
+    long long n = (long long)(100000000 * Bench::scale(argc, argv));
+    unsigned cores = std::thread::hardware_concurrency();
+    std::printf("%u hardware threads%s\n", cores, cores < 2 ? "; the two-thread figures are time-sliced, not cross-core" : "");
+    sameThread(n);
+    single(n);
+    batched(n);
+    locked(n / 10);
+    return 0;
+}
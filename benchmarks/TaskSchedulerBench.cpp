@@ -0,0 +1,84 @@
+/**
+ * @file
+ * Fork-join parallel sum over an ArrayList on TaskScheduler pools of 1 to 16 workers,
+ * against a sequential loop, and the raw cost of spawning and waiting for empty tasks.
+ * The range is split in halves down to leaves of GRAIN elements; the caller runs one half
+ * itself and waits for the other, which idle workers steal. The default size is 50M
+ * elements; on a machine with fewer cores than workers the extra workers only time-slice.
+ *
+ *      g++ -std=c++11 -O2 -pthread -I. benchmarks/TaskSchedulerBench.cpp -o TaskSchedulerBench
+ */
+#include "TaskScheduler.h"
+#include "ArrayList.h"
+#include "Bench.h"
+#include <cstdio>
+#include <thread>
+
+static const int GRAIN = 1 << 14;
+
+static long long sequentialSum(const int *a, int from, int to)
+{
+    long long s = 0;
+    for (int i = from; i < to; ++i) s += a[i];
+    return s;
+}
+
+static long long forkJoinSum(TaskScheduler& pool, const int *a, int from, int to)
+{
+    if (to - from <= GRAIN) return sequentialSum(a, from, to);
+    int mid = from + (to - from) / 2;
+    TaskScheduler::Counter done;
+    long long left = 0;
+    pool.spawn(done, [&]() { left = forkJoinSum(pool, a, from, mid); });
+    long long right = forkJoinSum(pool, a, mid, to);
+    pool.wait(done);
+    return left + right;
+}
+
+int main(int argc, char **argv)
+{
+    double scale = Bench::scale(argc, argv);
+    int n = (int)(50000000 * scale), reps = 5;
+    std::printf("%u hardware threads, %d elements\n", std::thread::hardware_concurrency(), n);
+    ArrayList<int> list;
+    list.reserve(n);
+    Bench::Random random;
+    for (int i = 0; i < n; ++i) list.add((int)(random.next() & 1023));
+    const int *a = &list.get(0);
+
+    long long expected = 0;
+    Bench::Stopwatch watch;
+    for (int r = 0; r < reps; ++r) expected += sequentialSum(a, 0, n);
+    double base = watch.seconds();
+    Bench::report("sequential sum", (long long)n * reps, base);
+
+    char name[64];
+    const int threads[] = { 1, 2, 4, 8, 16 };
+    for (int t : threads)
+    {
+        TaskScheduler pool(t);
+        long long total = 0;
+        Bench::Stopwatch forkJoin;
+        for (int r = 0; r < reps; ++r) total += forkJoinSum(pool, a, 0, n);
+        double seconds = forkJoin.seconds();
+        if (total != expected) std::printf("WRONG SUM\n");
+        std::snprintf(name, sizeof(name), "fork-join sum, %2d workers", t);
+        Bench::report(name, (long long)n * reps, seconds);
+        std::printf("    speedup over sequential %.2fx\n", base / seconds);
+    }
+
+    // scheduling overhead: empty tasks spawned from inside the pool and stolen or run back
+    TaskScheduler pool(2);
+    int tasks = (int)(1000000 * scale);
+    TaskScheduler::Counter outer;
+    Bench::Stopwatch spawnWatch;
+    pool.spawn(outer, [&]()
+    {
+        TaskScheduler::Counter done;
+        for (int i = 0; i < tasks; ++i) pool.spawn(done, []() {});
+        pool.wait(done);
+    });
+    pool.wait(outer);
+    Bench::report("spawn + run empty task, 2 workers", tasks, spawnWatch.seconds());
+    return 0;
+}
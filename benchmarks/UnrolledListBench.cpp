@@ -0,0 +1,71 @@
+/**
+ * @file
+ * UnrolledLinkedList<int> with 32 and 64 elements per node against LinkedList<int>:
+ * building by addLast, a full scan through the iterator, a contains() miss, inserts and
+ * removals at random positions, and removing every other element through an iterator.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/UnrolledListBench.cpp -o UnrolledListBench
+ */
+#include "UnrolledLinkedList.h"
+#include "LinkedList.h"
+#include "Bench.h"
+#include <cstdio>
+
+template <class L>
+static void run(const char *label, int n, int positional)
+{
+    char name[96];
+    L list;
+    Bench::Stopwatch build;
+    for (int i = 0; i < n; ++i) list.addLast(i);
+    std::snprintf(name, sizeof(name), "%s addLast", label);
+    Bench::report(name, n, build.seconds());
+
+    const int SCANS = 10;
+    long long sum = 0;
+    Bench::Stopwatch scan;
+    for (int s = 0; s < SCANS; ++s)
+        for (typename L::Iterator itr = list.iterator(); itr.hasNext();) sum += itr.next();
+    std::snprintf(name, sizeof(name), "%s iterator scan", label);
+    Bench::report(name, (long long)n * SCANS, scan.seconds());
+
+    Bench::Stopwatch miss;
+    for (int s = 0; s < SCANS; ++s) sum += list.contains(-1);
+    std::snprintf(name, sizeof(name), "%s contains (miss)", label);
+    Bench::report(name, (long long)n * SCANS, miss.seconds());
+
+    // positional operations walk to a random index, so they get fewer repetitions
+    Bench::Random random;
+    Bench::Stopwatch insert;
+    for (int k = 0; k < positional; ++k)
+    {
+        list.add((int)(random.next() % (unsigned)(list.size() + 1)), k);
+        list.removeIndex((int)(random.next() % (unsigned)list.size()));
+    }
+    double seconds = insert.seconds();
+    std::snprintf(name, sizeof(name), "%s add + removeIndex at random", label);
+    Bench::report(name, 2LL * positional, seconds);
+    std::printf("    %.2f us per operation\n", seconds * 1e6 / (2.0 * positional));
+
+    Bench::Stopwatch erase;
+    typename L::Iterator itr = list.iterator();
+    for (bool drop = false; itr.hasNext(); drop = !drop)
+    {
+        itr.next();
+        if (drop) itr.remove();
+    }
+    std::snprintf(name, sizeof(name), "%s Iterator::remove every other", label);
+    Bench::report(name, n, erase.seconds());
+    Bench::keep(sum);
+}
+
+int main(int argc, char **argv)
+{
+    double scale = Bench::scale(argc, argv);
+    int n = (int)(1000000 * scale), positional = (int)(500 * scale) + 1;
+    std::printf("%d elements\n", n);
+    run<LinkedList<int>>("LinkedList", n, positional);
+    run<UnrolledLinkedList<int, 32>>("Unrolled<32>", n, positional);
+    run<UnrolledLinkedList<int, 64>>("Unrolled<64>", n, positional);
+    return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file
+ * Membership scans (contains of an absent key, so every element is compared) over
+ * ArrayList<int> and ArrayList<float> from 16 to 16M elements, vector kernel against the
+ * scalar loop. Build with and without -mavx2 to compare AVX2 with SSE2.
+ *
+ *      g++ -std=c++11 -O2 -I. benchmarks/VectorScanBench.cpp -o VectorScanBench
+ */
+#include "ArrayList.h"
+#include "Bench.h"
+#include <cstdio>
+
+template <class T>
+static void run(const char *type, double scale)
+{
+    for (long long n = 16; n <= 16 * 1024 * 1024; n *= 4)
+    {
+        ArrayList<T> list;
+        for (long long i = 0; i < n; ++i) list.add((T)(i % 1000));
+        const T *p = list.array();
+        long long rounds = (long long)(64 * 1024 * 1024 * scale / n) + 1;
+        char name[64];
+        {
+            Bench::Stopwatch watch;
+            int found = 0;
+            for (long long r = 0; r < rounds; ++r) found += VectorScan::Scalar<T>::indexOf(p, (int)n, (T)-1) != -1;
+            Bench::keep(found);
+            std::snprintf(name, sizeof(name), "%s scalar n=%lld", type, n);
+            Bench::report(name, n * rounds, watch.seconds());
+        }
+        {
+            Bench::Stopwatch watch;
+            int found = 0;
+            for (long long r = 0; r < rounds; ++r) found += list.contains((T)-1);
+            Bench::keep(found);
+            std::snprintf(name, sizeof(name), "%s contains n=%lld", type, n);
+            Bench::report(name, n * rounds, watch.seconds());
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    double scale = Bench::scale(argc, argv);
+    run<int>("int", scale);
+    run<float>("float", scale);
+    return 0;
+}
@@ -0,0 +1,504 @@
+/**
+ * @file
+ * Randomized differential tests for ArrayList against std::vector, including the bulk
+ * operations and Iterator::remove(): every other method is called while an iterator
+ * holds a gap of removed slots open, iterators are abandoned halfway, and const readers
+ * run on two threads around an open gap.
+ *
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=address,undefined -I. tests/ArrayListTest.cpp -o ArrayListTest
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=thread -I. tests/ArrayListTest.cpp -o ArrayListTest
+ */
+#include "ArrayList.h"
+#include "Less.h"
+#include "Check.h"
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Counts copies and live objects, to check that moves do not copy and nothing leaks.
+ */
+class Tracked
+{
+public:
+    static int copies, live;
+    std::string value;
+
+    Tracked(const std::string& value = ""):value(value) { ++live; }
+    Tracked(const Tracked& x):value(x.value) { ++live, ++copies; }
+    Tracked(Tracked&& x):value(std::move(x.value)) { ++live; }
+    Tracked& operator=(const Tracked& x) { value = x.value, ++copies; return *this; }
+    Tracked& operator=(Tracked&& x) { value = std::move(x.value); return *this; }
+    ~Tracked() { --live; }
+    bool operator==(const Tracked& x) const { return value == x.value; }
+};
+
+int Tracked::copies = 0;
+int Tracked::live = 0;
+
+template <class L>
+static void same(L& list, const std::vector<std::string>& ref)
+{
+    CHECK(list.size() == (int)ref.size());
+    for (int i = 0; i < (int)ref.size(); ++i) CHECK(list.get(i).value == ref[i]);
+}
+
+template <int N>
+static void testDifferential()
+{
+    TestRandom random(N + 1);
+    ArrayList<Tracked, N> list;
+    std::vector<std::string> ref;
+    for (int step = 0; step < 20000; ++step)
+    {
+        std::string s = std::to_string(random.below(1000));
+        int n = (int)ref.size();
+        switch (random.below(10))
+        {
+        case 0:
+            list.add(Tracked(s)), ref.push_back(s);
+            break;
+        case 1:
+            list.emplace(s), ref.push_back(s);
+            break;
+        case 2:
+        {
+            int i = random.below(n + 1);
+            list.emplaceAt(i, s), ref.insert(ref.begin() + i, s);
+            break;
+        }
+        case 3:
+            if (n > 0)
+            {
+                // the argument aliases an element that growth may relocate
+                int i = random.below(n);
+                list.add(list.get(i));
+                ref.push_back(ref[i]);
+            }
+            break;
+        case 4:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                list.removeIndex(i), ref.erase(ref.begin() + i);
+            }
+            break;
+        case 5:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                list.set(i, Tracked(s)), ref[i] = s;
+            }
+            break;
+        case 6:
+        {
+            ArrayList<Tracked, N> moved(std::move(list));
+            CHECK(list.size() == 0);
+            list = std::move(moved);
+            CHECK(moved.size() == 0);
+            break;
+        }
+        case 7:
+        {
+            ArrayList<Tracked, N> other;
+            for (int i = random.below(8); i > 0; --i) other.add(Tracked("x"));
+            std::vector<std::string> otherRef(other.size(), "x");
+            list.swap(other);
+            same(list, otherRef);
+            same(other, ref);
+            other.swap(list);
+            break;
+        }
+        case 8:
+        {
+            ArrayList<Tracked, N> copy(list);
+            same(copy, ref);
+            copy = list;
+            same(copy, ref);
+            break;
+        }
+        case 9:
+            if (random.below(50) == 0) list.clear(), ref.clear();
+            break;
+        }
+        if (step % 97 == 0) same(list, ref);
+    }
+    same(list, ref);
+}
+
+/**
+ * Converts between the test values and the element types under test, and combines
+ * elements for parallelReduce in an order-sensitive way where the type allows.
+ */
+template <class T>
+class Elem
+{
+public:
+    static int of(int v) { return v; }
+    static int value(int x) { return x; }
+    static int identity() { return 0; }
+    static int join(int a, int b) { return a + b; }
+};
+
+template <>
+class Elem<Tracked>
+{
+public:
+    static Tracked of(int v) { return Tracked(std::to_string(v)); }
+    static int value(const Tracked& x) { return std::stoi(x.value); }
+    static Tracked identity() { return Tracked(); }
+    static Tracked join(const Tracked& a, const Tracked& b)
+    {
+        return a.value.empty() ? b : b.value.empty() ? a : Tracked(a.value + "," + b.value);
+    }
+};
+
+/**
+ * Checks list against ref through const methods only, so that an open gap stays open.
+ */
+template <class T, int N>
+static void sameConst(const ArrayList<T, N>& list, const std::vector<int>& ref)
+{
+    CHECK(list.size() == (int)ref.size() && list.isEmpty() == ref.empty());
+    ArrayList<T, N> copy(list);
+    CHECK(copy.size() == (int)ref.size());
+    for (int i = 0; i < (int)ref.size(); ++i) CHECK(Elem<T>::value(copy.get(i)) == ref[i]);
+}
+
+template <class T, int N>
+static void sameValues(ArrayList<T, N>& list, const std::vector<int>& ref)
+{
+    CHECK(list.size() == (int)ref.size());
+    for (int i = 0; i < (int)ref.size(); ++i) CHECK(Elem<T>::value(list.get(i)) == ref[i]);
+}
+
+/**
+ * Calls a random const method of list while an iterator may hold a gap open, and
+ * checks the result against ref. The list must be unchanged afterwards.
+ */
+template <class T, int N>
+static void readConst(const ArrayList<T, N>& list, const std::vector<int>& ref, TestRandom& random)
+{
+    int v = random.below(40);
+    T e = Elem<T>::of(v);
+    std::vector<int>::const_iterator first = std::find(ref.begin(), ref.end(), v);
+    std::vector<int>::const_reverse_iterator last = std::find(ref.rbegin(), ref.rend(), v);
+    switch (random.below(6))
+    {
+    case 0:
+        CHECK(list.contains(e) == (first != ref.end()));
+        break;
+    case 1:
+        CHECK(list.indexOf(e) == (first == ref.end() ? -1 : (int)(first - ref.begin())));
+        break;
+    case 2:
+        CHECK(list.lastIndexOf(e) == (last == ref.rend() ? -1 : (int)(ref.rend() - last) - 1));
+        break;
+    case 3:
+        CHECK(list.count(e) == (int)std::count(ref.begin(), ref.end(), v));
+        break;
+    case 4:
+    {
+        T expected = Elem<T>::identity();
+        for (int i = 0; i < (int)ref.size(); ++i) expected = Elem<T>::join(expected, Elem<T>::of(ref[i]));
+        CHECK(list.parallelReduce(Elem<T>::identity(), Elem<T>::join, 1 + random.below(3)) == expected);
+        break;
+    }
+    case 5:
+    {
+        ArrayList<T, N> other;
+        other.add(Elem<T>::of(-1));
+        other.addAll(random.below(2), list);
+        std::vector<int> otherRef(1, -1);
+        otherRef.insert(otherRef.begin() + (other.get(0) == Elem<T>::of(-1) ? 1 : 0), ref.begin(), ref.end());
+        sameValues(other, otherRef);
+        other = list;
+        sameValues(other, ref);
+        break;
+    }
+    }
+}
+
+/**
+ * Calls a random non-const method of list, mirrored on ref. The iterators of list must
+ * not be used afterwards.
+ */
+template <class T, int N>
+static void modify(ArrayList<T, N>& list, std::vector<int>& ref, TestRandom& random)
+{
+    int n = (int)ref.size(), v = random.below(40);
+    switch (random.below(11))
+    {
+    case 0:
+        list.add(Elem<T>::of(v)), ref.push_back(v);
+        break;
+    case 1:
+    {
+        int i = random.below(n + 1);
+        list.add(i, Elem<T>::of(v)), ref.insert(ref.begin() + i, v);
+        break;
+    }
+    case 2:
+        if (n > 0)
+        {
+            int i = random.below(n);
+            CHECK(Elem<T>::value(list.get(i)) == ref[i]);
+            list.set(i, Elem<T>::of(v)), ref[i] = v;
+        }
+        break;
+    case 3:
+        if (n > 0)
+        {
+            int i = random.below(n);
+            list.removeIndex(i), ref.erase(ref.begin() + i);
+        }
+        break;
+    case 4:
+    {
+        std::vector<int>::iterator i = std::find(ref.begin(), ref.end(), v);
+        CHECK(list.remove(Elem<T>::of(v)) == (i != ref.end()));
+        if (i != ref.end()) ref.erase(i);
+        break;
+    }
+    case 5:
+    {
+        // the list inserted into itself
+        int i = random.below(n + 1);
+        std::vector<int> copy(ref);
+        list.addAll(i, list), ref.insert(ref.begin() + i, copy.begin(), copy.end());
+        break;
+    }
+    case 6:
+    {
+        std::vector<T> extra;
+        for (int k = random.below(6); k > 0; --k) extra.push_back(Elem<T>::of(random.below(40)));
+        int i = random.below(n + 1);
+        list.addAll(i, extra.begin(), extra.end());
+        for (int k = 0; k < (int)extra.size(); ++k) ref.insert(ref.begin() + i + k, Elem<T>::value(extra[k]));
+        break;
+    }
+    case 7:
+    {
+        // empty and whole ranges as often as any other
+        int from, to;
+        switch (random.below(3))
+        {
+        case 0: from = to = random.below(n + 1); break;
+        case 1: from = 0, to = n; break;
+        default: from = random.below(n + 1), to = from + random.below(n - from + 1); break;
+        }
+        list.removeRange(from, to), ref.erase(ref.begin() + from, ref.begin() + to);
+        CHECK_THROWS(IndexOutOfBound, list.removeRange(0, (int)ref.size() + 1));
+        break;
+    }
+    case 8:
+    {
+        int mode = random.below(3), threshold = random.below(40);
+        struct Pred
+        {
+            int mode, threshold;
+            bool operator()(const T& x) const { return mode == 0 ? false : mode == 1 ? true : Elem<T>::value(x) < threshold; }
+        } pred = { mode, threshold };
+        int before = (int)ref.size();
+        for (std::vector<int>::iterator i = ref.begin(); i != ref.end();)
+            if (mode == 1 || (mode == 2 && *i < threshold)) i = ref.erase(i);
+            else ++i;
+        CHECK(list.removeIf(pred) == before - (int)ref.size());
+        break;
+    }
+    case 9:
+    {
+        struct Less
+        {
+            bool operator()(const T& a, const T& b) const { return Elem<T>::value(a) < Elem<T>::value(b); }
+        };
+        list.sort(Less(), 1);
+        std::stable_sort(ref.begin(), ref.end());
+        break;
+    }
+    case 10:
+    {
+        ArrayList<T, N> moved(std::move(list));
+        list.swap(moved);
+        break;
+    }
+    }
+}
+
+/**
+ * Iterates list, removing at random, and between steps reads it through its const
+ * methods or modifies it; the iterator is abandoned after a modification or at a random
+ * point, and otherwise runs to the end.
+ */
+template <class T, int N>
+static void testGap(unsigned long long seed)
+{
+    TestRandom random(seed);
+    ArrayList<T, N> list;
+    std::vector<int> ref;
+    for (int round = 0; round < 3000; ++round)
+    {
+        while ((int)ref.size() < 5 + random.below(60))
+        {
+            int v = random.below(40);
+            list.add(Elem<T>::of(v)), ref.push_back(v);
+        }
+        int removeEvery = 1 + random.below(4), stopAt = random.below(4) == 0 ? random.below((int)ref.size() + 1) : -1;
+        bool modified = false;
+        {
+            typename ArrayList<T, N>::Iterator itr = list.iterator();
+            int position = -1;
+            for (int steps = 0; itr.hasNext() && (steps != stopAt); ++steps)
+            {
+                CHECK(Elem<T>::value(itr.next()) == ref[++position]);
+                if (random.below(removeEvery) == 0)
+                {
+                    itr.remove();
+                    ref.erase(ref.begin() + position--);
+                    CHECK_THROWS(ElementNotExist, itr.remove());
+                }
+                if (random.below(8) == 0) readConst<T, N>(list, ref, random);
+                if (random.below(30) == 0)
+                {
+                    modify(list, ref, random);
+                    modified = true;
+                    break;
+                }
+            }
+            if (!modified && (stopAt == -1))
+            {
+                CHECK(position == (int)ref.size() - 1);
+                CHECK_THROWS(ElementNotExist, itr.next());
+                // reaching the end compacted the list, so the const view is contiguous
+                const ArrayList<T, N>& c = list;
+                for (int i = 0; i < (int)ref.size(); ++i) CHECK(Elem<T>::value(c.array()[i]) == ref[i]);
+            }
+            sameConst(list, ref);
+        }
+        sameValues(list, ref);
+        if (random.below(4) == 0) modify(list, ref, random);
+        if (ref.size() > 200) list.clear(), ref.clear();
+    }
+    sameValues(list, ref);
+}
+
+/**
+ * Sorted lookups around an open gap.
+ */
+static void testGapSorted()
+{
+    TestRandom random(11);
+    for (int round = 0; round < 500; ++round)
+    {
+        ArrayList<int> list;
+        std::vector<int> ref;
+        for (int i = random.below(50); i > 0; --i) ref.push_back(random.below(30));
+        std::sort(ref.begin(), ref.end());
+        list.addAll(0, ref.begin(), ref.end());
+        ArrayList<int>::Iterator itr = list.iterator();
+        int position = -1, stop = random.below((int)ref.size() + 1);
+        for (int steps = 0; steps < stop; ++steps)
+        {
+            itr.next(), ++position;
+            if (random.below(2) == 0) itr.remove(), ref.erase(ref.begin() + position--);
+        }
+        const ArrayList<int>& c = list;
+        for (int v = -1; v <= 31; ++v)
+        {
+            int lower = (int)(std::lower_bound(ref.begin(), ref.end(), v) - ref.begin());
+            int upper = (int)(std::upper_bound(ref.begin(), ref.end(), v) - ref.begin());
+            CHECK(c.lowerBound(v, Less<int>()) == lower && c.upperBound(v, Less<int>()) == upper);
+            CHECK(c.binarySearch(v, Less<int>()) == (lower == upper ? -1 : lower));
+        }
+    }
+}
+
+/**
+ * Two threads read a list through const methods while an iterator, paused, holds a gap
+ * open. The readers must not write to the list.
+ */
+static void testConcurrentReaders()
+{
+    ArrayList<int> list;
+    std::vector<int> ref;
+    for (int i = 0; i < 1000; ++i) list.add(i % 100);
+    ArrayList<int>::Iterator itr = list.iterator();
+    for (int i = 0; i < 500; ++i)
+    {
+        itr.next();
+        if (i % 3 == 0) itr.remove();
+        else ref.push_back(i % 100);
+    }
+    for (int i = 500; i < 1000; ++i) ref.push_back(i % 100);
+    const ArrayList<int>& c = list;
+    std::thread readers[2];
+    for (int t = 0; t < 2; ++t)
+        readers[t] = std::thread([&]()
+        {
+            for (int k = 0; k < 200; ++k)
+            {
+                TestRandom random(k + 1);
+                sameConst(c, ref);
+                readConst(c, ref, random);
+                std::this_thread::yield();
+            }
+        });
+    for (int t = 0; t < 2; ++t) readers[t].join();
+    while (itr.hasNext()) itr.next();
+    sameValues(list, ref);
+}
+
+static void testMovesDoNotCopy()
+{
+    ArrayList<Tracked> list;
+    for (int i = 0; i < 1000; ++i) list.add(Tracked(std::to_string(i)));
+    for (int i = 0; i < 100; ++i) list.emplaceAt(0, "front");
+    Tracked::copies = 0;
+    ArrayList<Tracked> moved(std::move(list));
+    ArrayList<Tracked> assigned;
+    assigned = std::move(moved);
+    assigned.swap(list);
+    CHECK(Tracked::copies == 0);
+    CHECK(list.size() == 1100);
+    CHECK(list.get(0).value == "front");
+    CHECK(list.get(1099).value == "999");
+
+    ArrayList<Tracked, 16> small;
+    for (int i = 0; i < 8; ++i) small.emplace(std::to_string(i));
+    Tracked::copies = 0;
+    ArrayList<Tracked, 16> movedSmall(std::move(small));
+    CHECK(Tracked::copies == 0);
+    CHECK(movedSmall.size() == 8);
+    CHECK(small.size() == 0);
+}
+
+static void testBounds()
+{
+    ArrayList<int> list;
+    CHECK_THROWS(IndexOutOfBound, list.get(0));
+    CHECK_THROWS(IndexOutOfBound, list.emplaceAt(1, 5));
+    CHECK_THROWS(IndexOutOfBound, list.removeIndex(-1));
+    list.add(1);
+    CHECK_THROWS(IndexOutOfBound, list.set(1, 2));
+    ArrayList<int>::Iterator itr = list.iterator();
+    itr.next();
+    CHECK_THROWS(ElementNotExist, itr.next());
+}
+
+int main()
+{
+    testDifferential<0>();
+    testDifferential<4>();
+    testGap<int, 0>(5);
+    testGap<int, 8>(6);
+    testGap<Tracked, 0>(7);
+    testGap<Tracked, 8>(8);
+    testGapSorted();
+    testConcurrentReaders();
+    testMovesDoNotCopy();
+    testBounds();
+    CHECK(Tracked::live == 0);
+    std::puts("ArrayListTest: ok");
+    return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file
+ * Tests of BlockDeque: a randomized differential test against std::deque with tiny
+ * blocks, so that both ends cross block boundaries all the time, including removal
+ * through iterators in both directions; and element addresses staying put while blocks
+ * are allocated and released at both ends around them.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/BlockDequeTest.cpp -o BlockDequeTest
+ */
+#include "BlockDeque.h"
+#include "Check.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * Counts live objects, to check that every removed element is destroyed exactly once.
+ */
+class Counted
+{
+public:
+    static int live;
+    std::string value;
+
+    Counted(const std::string& value = ""):value(value) { ++live; }
+    Counted(const Counted& x):value(x.value) { ++live; }
+    Counted(Counted&& x):value(std::move(x.value)) { ++live; }
+    Counted& operator=(const Counted& x) { value = x.value; return *this; }
+    Counted& operator=(Counted&& x) { value = std::move(x.value); return *this; }
+    ~Counted() { --live; }
+    bool operator==(const Counted& x) const { return value == x.value; }
+};
+
+int Counted::live = 0;
+
+template <int B>
+static void same(BlockDeque<Counted, B>& d, const std::deque<std::string>& ref)
+{
+    CHECK(d.size() == (int)ref.size() && d.isEmpty() == ref.empty());
+    for (int i = 0; i < (int)ref.size(); ++i) CHECK(d.get(i).value == ref[i]);
+    typename BlockDeque<Counted, B>::Iterator forward = d.iterator(), backward = d.descendingIterator();
+    for (size_t i = 0; i < ref.size(); ++i) CHECK(forward.next().value == ref[i]);
+    for (size_t i = ref.size(); i > 0; --i) CHECK(backward.next().value == ref[i - 1]);
+    CHECK(!forward.hasNext() && !backward.hasNext());
+    if (!ref.empty()) CHECK(d.getFirst().value == ref.front() && d.getLast().value == ref.back());
+}
+
+template <int B>
+static void testDifferential(unsigned long long seed)
+{
+    TestRandom random(seed);
+    BlockDeque<Counted, B> d;
+    std::deque<std::string> ref;
+    for (int step = 0; step < 40000; ++step)
+    {
+        std::string s = std::to_string(step);
+        int n = (int)ref.size();
+        // drift between growing and shrinking phases, so the deque empties now and then
+        bool grow = (step / 1500) % 2 == 0;
+        switch (random.below(grow ? 5 : 9))
+        {
+        case 0:
+        case 1:
+            d.addFirst(Counted(s)), ref.push_front(s);
+            break;
+        case 2:
+        case 3:
+            d.addLast(Counted(s)), ref.push_back(s);
+            break;
+        case 4:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                d.set(i, Counted(s)), ref[i] = s;
+                CHECK(d.contains(Counted(ref[random.below(n)])));
+            }
+            CHECK(!d.contains(Counted("absent")));
+            break;
+        case 5:
+            if (n > 0) d.removeFirst(), ref.pop_front();
+            else CHECK_THROWS(ElementNotExist, d.removeFirst());
+            break;
+        case 6:
+            if (n > 0) d.removeLast(), ref.pop_back();
+            else CHECK_THROWS(ElementNotExist, d.removeLast());
+            break;
+        case 7:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                d.removeAt(i), ref.erase(ref.begin() + i);
+            }
+            else CHECK_THROWS(IndexOutOfBound, d.removeAt(0));
+            break;
+        case 8:
+            if (random.below(10) == 0)
+            {
+                // remove a random subset through an iterator in either direction
+                bool forward = random.below(2) == 0;
+                typename BlockDeque<Counted, B>::Iterator itr = forward ? d.iterator() : d.descendingIterator();
+                std::deque<std::string> kept;
+                int every = 1 + random.below(4);
+                while (itr.hasNext())
+                {
+                    std::string v = itr.next().value;
+                    if (random.below(every) == 0)
+                    {
+                        itr.remove();
+                        CHECK_THROWS(ElementNotExist, itr.remove());
+                    }
+                    else if (forward) kept.push_back(v);
+                    else kept.push_front(v);
+                }
+                ref.swap(kept);
+                CHECK_THROWS(ElementNotExist, itr.next());
+            }
+            break;
+        }
+        CHECK(d.size() == (int)ref.size() && Counted::live == (int)ref.size());
+        if (step % 997 == 0)
+        {
+            same(d, ref);
+            BlockDeque<Counted, B> copy(d), assigned;
+            assigned.addLast(Counted("x"));
+            assigned = d;
+            same(copy, ref);
+            same(assigned, ref);
+        }
+    }
+    same(d, ref);
+    d.clear(), ref.clear();
+    same(d, ref);
+    CHECK(Counted::live == 0);
+    CHECK_THROWS(ElementNotExist, d.getFirst());
+    CHECK_THROWS(IndexOutOfBound, d.get(0));
+}
+
+/**
+ * Elements in the middle keep their addresses while many blocks are added and released
+ * at both ends, and while the elements around them are popped.
+ */
+static void testAddressStability()
+{
+    BlockDeque<Counted, 3> d;
+    for (int i = 0; i < 20; ++i) d.addLast(Counted(std::to_string(i)));
+    std::vector<const Counted *> saved;
+    for (int i = 0; i < 20; ++i) saved.push_back(&d.get(i));
+    for (int round = 0; round < 5; ++round)
+    {
+        for (int i = 0; i < 5000; ++i) d.addFirst(Counted("f")), d.addLast(Counted("l"));
+        for (int i = 0; i < 20; ++i) CHECK(&d.get(5000 + i) == saved[i] && saved[i]->value == std::to_string(i));
+        for (int i = 0; i < 5000; ++i) d.removeFirst(), d.removeLast();
+        for (int i = 0; i < 20; ++i) CHECK(&d.get(i) == saved[i] && saved[i]->value == std::to_string(i));
+    }
+    // popping down to the saved elements from both sides leaves the rest in place
+    for (int i = 0; i < 5; ++i) d.removeFirst(), d.removeLast();
+    for (int i = 5; i < 15; ++i) CHECK(&d.get(i - 5) == saved[i] && saved[i]->value == std::to_string(i));
+    CHECK(Counted::live == 10);
+}
+
+int main()
+{
+    testDifferential<1>(1);
+    testDifferential<2>(2);
+    testDifferential<9>(3);
+    testAddressStability();
+    CHECK(Counted::live == 0);
+    std::puts("BlockDequeTest: ok");
+    return 0;
+}
@@ -0,0 +1,275 @@
+/**
+ * @file
+ * Tests of Cache: LRU against a reference built from std::list and std::map, including
+ * charges and replacing entries; for every policy, invariants that hold whatever it
+ * evicts (hits return the last value put, usage is the sum of the cached charges and
+ * fits the capacity, the counters add up); segmented LRU keeping its hot entries through
+ * a scan; the hash table growing, surviving a constant hash, and clearing; and a
+ * capacity or charge that is not positive being refused.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/CacheTest.cpp -o CacheTest
+ */
+#include "Cache.h"
+#include "Check.h"
+#include <list>
+#include <map>
+#include <utility>
+
+class IntHash
+{
+public:
+    static int hashCode(int x)
+    {
+        return x;
+    }
+};
+
+/**
+ * Every key in one bucket.
+ */
+class ConstHash
+{
+public:
+    static int hashCode(int)
+    {
+        return 7;
+    }
+};
+
+/**
+ * LRU the slow, obvious way: most recently used at the back.
+ */
+class ReferenceLru
+{
+public:
+    std::list<int> order;
+    std::map<int, std::pair<int, long long> > entries;
+    long long capacity, used, evictions;
+
+    ReferenceLru(long long capacity):capacity(capacity), used(0), evictions(0) {}
+
+    void toBack(int key)
+    {
+        order.remove(key);
+        order.push_back(key);
+    }
+
+    bool get(int key, int& value)
+    {
+        if (entries.count(key) == 0) return false;
+        toBack(key);
+        value = entries[key].first;
+        return true;
+    }
+
+    bool remove(int key)
+    {
+        if (entries.count(key) == 0) return false;
+        used -= entries[key].second;
+        entries.erase(key);
+        order.remove(key);
+        return true;
+    }
+
+    bool put(int key, int value, long long charge)
+    {
+        if (charge > capacity)
+        {
+            remove(key);
+            return false;
+        }
+        if (entries.count(key) == 1)
+        {
+            used -= entries[key].second;
+            order.remove(key);
+        }
+        while (used + charge > capacity)
+        {
+            int victim = order.front();
+            order.pop_front();
+            used -= entries[victim].second;
+            entries.erase(victim);
+            ++evictions;
+        }
+        entries[key] = std::make_pair(value, charge);
+        order.push_back(key);
+        used += charge;
+        return true;
+    }
+};
+
+template <class H>
+static void testLru(unsigned long long seed, bool charged)
+{
+    const int KEYS = 300;
+    Cache<int, int, H> cache(charged ? 400 : 50);
+    ReferenceLru ref(cache.capacity());
+    TestRandom random(seed);
+    for (int step = 0; step < 30000; ++step)
+    {
+        int key = random.below(KEYS), value;
+        switch (random.below(6))
+        {
+        case 0:
+        case 1:
+        {
+            int expected = 0;
+            bool hit = ref.get(key, expected);
+            CHECK(cache.get(key, value) == hit);
+            if (hit) CHECK(value == expected);
+            break;
+        }
+        case 2:
+        case 3:
+        case 4:
+        {
+            long long charge = charged ? 1 + random.below(60) : 1;
+            if (charged && random.below(200) == 0) charge = cache.capacity() + 1;
+            CHECK(cache.put(key, step, charge) == ref.put(key, step, charge));
+            break;
+        }
+        case 5:
+            CHECK(cache.remove(key) == ref.remove(key));
+            break;
+        }
+        CHECK(cache.size() == (int)ref.entries.size() && cache.usage() == ref.used);
+        if (step % 1009 == 0)
+            for (int k = 0; k < KEYS; ++k) CHECK(cache.containsKey(k) == (ref.entries.count(k) == 1));
+    }
+    CHECK(cache.evictionCount() == ref.evictions);
+}
+
+/**
+ * Invariants that hold whichever entries the policy picks to evict.
+ */
+static void testInvariants(CachePolicy policy, unsigned long long seed)
+{
+    const int KEYS = 500;
+    Cache<int, int, IntHash> cache(1000, policy);
+    std::map<int, std::pair<int, long long> > last;
+    long long gets = 0;
+    TestRandom random(seed);
+    for (int step = 0; step < 40000; ++step)
+    {
+        // a skewed key distribution, so that some entries are hot
+        int key = random.below(2) ? random.below(20) : random.below(KEYS), value;
+        if (random.below(3) == 0)
+        {
+            long long charge = 1 + random.below(40);
+            CHECK(cache.put(key, step, charge));
+            last[key] = std::make_pair(step, charge);
+        }
+        else
+        {
+            ++gets;
+            bool hit = cache.get(key, value);
+            CHECK(hit == cache.containsKey(key));
+            if (hit) CHECK(value == last[key].first);
+        }
+        if (random.below(50) == 0) cache.remove(random.below(KEYS));
+        CHECK(cache.usage() <= cache.capacity());
+        if (step % 997 == 0)
+        {
+            long long used = 0;
+            int size = 0;
+            for (int k = 0; k < KEYS; ++k)
+                if (cache.containsKey(k)) used += last[k].second, ++size;
+            CHECK(used == cache.usage() && size == cache.size());
+        }
+    }
+    CHECK(cache.hitCount() + cache.missCount() == gets);
+    CHECK(cache.hitCount() > 0 && cache.missCount() > 0 && cache.evictionCount() > 0);
+    cache.resetStats();
+    CHECK(cache.hitCount() == 0 && cache.missCount() == 0 && cache.evictionCount() == 0);
+}
+
+/**
+ * Segmented LRU keeps entries used twice through a scan of one-off keys; plain LRU
+ * loses them.
+ */
+static void testScanResistance()
+{
+    Cache<int, int, IntHash> slru(100, CachePolicy::SEGMENTED_LRU), lru(100);
+    int value;
+    for (int round = 0; round < 2; ++round)
+        for (int k = 0; k < 50; ++k)
+        {
+            slru.put(k, k), lru.put(k, k);
+            slru.get(k, value), lru.get(k, value);
+        }
+    for (int k = 1000; k < 1500; ++k) slru.put(k, k), lru.put(k, k);
+    for (int k = 0; k < 50; ++k) CHECK(slru.containsKey(k) && !lru.containsKey(k));
+    CHECK(slru.size() == 100 && lru.size() == 100);
+}
+
+/**
+ * CLOCK gives a referenced entry a second chance.
+ */
+static void testClock()
+{
+    Cache<int, int, IntHash> cache(3, CachePolicy::CLOCK);
+    int value;
+    cache.put(1, 1), cache.put(2, 2), cache.put(3, 3);
+    CHECK(cache.get(1, value) && value == 1);
+    cache.put(4, 4);
+    CHECK(cache.containsKey(1) && !cache.containsKey(2) && cache.containsKey(3) && cache.containsKey(4));
+    CHECK(cache.evictionCount() == 1);
+}
+
+/**
+ * The table grows well past its first size, keeps every entry reachable, and starts
+ * small again after clear.
+ */
+static void testGrowth()
+{
+    const int N = 100000;
+    Cache<int, int, IntHash> cache(N);
+    for (int k = 0; k < N; ++k) CHECK(cache.put(k * 1024, k));
+    CHECK(cache.size() == N && cache.evictionCount() == 0);
+    int value;
+    for (int k = 0; k < N; k += 37) CHECK(cache.get(k * 1024, value) && value == k);
+    CHECK(!cache.containsKey(1) && !cache.remove(-1024));
+    cache.clear();
+    CHECK(cache.isEmpty() && cache.usage() == 0 && !cache.containsKey(0));
+    cache.put(5, 5);
+    CHECK(cache.get(5, value) && value == 5 && cache.size() == 1);
+}
+
+/**
+ * A capacity that is not positive is refused at construction, and a charge that is not
+ * positive is refused by put without touching the cache.
+ */
+static void testRejects()
+{
+    CHECK_THROWS(IndexOutOfBound, (Cache<int, int, IntHash>(0)));
+    CHECK_THROWS(IndexOutOfBound, (Cache<int, int, IntHash>(-10, CachePolicy::SEGMENTED_LRU)));
+    Cache<int, int, IntHash> cache(10, CachePolicy::SEGMENTED_LRU);
+    int value;
+    CHECK(cache.put(1, 1, 4) && cache.put(2, 2, 6));
+    CHECK(!cache.put(3, 3, 0) && !cache.put(4, 4, -5) && !cache.containsKey(3) && !cache.containsKey(4));
+    CHECK(!cache.put(1, 100, 0) && !cache.put(2, 200, -6));
+    CHECK(cache.get(1, value) && value == 1 && cache.get(2, value) && value == 2);
+    CHECK(cache.size() == 2 && cache.usage() == 10 && cache.evictionCount() == 0);
+    // a zero charge must not let entries in for free
+    for (int k = 10; k < 1000; ++k) cache.put(k, k, 0);
+    CHECK(cache.size() == 2 && cache.usage() == 10);
+    Cache<int, int, IntHash> one(1, CachePolicy::SEGMENTED_LRU);
+    for (int k = 0; k < 100; ++k) CHECK(one.put(k, k) && one.get(k, value) && value == k);
+    CHECK(one.size() == 1 && one.usage() == 1 && one.evictionCount() == 99);
+}
+
+int main()
+{
+    testLru<IntHash>(1, false);
+    testLru<IntHash>(2, true);
+    testLru<ConstHash>(3, true);
+    testInvariants(CachePolicy::LRU, 4);
+    testInvariants(CachePolicy::CLOCK, 5);
+    testInvariants(CachePolicy::SEGMENTED_LRU, 6);
+    testScanResistance();
+    testClock();
+    testGrowth();
+    testRejects();
+    std::puts("CacheTest: ok");
+    return 0;
+}
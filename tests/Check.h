@@ -0,0 +1,67 @@
+/** @file */
+#ifndef __CHECK_H
+#define __CHECK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Minimal assertions for the standalone test programs in this directory. A failed check
+ * prints the file, line and expression and aborts, so a test program exits non-zero on
+ * the first failure and the sanitizers get a stack trace.
+ */
+#define CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::abort(); \
+        } \
+    } \
+    while (0)
+
+/**
+ * Checks that evaluating expr throws an exception of type E.
+ */
+#define CHECK_THROWS(E, expr) \
+    do \
+    { \
+        bool thrown = false; \
+        try { expr; } \
+        catch (E&) { thrown = true; } \
+        if (!thrown) \
+        { \
+            std::fprintf(stderr, "%s:%d: CHECK_THROWS failed: %s did not throw %s\n", __FILE__, __LINE__, #expr, #E); \
+            std::abort(); \
+        } \
+    } \
+    while (0)
+
+/**
+ * A small xorshift generator, so that randomized tests replay the same operations on
+ * every run and platform.
+ */
+class TestRandom
+{
+    unsigned long long s;
+
+public:
+    TestRandom(unsigned long long seed = 88172645463325252ull):s(seed ? seed : 1) {}
+
+    unsigned next()
+    {
+        s ^= s << 13, s ^= s >> 7, s ^= s << 17;
+        return (unsigned)(s >> 32);
+    }
+
+    /**
+     * Returns a value in [0, n).
+     */
+    int below(int n)
+    {
+        return (int)(next() % (unsigned)n);
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * Randomized differential test of ColumnList against a std::vector of tuples.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/ColumnListTest.cpp -o ColumnListTest
+ */
+#include "ColumnList.h"
+#include "Check.h"
+#include <string>
+#include <vector>
+
+typedef ColumnList<int, double, std::string> List;
+
+static void same(const List& list, const std::vector<List::Record>& ref)
+{
+    CHECK(list.size() == (int)ref.size());
+    const int *ids = list.column<0>();
+    const double *values = list.column<1>();
+    for (int i = 0; i < (int)ref.size(); ++i)
+    {
+        CHECK(list.get(i) == ref[i]);
+        CHECK(ids[i] == std::get<0>(ref[i]));
+        CHECK(values[i] == std::get<1>(ref[i]));
+        CHECK(list.columnList<2>().array()[i] == std::get<2>(ref[i]));
+    }
+}
+
+int main()
+{
+    TestRandom random;
+    List list;
+    std::vector<List::Record> ref;
+    for (int step = 0; step < 20000; ++step)
+    {
+        int n = (int)ref.size(), id = random.below(1000);
+        List::Record row(id, id * 0.25, std::to_string(id));
+        switch (random.below(6))
+        {
+        case 0:
+            list.add(id, id * 0.25, std::to_string(id)), ref.push_back(row);
+            break;
+        case 1:
+            list.add(row), ref.push_back(row);
+            break;
+        case 2:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                list.set(i, row), ref[i] = row;
+            }
+            break;
+        case 3:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                list.removeIndex(i), ref.erase(ref.begin() + i);
+            }
+            break;
+        case 4:
+        {
+            // per-field scans agree with a row-wise search
+            int expected = -1;
+            for (int i = 0; i < n && expected == -1; ++i) if (std::get<0>(ref[i]) == id) expected = i;
+            CHECK(list.columnList<0>().indexOf(id) == expected);
+            break;
+        }
+        case 5:
+            if (random.below(100) == 0) list.clear(), ref.clear();
+            else list.reserve(n + random.below(100));
+            break;
+        }
+        if (step % 101 == 0) same(list, ref);
+    }
+    same(list, ref);
+    CHECK(list.isEmpty() == ref.empty());
+    CHECK_THROWS(IndexOutOfBound, list.get(list.size()));
+    CHECK_THROWS(IndexOutOfBound, list.removeIndex(-1));
+    std::puts("ColumnListTest: ok");
+    return 0;
+}
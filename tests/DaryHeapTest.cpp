@@ -0,0 +1,191 @@
+/**
+ * @file
+ * Randomized differential tests of DaryHeap against a std::set of (key, id) pairs for
+ * D = 2, 3, 4 and 8, with many equal keys. The ordering ignores the unique id and Item
+ * has no operator==, so iterating while removing through the iterator must still return
+ * every element exactly once and remove exactly the one last returned.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/DaryHeapTest.cpp -o DaryHeapTest
+ */
+#include "DaryHeap.h"
+#include "Check.h"
+#include <set>
+#include <utility>
+
+/**
+ * Ordered by key alone; deliberately not equality-comparable.
+ */
+class Item
+{
+public:
+    int key, id;
+
+    Item(int key, int id):key(key), id(id) {}
+};
+
+class ItemLess
+{
+public:
+    bool operator()(const Item& a, const Item& b) const
+    {
+        return a.key < b.key;
+    }
+};
+
+typedef std::set<std::pair<int, int> > Reference;
+
+/**
+ * Pops a copy of h empty, checking it against ref in key order.
+ */
+template <int D>
+static void drainCopy(const DaryHeap<Item, ItemLess, D>& h, const Reference& ref)
+{
+    DaryHeap<Item, ItemLess, D> copy(h);
+    CHECK(copy.size() == (int)ref.size());
+    Reference seen;
+    int previous = -1;
+    while (!copy.empty())
+    {
+        const Item& x = copy.front();
+        CHECK(x.key >= previous);
+        previous = x.key;
+        seen.insert(std::make_pair(x.key, x.id));
+        copy.pop();
+    }
+    CHECK(seen == ref);
+}
+
+/**
+ * Iterates h once, removing about one element in removeEvery through the iterator, and
+ * checks that every element comes up exactly once.
+ */
+template <int D>
+static void iterateRemoving(DaryHeap<Item, ItemLess, D>& h, Reference& ref, TestRandom& random, int removeEvery)
+{
+    Reference seen;
+    typename DaryHeap<Item, ItemLess, D>::Iterator itr = h.iterator();
+    while (itr.hasNext())
+    {
+        const Item& x = itr.next();
+        std::pair<int, int> e(x.key, x.id);
+        CHECK(ref.count(e) == 1 && seen.insert(e).second);
+        if (random.below(removeEvery) == 0)
+        {
+            itr.remove();
+            ref.erase(e);
+            CHECK_THROWS(ElementNotExist, itr.remove());
+        }
+    }
+    CHECK(seen.size() >= ref.size());
+    for (Reference::iterator i = ref.begin(); i != ref.end(); ++i) CHECK(seen.count(*i) == 1);
+    CHECK_THROWS(ElementNotExist, itr.next());
+    CHECK(h.size() == (int)ref.size());
+}
+
+template <int D>
+static void testDifferential(unsigned long long seed)
+{
+    TestRandom random(seed);
+    DaryHeap<Item, ItemLess, D> h;
+    Reference ref;
+    int nextId = 0;
+    for (int step = 0; step < 20000; ++step)
+    {
+        switch (random.below(5))
+        {
+        case 0:
+        case 1:
+        {
+            Item x(random.below(50), nextId++);
+            h.push(x);
+            ref.insert(std::make_pair(x.key, x.id));
+            break;
+        }
+        case 2:
+        {
+            // pushed as an rvalue
+            int key = random.below(50);
+            h.push(Item(key, nextId));
+            ref.insert(std::make_pair(key, nextId++));
+            break;
+        }
+        case 3:
+            if (!ref.empty())
+            {
+                CHECK(h.front().key == ref.begin()->first);
+                ref.erase(std::make_pair(h.front().key, h.front().id));
+                h.pop();
+            }
+            else CHECK_THROWS(ElementNotExist, h.pop());
+            break;
+        case 4:
+            if (random.below(40) == 0) iterateRemoving(h, ref, random, 1 + random.below(4));
+            break;
+        }
+        CHECK(h.size() == (int)ref.size() && h.empty() == ref.empty());
+        if (step % 1999 == 0) drainCopy(h, ref);
+    }
+    drainCopy(h, ref);
+    // removing everything through one iterator
+    iterateRemoving(h, ref, random, 1);
+    CHECK(h.empty() && ref.empty());
+    CHECK_THROWS(ElementNotExist, h.front());
+}
+
+/**
+ * Lifting removals in a large heap, so that many forgotten elements are followed
+ * through further removals, and iterators copied midway.
+ */
+template <int D>
+static void testManyLifted(unsigned long long seed)
+{
+    TestRandom random(seed);
+    ArrayList<Item> items;
+    Reference ref;
+    for (int i = 0; i < 5000; ++i)
+    {
+        Item x(random.below(1000), i);
+        items.add(x);
+        ref.insert(std::make_pair(x.key, x.id));
+    }
+    DaryHeap<Item, ItemLess, D> h(items);
+    drainCopy(h, ref);
+    for (int pass = 0; pass < 3; ++pass) iterateRemoving(h, ref, random, 2);
+    drainCopy(h, ref);
+
+    typename DaryHeap<Item, ItemLess, D>::Iterator itr = h.iterator();
+    Reference seen;
+    for (int i = 0; i < (int)ref.size() / 2; ++i)
+    {
+        const Item& x = itr.next();
+        seen.insert(std::make_pair(x.key, x.id));
+        if (i % 2 == 0) itr.remove(), ref.erase(std::make_pair(x.key, x.id));
+    }
+    typename DaryHeap<Item, ItemLess, D>::Iterator copy = itr;
+    Reference rest = seen, restCopy = seen;
+    while (itr.hasNext())
+    {
+        const Item& x = itr.next();
+        CHECK(rest.insert(std::make_pair(x.key, x.id)).second);
+    }
+    itr = copy;
+    while (itr.hasNext())
+    {
+        const Item& x = itr.next();
+        CHECK(restCopy.insert(std::make_pair(x.key, x.id)).second);
+    }
+    for (Reference::iterator i = ref.begin(); i != ref.end(); ++i) CHECK(rest.count(*i) == 1 && restCopy.count(*i) == 1);
+}
+
+int main()
+{
+    testDifferential<2>(1);
+    testDifferential<3>(2);
+    testDifferential<4>(3);
+    testDifferential<8>(4);
+    testManyLifted<2>(5);
+    testManyLifted<4>(6);
+    testManyLifted<8>(7);
+    std::puts("DaryHeapTest: ok");
+    return 0;
+}
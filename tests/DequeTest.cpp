@@ -0,0 +1,276 @@
+/**
+ * @file
+ * Randomized differential tests of Deque against std::deque, and checks that removed
+ * elements are destroyed at once and that T needs no default constructor.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/DequeTest.cpp -o DequeTest
+ */
+#include "Deque.h"
+#include "Check.h"
+#include <deque>
+#include <memory>
+#include <string>
+
+static void same(Deque<std::string>& d, const std::deque<std::string>& ref)
+{
+    CHECK(d.size() == (int)ref.size());
+    CHECK(d.isEmpty() == ref.empty());
+    for (int i = 0; i < (int)ref.size(); ++i) CHECK(d.get(i) == ref[i]);
+    Deque<std::string>::Iterator forward = d.iterator();
+    for (size_t i = 0; i < ref.size(); ++i) CHECK(forward.next() == ref[i]);
+    CHECK(!forward.hasNext());
+    Deque<std::string>::Iterator backward = d.descendingIterator();
+    for (size_t i = ref.size(); i > 0; --i) CHECK(backward.next() == ref[i - 1]);
+    CHECK(!backward.hasNext());
+    if (!ref.empty()) CHECK(d.getFirst() == ref.front() && d.getLast() == ref.back());
+}
+
+/**
+ * Random traffic at both ends, so the ring wraps in both directions and grows while wrapped.
+ */
+static void testEnds()
+{
+    TestRandom random;
+    Deque<std::string> d(1);
+    std::deque<std::string> ref;
+    for (int step = 0; step < 50000; ++step)
+    {
+        std::string s = std::to_string(step);
+        // drift between growing and shrinking phases
+        bool grow = (step / 2000) % 2 == 0;
+        switch (random.below(grow ? 6 : 8))
+        {
+        case 0:
+        case 1:
+            d.addFirst(s), ref.push_front(s);
+            break;
+        case 2:
+        case 3:
+            d.addLast(s), ref.push_back(s);
+            break;
+        case 4:
+            if (!ref.empty())
+            {
+                int i = random.below((int)ref.size());
+                d.set(i, s), ref[i] = s;
+            }
+            break;
+        case 5:
+            if (!ref.empty()) CHECK(d.contains(ref[random.below((int)ref.size())]));
+            CHECK(!d.contains("absent"));
+            break;
+        case 6:
+            if (!ref.empty()) d.removeFirst(), ref.pop_front();
+            break;
+        case 7:
+            if (!ref.empty()) d.removeLast(), ref.pop_back();
+            break;
+        }
+        if (step % 499 == 0) same(d, ref);
+    }
+    same(d, ref);
+    Deque<std::string> copy(d), assigned;
+    assigned = d;
+    same(copy, ref);
+    same(assigned, ref);
+    d.clear(), ref.clear();
+    same(d, ref);
+    CHECK_THROWS(ElementNotExist, d.removeFirst());
+    CHECK_THROWS(ElementNotExist, d.getLast());
+    CHECK_THROWS(IndexOutOfBound, d.get(0));
+}
+
+/**
+ * Steady FIFO traffic through a small deque wraps around indefinitely without growing.
+ */
+static void testSteadyFifo()
+{
+    Deque<int> d(8);
+    for (int i = 0; i < 5; ++i) d.addLast(i);
+    for (int i = 5; i < 1000000; ++i)
+    {
+        d.addLast(i);
+        CHECK(d.getFirst() == i - 5);
+        d.removeFirst();
+    }
+    CHECK(d.size() == 5 && d.getFirst() == 999995 && d.getLast() == 999999);
+}
+
+/**
+ * Middle insertion and removal, directly and through both iterators, on a wrapped ring.
+ */
+static void testMiddle()
+{
+    TestRandom random(3);
+    Deque<std::string> d(4);
+    std::deque<std::string> ref;
+    for (int step = 0; step < 20000; ++step)
+    {
+        std::string s = std::to_string(step);
+        int n = (int)ref.size();
+        switch (random.below(5))
+        {
+        case 0:
+        case 1:
+        {
+            int i = random.below(n + 1);
+            d.insert(i, s), ref.insert(ref.begin() + i, s);
+            break;
+        }
+        case 2:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                d.removeAt(i), ref.erase(ref.begin() + i);
+            }
+            break;
+        case 3:
+            if (random.below(2)) d.addFirst(s), ref.push_front(s);
+            else if (n > 0) d.removeFirst(), ref.pop_front();
+            break;
+        case 4:
+            if (random.below(20) == 0)
+            {
+                // remove a random subset through an iterator in either direction
+                bool forward = random.below(2) == 0;
+                Deque<std::string>::Iterator itr = forward ? d.iterator() : d.descendingIterator();
+                std::deque<std::string> kept;
+                while (itr.hasNext())
+                {
+                    std::string v = itr.next();
+                    if (random.below(4) == 0) itr.remove();
+                    else if (forward) kept.push_back(v);
+                    else kept.push_front(v);
+                }
+                ref.swap(kept);
+                CHECK_THROWS(ElementNotExist, itr.next());
+            }
+            break;
+        }
+        if (step % 257 == 0) same(d, ref);
+    }
+    same(d, ref);
+    CHECK_THROWS(IndexOutOfBound, d.insert(d.size() + 1, "x"));
+    CHECK_THROWS(IndexOutOfBound, d.removeAt(d.size()));
+    Deque<std::string>::Iterator itr = d.iterator();
+    CHECK_THROWS(ElementNotExist, itr.remove());
+    if (itr.hasNext())
+    {
+        itr.next();
+        itr.remove();
+        CHECK_THROWS(ElementNotExist, itr.remove());
+    }
+}
+
+/**
+ * Counts live objects; has no default constructor.
+ */
+class Counted
+{
+public:
+    static int live;
+    int value;
+
+    explicit Counted(int value):value(value) { ++live; }
+    Counted(const Counted& x):value(x.value) { ++live; }
+    Counted& operator=(const Counted& x) { value = x.value; return *this; }
+    ~Counted() { --live; }
+    bool operator==(const Counted& x) const { return value == x.value; }
+};
+
+int Counted::live = 0;
+
+/**
+ * Every operation leaves exactly size() live elements: a removed slot does not keep its
+ * old element alive until the ring wraps over it.
+ */
+static void testLifetimes()
+{
+    TestRandom random(4);
+    {
+        Deque<Counted> d(2);
+        std::deque<int> ref;
+        for (int step = 0; step < 30000; ++step)
+        {
+            int n = (int)ref.size();
+            bool grow = (step / 1000) % 2 == 0;
+            switch (random.below(grow ? 4 : 8))
+            {
+            case 0:
+                d.addFirst(Counted(step)), ref.push_front(step);
+                break;
+            case 1:
+                d.addLast(Counted(step)), ref.push_back(step);
+                break;
+            case 2:
+            {
+                int i = random.below(n + 1);
+                d.insert(i, Counted(step)), ref.insert(ref.begin() + i, step);
+                break;
+            }
+            case 3:
+                if (random.below(50) == 0)
+                {
+                    Deque<Counted> copy(d), assigned(1);
+                    assigned.addLast(Counted(-1));
+                    assigned = d;
+                    CHECK(Counted::live == 3 * n && copy.size() == n && assigned.size() == n);
+                }
+                break;
+            case 4:
+                if (n > 0) d.removeFirst(), ref.pop_front();
+                break;
+            case 5:
+                if (n > 0) d.removeLast(), ref.pop_back();
+                break;
+            case 6:
+                if (n > 0)
+                {
+                    int i = random.below(n);
+                    d.removeAt(i), ref.erase(ref.begin() + i);
+                }
+                break;
+            case 7:
+            {
+                Deque<Counted>::Iterator itr = random.below(2) ? d.iterator() : d.descendingIterator();
+                if (itr.hasNext())
+                {
+                    int v = itr.next().value;
+                    itr.remove();
+                    if (v == ref.front()) ref.pop_front();
+                    else ref.pop_back();
+                }
+                if (random.below(100) == 0) d.clear(), ref.clear();
+                break;
+            }
+            }
+            CHECK(Counted::live == (int)ref.size() && d.size() == (int)ref.size());
+            if (step % 997 == 0)
+                for (int i = 0; i < (int)ref.size(); ++i) CHECK(d.get(i).value == ref[i]);
+        }
+    }
+    CHECK(Counted::live == 0);
+
+    // what a popped element owns is released right away
+    Deque<std::shared_ptr<int> > d(4);
+    std::shared_ptr<int> first(new int(1)), last(new int(2)), middle(new int(3));
+    std::weak_ptr<int> w1(first), w2(last), w3(middle);
+    d.addLast(first), d.addLast(middle), d.addLast(last), d.addLast(std::shared_ptr<int>());
+    first.reset(), last.reset(), middle.reset();
+    d.removeAt(1);
+    CHECK(w3.expired());
+    d.removeFirst();
+    CHECK(w1.expired());
+    d.removeLast(), d.removeLast();
+    CHECK(w2.expired() && d.isEmpty());
+}
+
+int main()
+{
+    testEnds();
+    testSteadyFifo();
+    testMiddle();
+    testLifetimes();
+    std::puts("DequeTest: ok");
+    return 0;
+}
@@ -0,0 +1,268 @@
+/**
+ * @file
+ * Randomized differential tests of IntrusiveList against std::list of pointers, with
+ * objects that sit in two lists at once through hooks at different offsets, a hook
+ * behind two base classes in lists filled only by splice, plus the error paths for
+ * objects that are not linked.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/IntrusiveListTest.cpp -o IntrusiveListTest
+ */
+#include "IntrusiveList.h"
+#include "Check.h"
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+
+/**
+ * Not standard-layout (a virtual function and a std::string ahead of the hooks), so the
+ * hooks sit at offsets that only a real object can tell.
+ */
+class Job
+{
+public:
+    std::string name;
+    ListHook byAge;
+    int id;
+    ListHook byOwner;
+
+    Job(int id):name("job " + std::to_string(id)), id(id) {}
+    virtual ~Job() {}
+};
+
+typedef IntrusiveList<Job, &Job::byAge> AgeList;
+typedef IntrusiveList<Job, &Job::byOwner> OwnerList;
+
+template <class L>
+static void same(L& l, const std::list<Job *>& ref)
+{
+    CHECK(l.size() == (int)ref.size());
+    CHECK(l.isEmpty() == ref.empty());
+    typename L::Iterator itr = l.iterator();
+    for (std::list<Job *>::const_iterator i = ref.begin(); i != ref.end(); ++i) CHECK(itr.hasNext() && itr.next() == *i);
+    CHECK(!itr.hasNext());
+    if (ref.empty()) return;
+    CHECK(l.getFirst() == ref.front() && l.getLast() == ref.back());
+    CHECK(l.previousOf(ref.front()) == NULL && l.nextOf(ref.back()) == NULL);
+    int index = 0;
+    for (std::list<Job *>::const_iterator i = ref.begin(); i != ref.end(); ++i, ++index)
+    {
+        if (index % 5 == 0) CHECK(l.get(index) == *i);
+        std::list<Job *>::const_iterator next = i;
+        if (++next != ref.end()) CHECK(l.nextOf(*i) == *next && l.previousOf(*next) == *i);
+    }
+}
+
+/**
+ * Two age lists exchange jobs while every job also sits in one owner list.
+ */
+static void testDifferential()
+{
+    const int JOBS = 300;
+    std::vector<Job *> jobs;
+    for (int i = 0; i < JOBS; ++i) jobs.push_back(new Job(i));
+    TestRandom random;
+    {
+        AgeList ages[2];
+        std::list<Job *> ageRef[2];
+        OwnerList owners;
+        std::list<Job *> ownerRef;
+        for (int i = 0; i < JOBS; ++i) owners.add(jobs[i]), ownerRef.push_back(jobs[i]);
+
+        for (int step = 0; step < 30000; ++step)
+        {
+            Job *job = jobs[random.below(JOBS)];
+            int k = random.below(2);
+            AgeList& l = ages[k];
+            std::list<Job *>& ref = ageRef[k];
+            if (!job->byAge.isLinked())
+            {
+                int n = (int)ref.size();
+                switch (random.below(4))
+                {
+                case 0:
+                    l.addLast(job), ref.push_back(job);
+                    break;
+                case 1:
+                    l.addFirst(job), ref.push_front(job);
+                    break;
+                case 2:
+                {
+                    int i = random.below(n + 1);
+                    l.add(i, job);
+                    std::list<Job *>::iterator at = ref.begin();
+                    std::advance(at, i);
+                    ref.insert(at, job);
+                    break;
+                }
+                case 3:
+                    if (n > 0)
+                    {
+                        Job *position = ref.front();
+                        l.addBefore(position, job), ref.push_front(job);
+                    }
+                    break;
+                }
+            }
+            else
+            {
+                // the job is in one of the two age lists: find which
+                int in = std::find(ageRef[0].begin(), ageRef[0].end(), job) != ageRef[0].end() ? 0 : 1;
+                switch (random.below(5))
+                {
+                case 0:
+                case 1:
+                    ages[in].remove(job), ageRef[in].remove(job);
+                    break;
+                case 2:
+                    // move it to the end of the other list
+                    ages[1 - in].splice(NULL, ages[in], job);
+                    ageRef[in].remove(job), ageRef[1 - in].push_back(job);
+                    break;
+                case 3:
+                    if (!ageRef[in].empty()) ages[in].removeFirst(), ageRef[in].pop_front();
+                    break;
+                case 4:
+                    if (!ageRef[in].empty())
+                    {
+                        int i = random.below((int)ageRef[in].size());
+                        ages[in].removeIndex(i);
+                        std::list<Job *>::iterator at = ageRef[in].begin();
+                        std::advance(at, i);
+                        ageRef[in].erase(at);
+                    }
+                    break;
+                }
+            }
+            if (random.below(500) == 0)
+            {
+                // move all of one list into the other, before its first element
+                Job *position = ageRef[k].empty() ? NULL : ageRef[k].front();
+                ages[k].splice(position, ages[1 - k]);
+                ageRef[k].splice(ageRef[k].begin(), ageRef[1 - k]);
+            }
+            if (random.below(300) == 0)
+            {
+                // drop every third job from the owner list through an iterator, then re-add
+                OwnerList::Iterator itr = owners.iterator();
+                std::vector<Job *> dropped;
+                for (int i = 0; itr.hasNext(); ++i)
+                {
+                    Job *j = itr.next();
+                    if (i % 3 == 0) itr.remove(), dropped.push_back(j), ownerRef.remove(j);
+                }
+                for (size_t i = 0; i < dropped.size(); ++i) owners.addFirst(dropped[i]), ownerRef.push_front(dropped[i]);
+            }
+            if (step % 997 == 0) same(ages[0], ageRef[0]), same(ages[1], ageRef[1]), same(owners, ownerRef);
+        }
+        same(ages[0], ageRef[0]), same(ages[1], ageRef[1]), same(owners, ownerRef);
+        for (int k = 0; k < 2; ++k)
+            for (std::list<Job *>::iterator i = ageRef[k].begin(); i != ageRef[k].end(); ++i)
+                CHECK(ages[k].contains(*i) && !ages[1 - k].contains(*i));
+        ages[0].clear();
+        for (std::list<Job *>::iterator i = ageRef[0].begin(); i != ageRef[0].end(); ++i) CHECK(!(*i)->byAge.isLinked());
+        // the destructors unlink whatever is left
+    }
+    for (int i = 0; i < JOBS; ++i)
+    {
+        CHECK(!jobs[i]->byAge.isLinked() && !jobs[i]->byOwner.isLinked());
+        delete jobs[i];
+    }
+}
+
+static void testErrors()
+{
+    Job a(1), b(2);
+    AgeList l;
+    CHECK_THROWS(ElementNotExist, l.remove(&a));
+    CHECK_THROWS(ElementNotExist, l.nextOf(&a));
+    CHECK_THROWS(ElementNotExist, l.previousOf(&a));
+    CHECK_THROWS(ElementNotExist, l.removeFirst());
+    CHECK_THROWS(ElementNotExist, l.removeLast());
+    CHECK_THROWS(ElementNotExist, l.getFirst());
+    CHECK_THROWS(IndexOutOfBound, l.get(0));
+    CHECK_THROWS(IndexOutOfBound, l.add(1, &a));
+    AgeList other;
+    CHECK_THROWS(ElementNotExist, l.splice(NULL, other, &a));
+    l.add(&a);
+    CHECK(l.size() == 1 && other.isEmpty());
+    // a copy gets a fresh, unlinked hook
+    Job c(a);
+    CHECK(a.byAge.isLinked() && !c.byAge.isLinked());
+    CHECK_THROWS(ElementNotExist, l.remove(&c));
+    l.remove(&a);
+    CHECK_THROWS(ElementNotExist, l.remove(&a));
+    CHECK(l.isEmpty() && !a.byAge.isLinked());
+    AgeList::Iterator itr = l.iterator();
+    CHECK(!itr.hasNext());
+    CHECK_THROWS(ElementNotExist, itr.next());
+    CHECK_THROWS(ElementNotExist, itr.remove());
+    // a list filled only by a whole-list splice still maps hooks back to objects
+    other.add(&b);
+    l.splice(NULL, other);
+    CHECK(l.getFirst() == &b && l.getFirst()->id == 2 && other.isEmpty());
+    l.clear();
+}
+
+class Named
+{
+public:
+    std::string name;
+    virtual ~Named() {}
+};
+
+class Counted
+{
+public:
+    long long count[3];
+};
+
+/**
+ * The hook behind two bases, so it sits past both of their subobjects.
+ */
+class Task : public Named, public Counted
+{
+public:
+    int id;
+    ListHook queued;
+
+    Task(int id):id(id)
+    {
+        name = "task " + std::to_string(id);
+        count[0] = count[1] = count[2] = id;
+    }
+};
+
+/**
+ * Lists that only ever received elements one at a time through splice, or that are
+ * read before anything was added to them, map hooks back to objects from the start,
+ * including through a base pointer to the object.
+ */
+static void testOffsetFromHook()
+{
+    typedef IntrusiveList<Task, &Task::queued> TaskList;
+    Task a(1), b(2), c(3);
+    TaskList from, to;
+    from.add(&a), from.add(&b), from.add(&c);
+    to.splice(NULL, from, &b);
+    CHECK(to.getFirst() == &b && to.getLast()->id == 2 && to.get(0)->name == "task 2");
+    to.splice(&b, from, &c);
+    CHECK(to.getFirst() == &c && to.nextOf(&c) == &b && to.previousOf(&b) == &c);
+    TaskList::Iterator itr = to.iterator();
+    CHECK(itr.next() == &c && itr.next()->count[2] == 2);
+    Counted *base = &a;
+    CHECK(from.getFirst() == static_cast<Task *>(base) && from.size() == 1);
+    TaskList fresh;
+    fresh.splice(NULL, to);
+    CHECK(fresh.getLast() == &b && fresh.size() == 2 && to.isEmpty());
+    fresh.clear(), from.clear();
+}
+
+int main()
+{
+    testDifferential();
+    testErrors();
+    testOffsetFromHook();
+    std::puts("IntrusiveListTest: ok");
+    return 0;
+}
@@ -0,0 +1,508 @@
+/**
+ * @file
+ * Tests LinkedList against std::list: iteration and Iterator::remove, element types
+ * without a default constructor, and several threads iterating one list at once.
+ * Positional access is checked against std::vector for LinkedList (finger cache) and
+ * IndexedLinkedList, including const get from several threads at once and one-byte
+ * elements. splice, splitAt and concat are checked against std::list::splice across
+ * private and shared pools, along with which moves relink and which copy, and default
+ * lists that exchanged nodes are then used from two threads at once.
+ *
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=address,undefined -I. tests/LinkedListTest.cpp -o LinkedListTest
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=thread -I. tests/LinkedListTest.cpp -o LinkedListTest
+ */
+#include "LinkedList.h"
+#include "IndexedLinkedList.h"
+#include "Check.h"
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
+
+template <class T>
+static void same(LinkedList<T>& l, const std::list<T>& ref)
+{
+    CHECK(l.size() == (int)ref.size());
+    CHECK(l.isEmpty() == ref.empty());
+    typename LinkedList<T>::Iterator itr = l.iterator();
+    for (typename std::list<T>::const_iterator i = ref.begin(); i != ref.end(); ++i) CHECK(itr.hasNext() && itr.next() == *i);
+    CHECK(!itr.hasNext());
+    CHECK_THROWS(ElementNotExist, itr.next());
+    if (!ref.empty()) CHECK(l.getFirst() == ref.front() && l.getLast() == ref.back());
+}
+
+/**
+ * Random adds at both ends, interleaved with passes that remove a random subset through
+ * an iterator; iterators are also copied mid-walk and both copies continue.
+ */
+static void testIterator()
+{
+    TestRandom random;
+    LinkedList<std::string> l;
+    std::list<std::string> ref;
+    same(l, ref);
+    for (int step = 0; step < 20000; ++step)
+    {
+        std::string s = std::to_string(step);
+        switch (random.below(6))
+        {
+        case 0:
+        case 1:
+            l.addLast(s), ref.push_back(s);
+            break;
+        case 2:
+            l.addFirst(s), ref.push_front(s);
+            break;
+        case 3:
+            if (!ref.empty()) l.removeFirst(), ref.pop_front();
+            break;
+        case 4:
+            if (random.below(10) == 0)
+            {
+                LinkedList<std::string>::Iterator itr = l.iterator();
+                std::list<std::string>::iterator i = ref.begin();
+                while (itr.hasNext())
+                {
+                    CHECK(itr.next() == *i);
+                    if (random.below(3) == 0) itr.remove(), i = ref.erase(i);
+                    else ++i;
+                }
+                CHECK(i == ref.end());
+            }
+            break;
+        case 5:
+            if (!ref.empty())
+            {
+                LinkedList<std::string>::Iterator a = l.iterator();
+                int skip = random.below((int)ref.size());
+                for (int k = 0; k < skip; ++k) a.next();
+                LinkedList<std::string>::Iterator b = a;
+                std::list<std::string>::iterator i = ref.begin();
+                std::advance(i, skip);
+                for (std::list<std::string>::iterator j = i; j != ref.end(); ++j) CHECK(a.next() == *j);
+                for (; i != ref.end(); ++i) CHECK(b.next() == *i);
+                CHECK(!a.hasNext() && !b.hasNext());
+            }
+            break;
+        }
+        if (step % 997 == 0) same(l, ref);
+    }
+    same(l, ref);
+
+    LinkedList<std::string>::Iterator itr = l.iterator();
+    CHECK_THROWS(ElementNotExist, itr.remove());
+    // removing everything through the iterator, including the head and the tail
+    while (itr.hasNext())
+    {
+        itr.next();
+        itr.remove();
+        CHECK_THROWS(ElementNotExist, itr.remove());
+    }
+    ref.clear();
+    same(l, ref);
+    l.addLast("again"), ref.push_back("again");
+    same(l, ref);
+}
+
+/**
+ * An element type with no default constructor; the iterator must not need one.
+ */
+class NoDefault
+{
+public:
+    int v;
+    explicit NoDefault(int v):v(v) {}
+    bool operator==(const NoDefault& o) const { return v == o.v; }
+    bool operator<(const NoDefault& o) const { return v < o.v; }
+};
+
+static void testNoDefaultConstructor()
+{
+    LinkedList<NoDefault> l;
+    for (int i = 0; i < 10; ++i) l.addLast(NoDefault(i));
+    LinkedList<NoDefault>::Iterator itr = l.iterator();
+    for (int i = 0; itr.hasNext(); ++i)
+    {
+        CHECK(itr.next().v == i);
+        if (i % 2 == 0) itr.remove();
+    }
+    CHECK(l.size() == 5 && l.getFirst().v == 1 && l.getLast().v == 9);
+}
+
+/**
+ * Several threads iterate the same list at once; an iterator writes nothing to the list,
+ * so ThreadSanitizer must see no race.
+ */
+static void testConcurrentReaders()
+{
+    LinkedList<int> l;
+    long long expected = 0;
+    for (int i = 0; i < 1000; ++i) l.addLast(i), expected += i;
+    std::vector<std::thread> readers;
+    std::vector<long long> sums(4, 0);
+    for (int t = 0; t < 4; ++t)
+        readers.push_back(std::thread([&l, &sums, t]()
+        {
+            for (int pass = 0; pass < 50; ++pass)
+            {
+                long long sum = 0;
+                for (LinkedList<int>::Iterator itr = l.iterator(); itr.hasNext();) sum += itr.next();
+                sums[t] = sum;
+            }
+        }));
+    for (size_t t = 0; t < readers.size(); ++t) readers[t].join();
+    for (int t = 0; t < 4; ++t) CHECK(sums[t] == expected);
+}
+
+/**
+ * Random and sequential positional operations mixed with end operations and iterator
+ * removal; const and non-const get must agree wherever the finger was left.
+ */
+template <class L>
+static void testPositional()
+{
+    TestRandom random(5);
+    L l;
+    const L& view = l;
+    std::vector<std::string> ref;
+    for (int step = 0; step < 20000; ++step)
+    {
+        std::string s = std::to_string(step);
+        int n = (int)ref.size();
+        switch (random.below(9))
+        {
+        case 0:
+        case 1:
+        {
+            int i = random.below(n + 1);
+            l.add(i, s), ref.insert(ref.begin() + i, s);
+            break;
+        }
+        case 2:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                l.removeIndex(i), ref.erase(ref.begin() + i);
+            }
+            break;
+        case 3:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                l.set(i, s), ref[i] = s;
+            }
+            break;
+        case 4:
+            if (n > 0)
+            {
+                int i = random.below(n), j = random.below(n);
+                CHECK(l.get(i) == ref[i]);
+                CHECK(view.get(j) == ref[j]);
+            }
+            break;
+        case 5:
+            if (random.below(2)) l.addFirst(s), ref.insert(ref.begin(), s);
+            else l.addLast(s), ref.push_back(s);
+            break;
+        case 6:
+            if (n > 0)
+            {
+                if (random.below(2)) l.removeFirst(), ref.erase(ref.begin());
+                else l.removeLast(), ref.pop_back();
+            }
+            break;
+        case 7:
+            if (random.below(10) == 0)
+            {
+                // sequential walks in both directions, through both overloads of get
+                for (int i = 0; i < n; ++i) CHECK(l.get(i) == ref[i]);
+                for (int i = n - 1; i >= 0; --i) CHECK(view.get(i) == ref[i]);
+            }
+            break;
+        case 8:
+            if (random.below(20) == 0)
+            {
+                typename L::Iterator itr = l.iterator();
+                std::vector<std::string> kept;
+                while (itr.hasNext())
+                {
+                    std::string v = itr.next();
+                    if (random.below(5) == 0) itr.remove();
+                    else kept.push_back(v);
+                }
+                ref.swap(kept);
+            }
+            break;
+        }
+    }
+    CHECK(l.size() == (int)ref.size());
+    for (int i = 0; i < (int)ref.size(); ++i) CHECK(view.get(i) == ref[i] && l.get(i) == ref[i]);
+    CHECK_THROWS(IndexOutOfBound, l.get(-1));
+    CHECK_THROWS(IndexOutOfBound, view.get((int)ref.size()));
+    CHECK_THROWS(IndexOutOfBound, l.set((int)ref.size(), "x"));
+    CHECK_THROWS(IndexOutOfBound, l.add((int)ref.size() + 1, "x"));
+    CHECK_THROWS(IndexOutOfBound, l.removeIndex((int)ref.size()));
+}
+
+/**
+ * IndexedLinkedList nodes of a one-byte element, whose links start after padding, at
+ * every level; the address sanitizer checks each link stays inside its node.
+ */
+static void testIndexedSmallElements()
+{
+    TestRandom random(12);
+    IndexedLinkedList<char> l;
+    std::vector<char> ref;
+    for (int step = 0; step < 20000; ++step)
+    {
+        char c = (char)('a' + random.below(26));
+        int n = (int)ref.size();
+        if ((n > 0) && (random.below(3) == 0))
+        {
+            int i = random.below(n);
+            CHECK(l.get(i) == ref[i]);
+            l.removeIndex(i), ref.erase(ref.begin() + i);
+        }
+        else
+        {
+            int i = random.below(n + 1);
+            l.add(i, c), ref.insert(ref.begin() + i, c);
+        }
+    }
+    CHECK(l.size() == (int)ref.size());
+    for (int i = 0; i < (int)ref.size(); ++i) CHECK(l.get(i) == ref[i]);
+}
+
+/**
+ * Several threads read one list by index through a const reference while it is not
+ * being modified; const get must not write the finger, so ThreadSanitizer sees no race.
+ */
+static void testConcurrentConstGet()
+{
+    LinkedList<int> l;
+    for (int i = 0; i < 2000; ++i) l.addLast(i);
+    l.get(1000);
+    const LinkedList<int>& shared = l;
+    std::vector<std::thread> readers;
+    std::vector<int> wrong(4, 0);
+    for (int t = 0; t < 4; ++t)
+        readers.push_back(std::thread([&shared, &wrong, t]()
+        {
+            TestRandom random(t + 1);
+            for (int k = 0; k < 2000; ++k)
+            {
+                int i = random.below(2000);
+                if (shared.get(i) != i) ++wrong[t];
+            }
+        }));
+    for (size_t t = 0; t < readers.size(); ++t) readers[t].join();
+    for (int t = 0; t < 4; ++t) CHECK(wrong[t] == 0);
+}
+
+/**
+ * Which moves relink (the element keeps its address) and which copy: taking a whole
+ * list with a private pool takes the pool too, loose nodes are adopted, part of a list
+ * with a private pool is copied, and lists on one shared Pool always relink.
+ */
+static void testSpliceRelinks()
+{
+    LinkedList<std::string> *a = new LinkedList<std::string>(), *b = new LinkedList<std::string>();
+    LinkedList<std::string> c, empty;
+    for (int i = 0; i < 100; ++i) a -> addLast("a" + std::to_string(i)), b -> addLast("b" + std::to_string(i)), c.addLast("c");
+    const std::string *first = &a -> getFirst(), *last = &b -> getLast();
+    b -> concat(*a);
+    CHECK(a -> isEmpty() && b -> size() == 200 && &b -> get(100) == first && &b -> getLast() != last);
+    // a starts afresh and owns nothing of b's
+    a -> addLast("fresh");
+    c.concat(*b);
+    CHECK(c.size() == 300 && &c.get(200) == first && b -> isEmpty());
+    delete b;
+    delete a;
+    CHECK(c.get(200) == "a0" && c.getLast() == "a99");
+
+    // part of a list with a private pool is copied
+    LinkedList<std::string> rest;
+    LinkedList<std::string>::Iterator at = c.iterator();
+    for (int i = 0; i < 150; ++i) at.next();
+    c.splitAt(at, rest);
+    CHECK(c.size() == 150 && rest.size() == 150 && rest.get(50) == "a0" && &rest.get(50) != first);
+    CHECK(c.getLast() == "b49");
+
+    // nodes of a short list are adopted by the pool of the list they move to
+    LinkedList<std::string> *loose = new LinkedList<std::string>();
+    for (int i = 0; i < 5; ++i) loose -> addLast("loose" + std::to_string(i));
+    const std::string *p = &loose -> get(2);
+    LinkedList<std::string>::Iterator from = loose -> iterator(), to = loose -> iterator();
+    from.next();
+    for (int i = 0; i < 4; ++i) to.next();
+    c.splice(c.iterator(), *loose, from, to);
+    CHECK(c.size() == 153 && loose -> size() == 2 && &c.get(1) == p);
+    delete loose;
+    c.removeFirst();
+    CHECK(c.getFirst() == "loose2");
+
+    // an empty list that never allocated takes the whole pool
+    empty.concat(c);
+    CHECK(empty.size() == 152 && c.isEmpty());
+    c.addLast("after");
+    CHECK(c.size() == 1 && empty.getFirst() == "loose2");
+
+    // a private pool moves into a shared Pool, which then counts its nodes
+    LinkedList<std::string>::Pool shared;
+    {
+        LinkedList<std::string> onShared(shared), priv, part;
+        for (int i = 0; i < 20; ++i) priv.addLast(std::to_string(i)), part.addLast(std::to_string(i));
+        const std::string *q = &priv.getFirst();
+        onShared.concat(priv);
+        CHECK(&onShared.getFirst() == q && shared.size() == 20);
+        priv.addLast("on its own again");
+        CHECK(shared.size() == 20);
+        // the first half of part is copied onto the shared Pool, the rest taken with its pool
+        LinkedList<std::string>::Iterator middle = part.iterator();
+        for (int i = 0; i < 10; ++i) middle.next();
+        const std::string *q2 = &part.get(0);
+        onShared.splice(onShared.iterator(), part, part.iterator(), middle);
+        CHECK(shared.size() == 30 && part.size() == 10 && onShared.getFirst() == "0" && &onShared.getFirst() != q2);
+        q2 = &part.getFirst();
+        onShared.concat(part);
+        CHECK(shared.size() == 40 && part.isEmpty() && &onShared.getLast() != q2 && &onShared.get(30) == q2);
+
+        // lists on one shared Pool relink any range
+        LinkedList<std::string> also(shared);
+        const std::string *r = &onShared.get(5);
+        LinkedList<std::string>::Iterator f = onShared.iterator(), l = onShared.iterator();
+        for (int i = 0; i < 5; ++i) f.next();
+        for (int i = 0; i < 8; ++i) l.next();
+        also.splice(also.iterator(), onShared, f, l);
+        CHECK(also.size() == 3 && &also.getFirst() == r && shared.size() == 40);
+    }
+    CHECK(shared.size() == 0);
+
+    // two different shared Pools cannot share nodes, so the elements are copied
+    LinkedList<std::string>::Pool other;
+    {
+        LinkedList<std::string> x(shared), y(other);
+        for (int i = 0; i < 10; ++i) y.addLast(std::to_string(i));
+        const std::string *q = &y.getFirst();
+        x.concat(y);
+        CHECK(x.size() == 10 && y.isEmpty() && x.getFirst() == "0" && &x.getFirst() != q);
+        CHECK(shared.size() == 10 && other.size() == 0);
+    }
+}
+
+/**
+ * Default lists that have exchanged nodes in every way still have allocators of their
+ * own, so each can be used from its own thread (the thread sanitizer build checks this).
+ */
+static void testSplicedListsShareNothing()
+{
+    LinkedList<int> a, b;
+    for (int i = 0; i < 100; ++i) a.addLast(i), b.addLast(i);
+    LinkedList<int>::Iterator at = a.iterator();
+    for (int i = 0; i < 40; ++i) at.next();
+    a.splitAt(at, b);
+    b.concat(a);
+    for (int i = 0; i < 50; ++i) a.addLast(i);
+    at = b.iterator();
+    for (int i = 0; i < 30; ++i) at.next();
+    a.splice(a.iterator(), b, b.iterator(), at);
+    a.concat(b);
+    for (int i = 0; i < 8; ++i) b.addLast(i);
+    CHECK(a.size() == 250 && b.size() == 8);
+    std::thread other([&b]()
+    {
+        for (int i = 0; i < 20000; ++i) b.addLast(i), b.removeFirst();
+    });
+    for (int i = 0; i < 20000; ++i) a.addLast(i), a.removeFirst();
+    other.join();
+    CHECK(a.size() == 250 && b.size() == 8);
+}
+
+/**
+ * Random splices, splits and concatenations among lists on private and shared pools,
+ * against std::list::splice.
+ */
+static void testSpliceDifferential()
+{
+    const int LISTS = 6;
+    TestRandom random(9);
+    LinkedList<int>::Pool poolA, poolB;
+    {
+        // two private, two on poolA, two on poolB
+        LinkedList<int> l0, l1, l2(poolA), l3(poolA), l4(poolB), l5(poolB);
+        LinkedList<int> *lists[LISTS] = { &l0, &l1, &l2, &l3, &l4, &l5 };
+        std::list<int> ref[LISTS];
+        for (int step = 0; step < 20000; ++step)
+        {
+            int i = random.below(LISTS), j = random.below(LISTS);
+            LinkedList<int>& l = *lists[i];
+            LinkedList<int>& o = *lists[j];
+            switch (random.below(6))
+            {
+            case 0:
+            case 1:
+                l.addLast(step), ref[i].push_back(step);
+                break;
+            case 2:
+                if (!ref[i].empty()) l.removeFirst(), ref[i].pop_front();
+                break;
+            case 3:
+            {
+                // a range of o to a position in l
+                int n = (int)ref[j].size(), at = random.below((int)ref[i].size() + 1);
+                int from = random.below(n + 1), to = from + random.below(n - from + 1);
+                // std::list leaves a position inside [first, last) undefined
+                if ((i == j) && (at >= from) && (at < to)) break;
+                LinkedList<int>::Iterator position = l.iterator(), first = o.iterator(), last = o.iterator();
+                for (int k = 0; k < at; ++k) position.next();
+                for (int k = 0; k < from; ++k) first.next();
+                for (int k = 0; k < to; ++k) last.next();
+                std::list<int>::iterator rp = ref[i].begin(), rf = ref[j].begin(), rl = ref[j].begin();
+                std::advance(rp, at), std::advance(rf, from), std::advance(rl, to);
+                l.splice(position, o, first, last);
+                ref[i].splice(rp, ref[j], rf, rl);
+                break;
+            }
+            case 4:
+                if (i != j)
+                {
+                    l.concat(o);
+                    ref[i].splice(ref[i].end(), ref[j]);
+                }
+                break;
+            case 5:
+                if (i != j)
+                {
+                    int at = random.below((int)ref[i].size() + 1);
+                    LinkedList<int>::Iterator position = l.iterator();
+                    for (int k = 0; k < at; ++k) position.next();
+                    l.splitAt(position, o);
+                    std::list<int>::iterator rp = ref[i].begin();
+                    std::advance(rp, at);
+                    ref[j].splice(ref[j].end(), ref[i], rp, ref[i].end());
+                }
+                break;
+            }
+            if (step % 211 == 0)
+                for (int k = 0; k < LISTS; ++k) same(*lists[k], ref[k]);
+        }
+        for (int k = 0; k < LISTS; ++k) same(*lists[k], ref[k]);
+    }
+    CHECK(poolA.size() == 0 && poolB.size() == 0);
+}
+
+int main()
+{
+    testIterator();
+    testNoDefaultConstructor();
+    testConcurrentReaders();
+    testPositional<LinkedList<std::string>>();
+    testPositional<IndexedLinkedList<std::string>>();
+    testIndexedSmallElements();
+    testConcurrentConstGet();
+    testSpliceRelinks();
+    testSplicedListsShareNothing();
+    testSpliceDifferential();
+    std::puts("LinkedListTest: ok");
+    return 0;
+}
@@ -0,0 +1,265 @@
+/**
+ * @file
+ * Tests of LockFreeSortedList and its EpochReclaimer: a sequential differential test
+ * against std::set, multi-threaded checks of what linearizability implies (per-key
+ * add/remove accounting, single-writer keys seen exactly, ordered inserts and removals
+ * never observed out of order), and that per-thread records are reused rather than
+ * allocated again when a thread cycles over many lists or new threads come and go.
+ *
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=address,undefined -I. tests/LockFreeSortedListTest.cpp -o LockFreeSortedListTest
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=thread -I. tests/LockFreeSortedListTest.cpp -o LockFreeSortedListTest
+ */
+#include "LockFreeSortedList.h"
+#include "Check.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <thread>
+#include <vector>
+
+/**
+ * Every operator new in the process, so a test can tell whether a stretch of code allocated.
+ */
+static std::atomic<long> allocations(0);
+
+void *operator new(size_t n)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = std::malloc(n == 0 ? 1 : n);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+static void testSequential()
+{
+    LockFreeSortedList<int> l;
+    std::set<int> ref;
+    TestRandom random(7);
+    for (int step = 0; step < 50000; ++step)
+    {
+        int k = random.below(500);
+        switch (random.below(3))
+        {
+        case 0:
+            CHECK(l.add(k) == ref.insert(k).second);
+            break;
+        case 1:
+            CHECK(l.remove(k) == (ref.erase(k) == 1));
+            break;
+        case 2:
+            CHECK(l.contains(k) == (ref.count(k) == 1));
+            break;
+        }
+        if (step % 4999 == 0)
+            for (int i = -1; i <= 500; ++i) CHECK(l.contains(i) == (ref.count(i) == 1));
+    }
+    CHECK(l.size() == (int)ref.size() && l.isEmpty() == ref.empty());
+}
+
+/**
+ * Threads add and remove shared keys at random, each counting its successful calls per
+ * key, and also own a range of keys that only they modify. A linearizable set lets the
+ * owner see its keys exactly as a sequential set would, and leaves each shared key
+ * present iff it was added once more than it was removed.
+ */
+static void testConcurrent()
+{
+    const int THREADS = 4, SHARED = 64, OWN = 64, STEPS = 40000;
+    LockFreeSortedList<int> l;
+    std::vector<std::vector<int> > net(THREADS, std::vector<int>(SHARED, 0));
+    std::atomic<int> errors(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+        threads.push_back(std::thread([&, t]()
+        {
+            TestRandom random(t + 1);
+            std::set<int> own;
+            for (int step = 0; step < STEPS; ++step)
+            {
+                if (random.below(2))
+                {
+                    int k = random.below(SHARED);
+                    switch (random.below(3))
+                    {
+                    case 0:
+                        if (l.add(k)) ++net[t][k];
+                        break;
+                    case 1:
+                        if (l.remove(k)) --net[t][k];
+                        break;
+                    case 2:
+                        l.contains(k);
+                        break;
+                    }
+                }
+                else
+                {
+                    // interleaved with the other threads' ranges, so neighbours change constantly
+                    int k = SHARED + random.below(OWN) * THREADS + t;
+                    bool ok;
+                    switch (random.below(3))
+                    {
+                    case 0:
+                        ok = l.add(k) == own.insert(k).second;
+                        break;
+                    case 1:
+                        ok = l.remove(k) == (own.erase(k) == 1);
+                        break;
+                    default:
+                        ok = l.contains(k) == (own.count(k) == 1);
+                        break;
+                    }
+                    if (!ok) ++errors;
+                }
+                if (step % 1024 == 0) std::this_thread::yield();
+            }
+        }));
+    for (int t = 0; t < THREADS; ++t) threads[t].join();
+    CHECK(errors.load() == 0);
+    int present = 0;
+    for (int k = 0; k < SHARED; ++k)
+    {
+        int n = 0;
+        for (int t = 0; t < THREADS; ++t) n += net[t][k];
+        CHECK((n == 0) || (n == 1));
+        CHECK(l.contains(k) == (n == 1));
+        present += n;
+    }
+    for (int k = SHARED; k < SHARED + OWN * THREADS; ++k) present += l.contains(k);
+    CHECK(l.size() == present);
+}
+
+/**
+ * One thread adds 0..N-1 in order and then removes them in order while readers probe.
+ * Once add(k) has been seen, every add before it has returned, so all smaller keys must
+ * be seen too; once remove(k) has been seen, no smaller key may be.
+ */
+static void testOrder()
+{
+    const int N = 2000, READERS = 3;
+    LockFreeSortedList<int> l;
+    std::atomic<int> phase(0), errors(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; ++r)
+        readers.push_back(std::thread([&, r]()
+        {
+            TestRandom random(r + 11);
+            for (int p; (p = phase.load()) < 2;)
+            {
+                int k = random.below(N);
+                if (p == 0 && l.contains(k))
+                {
+                    for (int j = k - 1; j >= 0 && j > k - 64; --j)
+                        if (!l.contains(j) && (phase.load() == 0)) ++errors;
+                }
+                else if (p == 1 && !l.contains(k))
+                {
+                    for (int j = k - 1; j >= 0 && j > k - 64; --j)
+                        if (l.contains(j)) ++errors;
+                }
+                std::this_thread::yield();
+            }
+        }));
+    for (int k = 0; k < N; ++k)
+    {
+        CHECK(l.add(k));
+        if (k % 64 == 0) std::this_thread::yield();
+    }
+    phase = 1;
+    for (int k = 0; k < N; ++k)
+    {
+        CHECK(l.remove(k));
+        if (k % 64 == 0) std::this_thread::yield();
+    }
+    phase = 2;
+    for (int r = 0; r < READERS; ++r) readers[r].join();
+    CHECK(errors.load() == 0);
+    CHECK(l.isEmpty());
+}
+
+/**
+ * More lists than a thread caches records for, visited round-robin: after the first
+ * round neither the thread nor later threads allocate, and the reclaimers' records stay
+ * bounded. Lists destroyed while a thread still caches their records are cleaned up
+ * when the thread evicts them or exits.
+ */
+static void testRecords()
+{
+    const int LISTS = 20;
+    LockFreeSortedList<int> lists[LISTS];
+    for (int i = 0; i < LISTS; ++i)
+        for (int k = 0; k < 10; ++k) lists[i].add(k);
+    for (int i = 0; i < LISTS; ++i) lists[i].contains(3);
+    long before = allocations.load();
+    for (int step = 0; step < 200000; ++step) lists[step % LISTS].contains(step % 12);
+    CHECK(allocations.load() == before);
+
+    // later threads claim the records earlier ones released when they exited
+    for (int t = 0; t < 10; ++t)
+    {
+        long grew = 0;
+        std::thread worker([&]()
+        {
+            lists[0].contains(1);
+            long start = allocations.load();
+            for (int step = 0; step < 20000; ++step) lists[step % LISTS].contains(step % 12);
+            grew = allocations.load() - start;
+        });
+        worker.join();
+        if (t > 0) CHECK(grew == 0);
+    }
+
+    // nested guards on more reclaimers than the cache holds
+    EpochReclaimer reclaimers[12];
+    for (int round = 0; round < 3; ++round)
+    {
+        long start = allocations.load();
+        std::vector<EpochReclaimer::Guard *> guards(12);
+        for (int i = 0; i < 12; ++i) guards[i] = new EpochReclaimer::Guard(reclaimers[i]);
+        for (int i = 11; i >= 0; --i) delete guards[i];
+        // only the vector and the guards themselves once the records exist
+        if (round > 0) CHECK(allocations.load() - start == 13);
+    }
+
+    // destroy lists while other threads still cache their records, one with a node retired
+    std::atomic<int> ready(0), stage(0);
+    std::thread evicts, exits;
+    {
+        LockFreeSortedList<int> doomed[3];
+        doomed[1].add(5);
+        evicts = std::thread([&]()
+        {
+            doomed[0].add(100);
+            ++ready;
+            while (stage.load() == 0) std::this_thread::yield();
+            for (int i = 0; i < 12; ++i) lists[i].contains(1);
+        });
+        exits = std::thread([&]()
+        {
+            doomed[1].remove(5);
+            doomed[2].add(100);
+            ++ready;
+            while (stage.load() == 0) std::this_thread::yield();
+        });
+        while (ready.load() < 2) std::this_thread::yield();
+    }
+    stage = 1;
+    evicts.join();
+    exits.join();
+}
+
+int main()
+{
+    testSequential();
+    testConcurrent();
+    testOrder();
+    testRecords();
+    std::puts("LockFreeSortedListTest: ok");
+    return 0;
+}
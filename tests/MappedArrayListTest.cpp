@@ -0,0 +1,173 @@
+/**
+ * @file
+ * Tests MappedArrayList against std::vector, across reopening, and with corrupt or
+ * oversized files. Creates and removes files under /tmp.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/MappedArrayListTest.cpp -o MappedArrayListTest
+ */
+#include "MappedArrayList.h"
+#include "Check.h"
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+static std::string path(const char *name)
+{
+    return std::string("/tmp/MappedArrayListTest.") + std::to_string(getpid()) + "." + name;
+}
+
+class Record
+{
+public:
+    long long id;
+    double value;
+    char tag[4];
+};
+
+static void testDifferential()
+{
+    std::string file = path("diff");
+    TestRandom random;
+    std::vector<int> ref;
+    for (int session = 0; session < 4; ++session)
+    {
+        MappedArrayList<int> list(file.c_str());
+        CHECK(list.size() == (long long)ref.size());
+        for (size_t i = 0; i < ref.size(); ++i) CHECK(list.get(i) == ref[i]);
+        if (session == 1) list.advise(MappedArrayList<int>::SEQUENTIAL);
+        for (int step = 0; step < 5000; ++step)
+        {
+            int n = (int)ref.size();
+            switch (random.below(6))
+            {
+            case 0:
+            case 1:
+            case 2:
+            {
+                int v = (int)random.next();
+                list.add(v), ref.push_back(v);
+                break;
+            }
+            case 3:
+                if (n > 0)
+                {
+                    int i = random.below(n), v = (int)random.next();
+                    list.set(i, v), ref[i] = v;
+                }
+                break;
+            case 4:
+                if (n > 0)
+                {
+                    int i = random.below(n);
+                    list.removeIndex(i), ref.erase(ref.begin() + i);
+                }
+                break;
+            case 5:
+            {
+                MappedArrayList<int>::Iterator itr = list.iterator();
+                std::vector<int> kept;
+                while (itr.hasNext())
+                {
+                    int v = itr.next();
+                    if (random.below(20) == 0) itr.remove();
+                    else kept.push_back(v);
+                }
+                ref.swap(kept);
+                break;
+            }
+            }
+        }
+        CHECK(list.size() == (long long)ref.size());
+        CHECK(list.capacity() >= list.size());
+        CHECK_THROWS(IndexOutOfBound, list.get(list.size()));
+        CHECK_THROWS(IndexOutOfBound, list.set(-1, 0));
+        list.flush();
+    }
+    unlink(file.c_str());
+}
+
+static void testRecords()
+{
+    std::string file = path("records");
+    {
+        MappedArrayList<Record> list(file.c_str());
+        for (int i = 0; i < 3000; ++i)
+        {
+            Record r = { i, i * 0.5, "ab" };
+            list.add(r);
+        }
+    }
+    {
+        MappedArrayList<Record> list(file.c_str());
+        CHECK(list.size() == 3000);
+        CHECK(list.get(2999).id == 2999 && list.get(2999).value == 1499.5);
+        // a different element type must not open the same file
+        CHECK_THROWS(IOException, MappedArrayList<int> other(file.c_str()));
+    }
+    unlink(file.c_str());
+}
+
+/**
+ * Overwrites the element count stored in the header of file.
+ */
+static void writeCount(const std::string& file, long long count)
+{
+    int fd = open(file.c_str(), O_RDWR);
+    CHECK(fd != -1);
+    CHECK(pwrite(fd, &count, sizeof(count), 16) == (ssize_t)sizeof(count));
+    close(fd);
+}
+
+static void testCorruptHeader()
+{
+    std::string file = path("corrupt");
+    {
+        MappedArrayList<int> list(file.c_str());
+        for (int i = 0; i < 10; ++i) list.add(i);
+    }
+    writeCount(file, -5);
+    CHECK_THROWS(IOException, MappedArrayList<int> list(file.c_str()));
+    writeCount(file, 1000000);
+    CHECK_THROWS(IOException, MappedArrayList<int> list(file.c_str()));
+    writeCount(file, 10);
+    {
+        MappedArrayList<int> list(file.c_str());
+        CHECK(list.size() == 10 && list.get(9) == 9);
+    }
+    unlink(file.c_str());
+}
+
+static void testHuge()
+{
+    // 3G one-byte elements: the sizes only fit in 64 bits; the file stays sparse
+    std::string file = path("huge");
+    const long long n = 3LL << 30;
+    {
+        MappedArrayList<char> list(file.c_str());
+        list.reserve(n);
+        CHECK(list.capacity() >= n);
+    }
+    CHECK(truncate(file.c_str(), 64 + n) == 0);
+    writeCount(file, n);
+    {
+        MappedArrayList<char> list(file.c_str());
+        CHECK(list.size() == n);
+        CHECK(list.capacity() == n);
+        list.set(n - 1, 'z');
+        CHECK(list.get(n - 1) == 'z');
+        CHECK(list.get(n / 2) == 0);
+        CHECK_THROWS(IOException, list.reserve((std::numeric_limits<long long>::max() - 64) + 1));
+        list.clear();
+    }
+    unlink(file.c_str());
+}
+
+int main()
+{
+    testDifferential();
+    testRecords();
+    testCorruptHeader();
+    testHuge();
+    std::puts("MappedArrayListTest: ok");
+    return 0;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file
+ * Tests MpmcQueue and BlockingMpmcQueue: single-thread capacity, batches and n <= 0; many
+ * producers and consumers mixing single and batch calls, checking that every element is
+ * taken exactly once and each producer's elements in order; and blocking, backpressure
+ * and close().
+ *
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=address,undefined -I. tests/MpmcQueueTest.cpp -o MpmcQueueTest
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=thread -I. tests/MpmcQueueTest.cpp -o MpmcQueueTest
+ */
+#include "MpmcQueue.h"
+#include "Check.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void testSingleThread()
+{
+    MpmcQueue<std::string> q(3);
+    CHECK(q.capacity() == 4 && q.isEmpty());
+    std::string out, items[6] = { "a", "b", "c", "d", "e", "f" }, popped[6];
+    CHECK(!q.tryPop(out));
+    CHECK(q.tryPopBatch(popped, 4) == 0);
+    CHECK(q.tryPushBatch(items, 0) == 0 && q.tryPushBatch(items, -3) == 0);
+    CHECK(q.isEmpty());
+    CHECK(q.tryPush("x"));
+    CHECK(q.tryPushBatch(items, 6) == 3);
+    CHECK(!q.tryPush("full") && q.tryPushBatch(items, 1) == 0);
+    CHECK(q.size() == 4);
+    CHECK(q.tryPopBatch(popped, 0) == 0 && q.tryPopBatch(popped, -1) == 0);
+    CHECK(q.tryPop(out) && out == "x");
+    CHECK(q.tryPopBatch(popped, 2) == 2 && popped[0] == "a" && popped[1] == "b");
+    // wrap around the ring a few laps
+    for (int lap = 0; lap < 10; ++lap)
+    {
+        CHECK(q.tryPushBatch(items + 3, 3) == 3);
+        CHECK(q.tryPopBatch(popped, 6) == 4);
+        CHECK(popped[3] == "f");
+        CHECK(q.tryPush("c"));
+    }
+    // elements left in the queue are destroyed with it
+    CHECK(q.tryPush(std::string(100, 'y')));
+}
+
+/**
+ * Each producer p pushes the values p * N + i for i in [0, N) while the consumers pop.
+ * Any one consumer must see each producer's elements in order.
+ */
+static void testManyProducersConsumers(int producers, int consumers)
+{
+    const int N = 50000;
+    MpmcQueue<int> q(64);
+    std::vector<std::atomic<int>> taken(producers * N);
+    for (size_t i = 0; i < taken.size(); ++i) taken[i].store(0, std::memory_order_relaxed);
+    std::atomic<int> total(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.push_back(std::thread([&q, p]()
+        {
+            TestRandom random(p + 1);
+            int batch[8];
+            for (int i = 0; i < N;)
+            {
+                int k = 1;
+                if (random.below(2)) k = q.tryPush(p * N + i) ? 1 : 0;
+                else
+                {
+                    int n = 1 + random.below(8);
+                    if (n > N - i) n = N - i;
+                    for (int j = 0; j < n; ++j) batch[j] = p * N + i + j;
+                    k = q.tryPushBatch(batch, n);
+                }
+                if (k == 0) std::this_thread::yield();
+                i += k;
+            }
+        }));
+    for (int c = 0; c < consumers; ++c)
+        threads.push_back(std::thread([&, c]()
+        {
+            TestRandom random(100 + c);
+            std::vector<int> last(producers, -1);
+            int batch[8];
+            while (total.load() < producers * N)
+            {
+                int k = random.below(2) ? (q.tryPop(batch[0]) ? 1 : 0) : q.tryPopBatch(batch, 1 + random.below(8));
+                if (k == 0) std::this_thread::yield();
+                for (int j = 0; j < k; ++j)
+                {
+                    int p = batch[j] / N, i = batch[j] % N;
+                    CHECK(i > last[p]);
+                    last[p] = i;
+                    taken[batch[j]].fetch_add(1);
+                }
+                total.fetch_add(k);
+            }
+        }));
+    for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+    CHECK(total.load() == producers * N);
+    for (size_t i = 0; i < taken.size(); ++i) CHECK(taken[i].load() == 1);
+    CHECK(q.isEmpty());
+}
+
+/**
+ * Blocking producers and consumers through a small queue, so both sides park, then
+ * close() after the producers finish: consumers drain the rest and then get false / 0.
+ */
+static void testBlocking(int producers, int consumers)
+{
+    const int N = 20000;
+    BlockingMpmcQueue<int> q(8);
+    std::atomic<long long> sum(0);
+    std::atomic<int> count(0);
+    std::vector<std::thread> producerThreads, consumerThreads;
+    for (int p = 0; p < producers; ++p)
+        producerThreads.push_back(std::thread([&q, p]()
+        {
+            int batch[5];
+            for (int i = 0; i < N;)
+                if (p % 2 == 0) CHECK(q.push(i++));
+                else
+                {
+                    int n = N - i < 5 ? N - i : 5;
+                    for (int j = 0; j < n; ++j) batch[j] = i + j;
+                    CHECK(q.pushBatch(batch, n) == n);
+                    i += n;
+                }
+        }));
+    for (int c = 0; c < consumers; ++c)
+        consumerThreads.push_back(std::thread([&q, &sum, &count, c]()
+        {
+            int batch[4], v;
+            for (;;)
+            {
+                int k = c % 2 == 0 ? (q.pop(batch[0]) ? 1 : 0) : q.popBatch(batch, 4);
+                if (k == 0) break;
+                for (int j = 0; j < k; ++j) sum.fetch_add(batch[j]);
+                count.fetch_add(k);
+            }
+            CHECK(q.isClosed() && !q.pop(v) && q.popBatch(batch, 4) == 0);
+        }));
+    for (size_t t = 0; t < producerThreads.size(); ++t) producerThreads[t].join();
+    q.close();
+    for (size_t t = 0; t < consumerThreads.size(); ++t) consumerThreads[t].join();
+    CHECK(count.load() == producers * N);
+    CHECK(sum.load() == (long long)producers * N * (N - 1) / 2);
+    int items[2] = { 1, 2 };
+    CHECK(!q.push(1) && !q.tryPush(1) && q.pushBatch(items, 2) == 0);
+}
+
+/**
+ * n <= 0 returns at once instead of parking on an open, empty queue; close() wakes a
+ * producer parked on a full queue.
+ */
+static void testEdgeCases()
+{
+    BlockingMpmcQueue<int> q(2);
+    int out[2] = { 0, 0 };
+    CHECK(q.popBatch(out, 0) == 0 && q.popBatch(out, -1) == 0);
+    CHECK(q.pushBatch(out, 0) == 0 && q.pushBatch(out, -2) == 0);
+    CHECK(q.tryPush(1) && q.tryPush(2) && !q.tryPush(3));
+    std::atomic<bool> returned(false);
+    std::thread producer([&]()
+    {
+        CHECK(!q.push(3));
+        returned.store(true);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!returned.load());
+    q.close();
+    producer.join();
+    CHECK(q.pop(out[0]) && out[0] == 1 && q.popBatch(out, 2) == 1 && out[0] == 2);
+    CHECK(!q.pop(out[0]) && q.popBatch(out, 2) == 0);
+}
+
+int main()
+{
+    testSingleThread();
+    testManyProducersConsumers(1, 1);
+    testManyProducersConsumers(3, 2);
+    testManyProducersConsumers(2, 4);
+    testBlocking(1, 1);
+    testBlocking(4, 3);
+    testEdgeCases();
+    std::puts("MpmcQueueTest: ok");
+    return 0;
+}
@@ -0,0 +1,239 @@
+/**
+ * @file
+ * Tests NodePool directly (slab growth, last-in first-out reuse, alignment, distinct
+ * live blocks, absorbing another pool, adopting blocks allocated one at a time) and
+ * through LinkedList, with private and shared pools and short lists that allocate only
+ * their nodes, counted through a replaced operator new.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/NodePoolTest.cpp -o NodePoolTest
+ */
+#include "NodePool.h"
+#include "LinkedList.h"
+#include "Check.h"
+#include <cstdint>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+
+static long long allocations;
+
+void *operator new(size_t n)
+{
+    ++allocations;
+    if (void *p = std::malloc(n == 0 ? 1 : n)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+static void testPool()
+{
+    NodePool<std::string> pool;
+    CHECK(pool.size() == 0 && pool.capacity() == 0);
+    std::vector<void *> live;
+    std::set<void *> distinct;
+    for (int i = 0; i < 1000; ++i)
+    {
+        void *p = pool.allocate();
+        CHECK((uintptr_t)p % alignof(std::string) == 0);
+        new (p) std::string(std::to_string(i));
+        live.push_back(p);
+        distinct.insert(p);
+    }
+    CHECK(distinct.size() == 1000);
+    CHECK(pool.size() == 1000);
+    // slabs of 16, 32, ..., 512: the capacity is the smallest such sum holding 1000
+    CHECK(pool.capacity() == 16 + 32 + 64 + 128 + 256 + 512);
+    for (int i = 0; i < 1000; ++i) CHECK(*static_cast<std::string *>(live[i]) == std::to_string(i));
+
+    // released blocks come back most recently freed first, before any new slab
+    for (int i = 0; i < 3; ++i)
+    {
+        static_cast<std::string *>(live[10 + i])->~basic_string();
+        pool.release(live[10 + i]);
+    }
+    CHECK(pool.size() == 997);
+    CHECK(pool.allocate() == live[12] && pool.allocate() == live[11] && pool.allocate() == live[10]);
+    for (int i = 10; i < 13; ++i) new (live[i]) std::string("again");
+    int capacity = pool.capacity();
+    for (int round = 0; round < 10; ++round)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            static_cast<std::string *>(live[i])->~basic_string();
+            pool.release(live[i]);
+        }
+        for (int i = 0; i < 1000; ++i) new (live[i] = pool.allocate()) std::string("x");
+    }
+    CHECK(pool.capacity() == capacity);
+    for (int i = 0; i < 1000; ++i)
+    {
+        static_cast<std::string *>(live[i])->~basic_string();
+        pool.release(live[i]);
+    }
+    CHECK(pool.size() == 0);
+}
+
+class alignas(64) Wide
+{
+public:
+    char bytes[64];
+};
+
+static void testAlignment()
+{
+    NodePool<Wide> pool;
+    for (int i = 0; i < 100; ++i) CHECK((uintptr_t)pool.allocate() % 64 == 0);
+}
+
+/**
+ * After absorb, blocks from either pool are released into the survivor and reused,
+ * including the other pool's unused fresh blocks, before it grows again.
+ */
+static void testAbsorb()
+{
+    NodePool<long long> a, b, empty;
+    std::vector<void *> fromA, fromB;
+    for (int i = 0; i < 20; ++i) fromA.push_back(a.allocate());
+    for (int i = 0; i < 40; ++i) fromB.push_back(b.allocate());
+    for (int i = 0; i < 5; ++i) a.release(fromA.back()), fromA.pop_back();
+    for (int i = 0; i < 7; ++i) b.release(fromB.back()), fromB.pop_back();
+    int capacity = a.capacity() + b.capacity();
+    a.absorb(b);
+    a.absorb(a);
+    a.absorb(empty);
+    CHECK(b.size() == 0 && b.capacity() == 0);
+    CHECK(a.size() == 15 + 33 && a.capacity() == capacity);
+    for (size_t i = 0; i < fromB.size(); ++i) a.release(fromB[i]);
+    fromB.clear();
+    // every block of both pools' slabs can now be handed out without a new slab
+    std::set<void *> distinct(fromA.begin(), fromA.end());
+    while (a.size() < capacity) distinct.insert(a.allocate());
+    CHECK((int)distinct.size() == capacity && a.capacity() == capacity);
+    a.allocate();
+    CHECK(a.capacity() > capacity);
+    // the emptied pool still works on its own
+    void *p = b.allocate();
+    CHECK(b.size() == 1 && p != NULL);
+    b.release(p);
+}
+
+/**
+ * Blocks from allocateOne() are released into the pool that adopted them, reused from
+ * it, and freed with it; adoption records move with absorb.
+ */
+static void testAdopt()
+{
+    NodePool<long long> pool, other;
+    std::vector<void *> loose;
+    for (int i = 0; i < 40; ++i)
+    {
+        loose.push_back(NodePool<long long>::allocateOne());
+        *static_cast<long long *>(loose.back()) = i;
+    }
+    NodePool<long long>::releaseOne(loose.back());
+    loose.pop_back();
+    for (int i = 0; i < 30; ++i) pool.adopt(loose[i]);
+    for (int i = 30; i < 39; ++i) other.adopt(loose[i]);
+    CHECK(pool.size() == 30 && pool.capacity() == 30 && other.size() == 9);
+    for (int i = 0; i < 39; ++i) CHECK(*static_cast<long long *>(loose[i]) == i);
+    pool.release(loose[7]);
+    CHECK(pool.size() == 29 && pool.allocate() == loose[7]);
+    pool.absorb(other);
+    CHECK(pool.size() == 39 && pool.capacity() == 39 && other.capacity() == 0);
+    for (int i = 30; i < 39; ++i) pool.release(loose[i]);
+    std::set<void *> reused;
+    for (int i = 0; i < 9; ++i) reused.insert(pool.allocate());
+    CHECK(reused == std::set<void *>(loose.begin() + 30, loose.end()) && pool.capacity() == 39);
+    pool.allocate();
+    CHECK(pool.capacity() > 39);
+    // the destructors free every adopted block; the sanitizer reports any leak
+}
+
+/**
+ * A default list up to 16 elements allocates its nodes and nothing else; past that it
+ * gets a pool that adopts them, so their addresses hold.
+ */
+static void testShortLists()
+{
+    std::vector<const int *> at(16);
+    long long before = allocations;
+    {
+        LinkedList<int> l;
+        for (int i = 0; i < 16; ++i) l.addLast(i), at[i] = &l.getLast();
+        CHECK(allocations - before == 16);
+        for (int i = 0; i < 100; ++i) l.removeFirst(), l.addLast(i);
+        CHECK(allocations - before == 116);
+        LinkedList<int> copy(l);
+        CHECK(allocations - before == 132);
+        l.clear();
+        for (int i = 0; i < 16; ++i) l.addLast(i), at[i] = &l.getLast();
+        before = allocations;
+        for (int i = 16; i < 100; ++i) l.addLast(i);
+        // the pool, its slabs of 16, 32 and 64 nodes, and a record of the 16 adopted ones
+        CHECK(allocations - before == 5);
+        for (int i = 0; i < 16; ++i) CHECK(&l.get(i) == at[i] && *at[i] == i);
+        while (l.size() > 1) l.removeFirst();
+        for (int i = 0; i < 1000; ++i) l.addFirst(i), l.removeLast();
+        CHECK(allocations - before == 5 && l.getFirst() == 999);
+        // two short lists relink without a pool
+        LinkedList<int> a, b;
+        for (int i = 0; i < 10; ++i) a.addLast(i), b.addLast(10 + i);
+        const int *p = &b.getFirst();
+        a.concat(b);
+        CHECK(a.size() == 20 && &a.get(10) == p && b.isEmpty());
+        a.addLast(20);
+        CHECK(&a.get(10) == p && a.getLast() == 20);
+    }
+}
+
+/**
+ * A private pool per list by default; lists built on one shared pool reuse each other's
+ * freed nodes, so churning between them does not grow the pool.
+ */
+static void testLists()
+{
+    LinkedList<std::string>::Pool shared;
+    {
+        LinkedList<std::string> a(shared), b(shared);
+        for (int i = 0; i < 500; ++i) a.addLast(std::to_string(i));
+        CHECK(shared.size() == 500);
+        int capacity = shared.capacity();
+        for (int round = 0; round < 20; ++round)
+        {
+            while (!a.isEmpty())
+            {
+                b.addLast(a.getFirst());
+                a.removeFirst();
+            }
+            while (!b.isEmpty())
+            {
+                a.addFirst(b.getLast());
+                b.removeLast();
+            }
+        }
+        CHECK(shared.capacity() == capacity && shared.size() == 500);
+        LinkedList<std::string> copy(a);
+        CHECK(shared.size() == 1000 && copy.size() == 500 && copy.getLast() == "499");
+        LinkedList<std::string> own;
+        own = a;
+        CHECK(shared.size() == 1000 && own.getFirst() == "0");
+    }
+    CHECK(shared.size() == 0);
+}
+
+int main()
+{
+    testPool();
+    testAlignment();
+    testAbsorb();
+    testAdopt();
+    testLists();
+    testShortLists();
+    std::puts("NodePoolTest: ok");
+    return 0;
+}
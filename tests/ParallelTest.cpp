@@ -0,0 +1,97 @@
+/**
+ * @file
+ * Checks ArrayList::sort and the parallel loops against sequential results, for sizes
+ * on both sides of the parallel threshold and for several thread counts.
+ *
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=address,undefined -I. tests/ParallelTest.cpp -o ParallelTest
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=thread -I. tests/ParallelTest.cpp -o ParallelTest
+ */
+#include "ArrayList.h"
+#include "Check.h"
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+static void testSort()
+{
+    TestRandom random;
+    const int sizes[] = { 0, 1, 2, 17, 1000, Parallel::GRAIN * 2 + 7, Parallel::GRAIN * 5 + 3 };
+    const int threads[] = { 1, 2, 3, 4, 7 };
+    for (int n : sizes)
+        for (int t : threads)
+        {
+            ArrayList<int> list;
+            std::vector<int> ref;
+            // many duplicates and a sorted prefix exercise ties and uneven runs
+            for (int i = 0; i < n; ++i)
+            {
+                int v = i < n / 4 ? i : random.below(n / 3 + 1);
+                list.add(v), ref.push_back(v);
+            }
+            list.sort([](int a, int b) { return a < b; }, t);
+            std::sort(ref.begin(), ref.end());
+            CHECK(list.size() == n);
+            for (int i = 0; i < n; ++i) CHECK(list.get(i) == ref[i]);
+        }
+}
+
+static void testSortStrings()
+{
+    TestRandom random(7);
+    int n = Parallel::GRAIN * 3 + 11;
+    ArrayList<std::string> list;
+    std::vector<std::string> ref;
+    for (int i = 0; i < n; ++i)
+    {
+        std::string s = std::to_string(random.next());
+        list.add(s), ref.push_back(s);
+    }
+    list.sort([](const std::string& a, const std::string& b) { return a > b; }, 4);
+    std::sort(ref.begin(), ref.end(), [](const std::string& a, const std::string& b) { return a > b; });
+    for (int i = 0; i < n; ++i) CHECK(list.get(i) == ref[i]);
+}
+
+static void testLoops()
+{
+    const int sizes[] = { 0, 5, Parallel::GRAIN * 4 + 1 };
+    for (int n : sizes)
+        for (int t = 1; t <= 5; ++t)
+        {
+            ArrayList<long long> list;
+            for (int i = 0; i < n; ++i) list.add(i);
+            list.parallelTransform([](long long x) { return x * 3; }, t);
+            std::atomic<long long> seen(0);
+            list.parallelForEach([&](long long& x) { seen += x; ++x; }, t);
+            long long expected = 3LL * n * (n - 1) / 2;
+            CHECK(seen.load() == expected);
+            CHECK(list.parallelReduce(0, [](long long a, long long b) { return a + b; }, t) == expected + n);
+            for (int i = 0; i < n; ++i) CHECK(list.get(i) == 3LL * i + 1);
+        }
+}
+
+static void testNested()
+{
+    // a parallel call from inside a parallel callback must not deadlock the shared pool
+    int n = Parallel::GRAIN * 4;
+    ArrayList<int> outer;
+    for (int i = 0; i < 4; ++i) outer.add(i);
+    std::atomic<long long> total(0);
+    Parallel::forParts(4, 4, [&](int p, int, int)
+    {
+        ArrayList<int> inner;
+        for (int i = 0; i < n; ++i) inner.add(p);
+        total += inner.parallelReduce(0, [](int a, int b) { return a + b; }, 4);
+    });
+    CHECK(total.load() == (long long)n * (0 + 1 + 2 + 3));
+}
+
+int main()
+{
+    testSort();
+    testSortStrings();
+    testLoops();
+    testNested();
+    std::puts("ParallelTest: ok");
+    return 0;
+}
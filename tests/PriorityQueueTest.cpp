@@ -0,0 +1,120 @@
+/**
+ * @file
+ * Tests PriorityQueue against std::multiset: push, pop and front across growth, iteration
+ * over every element, Iterator::remove at any heap position, element types without a
+ * default constructor, and copies.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/PriorityQueueTest.cpp -o PriorityQueueTest
+ */
+#include "PriorityQueue.h"
+#include "Check.h"
+#include <set>
+
+static void same(PriorityQueue<int>& q, const std::multiset<int>& ref)
+{
+    CHECK(q.size() == (int)ref.size());
+    CHECK(q.empty() == ref.empty());
+    if (!ref.empty()) CHECK(q.front() == *ref.begin());
+    std::multiset<int> seen;
+    for (PriorityQueue<int>::Iterator itr = q.iterator(); itr.hasNext();) seen.insert(itr.next());
+    CHECK(seen == ref);
+}
+
+static void testDifferential()
+{
+    TestRandom random;
+    PriorityQueue<int> q(2);
+    std::multiset<int> ref;
+    for (int step = 0; step < 30000; ++step)
+    {
+        switch (random.below(5))
+        {
+        case 0:
+        case 1:
+        {
+            int v = random.below(1000);
+            q.push(v), ref.insert(v);
+            break;
+        }
+        case 2:
+            if (!ref.empty())
+            {
+                CHECK(q.front() == *ref.begin());
+                q.pop(), ref.erase(ref.begin());
+            }
+            break;
+        case 3:
+            if (random.below(20) == 0)
+            {
+                // remove a random subset through an iterator; every element is still visited
+                int visited = 0, n = (int)ref.size();
+                for (PriorityQueue<int>::Iterator itr = q.iterator(); itr.hasNext(); ++visited)
+                {
+                    int v = itr.next();
+                    if (random.below(4) == 0) itr.remove(), ref.erase(ref.find(v));
+                }
+                CHECK(visited == n);
+            }
+            break;
+        case 4:
+            if (random.below(50) == 0)
+            {
+                PriorityQueue<int> copy(q);
+                same(copy, ref);
+            }
+            break;
+        }
+        if (step % 733 == 0) same(q, ref);
+    }
+    same(q, ref);
+    // draining pops in sorted order
+    for (std::multiset<int>::iterator i = ref.begin(); i != ref.end(); ++i)
+    {
+        CHECK(q.front() == *i);
+        q.pop();
+    }
+    CHECK(q.empty());
+    CHECK_THROWS(ElementNotExist, q.pop());
+    CHECK_THROWS(ElementNotExist, q.front());
+    PriorityQueue<int>::Iterator itr = q.iterator();
+    CHECK(!itr.hasNext());
+    CHECK_THROWS(ElementNotExist, itr.next());
+    CHECK_THROWS(ElementNotExist, itr.remove());
+}
+
+class NoDefault
+{
+public:
+    int v;
+    explicit NoDefault(int v):v(v) {}
+    bool operator<(const NoDefault& o) const { return v < o.v; }
+};
+
+/**
+ * No default constructor is needed, including when the heap grows while an iterator is
+ * live: the iterator keeps walking the same nodes.
+ */
+static void testNoDefaultConstructor()
+{
+    PriorityQueue<NoDefault> q(2);
+    for (int i = 10; i > 0; --i) q.push(NoDefault(i));
+    PriorityQueue<NoDefault>::Iterator itr = q.iterator();
+    CHECK(itr.next().v == 10);
+    for (int i = 11; i <= 100; ++i) q.push(NoDefault(i));
+    int count = 1;
+    for (; itr.hasNext(); ++count) itr.next();
+    CHECK(count == 100);
+    for (int i = 1; i <= 100; ++i)
+    {
+        CHECK(q.front().v == i);
+        q.pop();
+    }
+}
+
+int main()
+{
+    testDifferential();
+    testNoDefaultConstructor();
+    std::puts("PriorityQueueTest: ok");
+    return 0;
+}
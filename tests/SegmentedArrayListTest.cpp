@@ -0,0 +1,175 @@
+/**
+ * @file
+ * Tests of SegmentedArrayList: element addresses saved while the list grows through
+ * many chunk-directory expansions stay valid and keep their values; and a randomized
+ * differential test against std::vector of every operation, with small chunks so that
+ * shifts cross chunk boundaries, for a type that counts its live objects.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/SegmentedArrayListTest.cpp -o SegmentedArrayListTest
+ */
+#include "SegmentedArrayList.h"
+#include "Check.h"
+#include <string>
+#include <vector>
+
+/**
+ * Counts live objects, to check that nothing leaks or is destroyed twice.
+ */
+class Counted
+{
+public:
+    static int live;
+    std::string value;
+
+    Counted(const std::string& value = ""):value(value) { ++live; }
+    Counted(const Counted& x):value(x.value) { ++live; }
+    Counted(Counted&& x):value(std::move(x.value)) { ++live; }
+    Counted& operator=(const Counted& x) { value = x.value; return *this; }
+    Counted& operator=(Counted&& x) { value = std::move(x.value); return *this; }
+    ~Counted() { --live; }
+    bool operator==(const Counted& x) const { return value == x.value; }
+};
+
+int Counted::live = 0;
+
+/**
+ * Appending never moves an element: with 4-element chunks the directory starts at 8
+ * chunks and doubles past 16, 32, ... 16384 while the saved addresses stay put.
+ */
+static void testAddressStability()
+{
+    SegmentedArrayList<Counted, 2> l;
+    std::vector<const Counted *> saved;
+    for (int i = 0; i < 40; ++i)
+    {
+        l.emplace(std::to_string(i));
+        saved.push_back(&l.get(i));
+    }
+    for (int i = 40; i < 50000; ++i) l.add(Counted(std::to_string(i)));
+    for (int i = 0; i < 40; ++i) CHECK(&l.get(i) == saved[i] && saved[i]->value == std::to_string(i));
+    for (int i = 0; i < 50000; i += 997) CHECK(l.get(i).value == std::to_string(i));
+    // removing from the end and growing again keeps the rest in place too
+    for (int i = 0; i < 49000; ++i) l.removeLast();
+    l.shrinkToFit();
+    for (int i = 1000; i < 30000; ++i) l.add(Counted(std::to_string(i)));
+    for (int i = 0; i < 40; ++i) CHECK(&l.get(i) == saved[i] && saved[i]->value == std::to_string(i));
+    CHECK(l.size() == 30000 && Counted::live == 30000);
+}
+
+template <int B>
+static void same(const SegmentedArrayList<Counted, B>& l, const std::vector<std::string>& ref)
+{
+    CHECK(l.size() == (int)ref.size() && l.isEmpty() == ref.empty());
+    for (int i = 0; i < (int)ref.size(); ++i) CHECK(l.get(i).value == ref[i]);
+}
+
+template <int B>
+static void testDifferential(unsigned long long seed)
+{
+    TestRandom random(seed);
+    SegmentedArrayList<Counted, B> l;
+    std::vector<std::string> ref;
+    for (int step = 0; step < 30000; ++step)
+    {
+        std::string s = std::to_string(random.below(100));
+        int n = (int)ref.size();
+        switch (random.below(12))
+        {
+        case 0:
+        case 1:
+            l.add(Counted(s)), ref.push_back(s);
+            break;
+        case 2:
+            l.emplace(s), ref.push_back(s);
+            break;
+        case 3:
+        {
+            int i = random.below(n + 1);
+            l.add(i, Counted(s)), ref.insert(ref.begin() + i, s);
+            break;
+        }
+        case 4:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                CHECK(l.get(i).value == ref[i]);
+                l.set(i, Counted(s)), ref[i] = s;
+            }
+            else CHECK_THROWS(IndexOutOfBound, l.get(0));
+            break;
+        case 5:
+            if (n > 0)
+            {
+                int i = random.below(n);
+                l.removeIndex(i), ref.erase(ref.begin() + i);
+            }
+            else CHECK_THROWS(IndexOutOfBound, l.removeIndex(0));
+            break;
+        case 6:
+            if (n > 0) l.removeLast(), ref.pop_back();
+            else CHECK_THROWS(ElementNotExist, l.removeLast());
+            break;
+        case 7:
+        {
+            bool found = false;
+            for (int i = 0; i < n; ++i) found = found || (ref[i] == s);
+            CHECK(l.contains(Counted(s)) == found);
+            break;
+        }
+        case 8:
+        {
+            // iterating, removing about one element in three
+            int position = -1;
+            typename SegmentedArrayList<Counted, B>::Iterator itr = l.iterator();
+            while (itr.hasNext())
+            {
+                CHECK(itr.next().value == ref[++position]);
+                if (random.below(3) == 0) itr.remove(), ref.erase(ref.begin() + position--);
+            }
+            CHECK(position == (int)ref.size() - 1);
+            CHECK_THROWS(ElementNotExist, itr.next());
+            break;
+        }
+        case 9:
+        {
+            int seen = 0;
+            l.forEachChunk([&](const Counted *chunk, int k)
+            {
+                CHECK(k > 0 && k <= (1 << B));
+                for (int i = 0; i < k; ++i, ++seen) CHECK(chunk[i].value == ref[seen]);
+            });
+            CHECK(seen == n);
+            break;
+        }
+        case 10:
+        {
+            SegmentedArrayList<Counted, B> copy(l);
+            same(copy, ref);
+            copy.add(Counted("x"));
+            copy = l;
+            same(copy, ref);
+            break;
+        }
+        case 11:
+            if (random.below(100) == 0) l.clear(), ref.clear();
+            if (random.below(20) == 0) l.shrinkToFit();
+            break;
+        }
+        CHECK(l.size() == (int)ref.size());
+        if (step % 499 == 0) same(l, ref);
+    }
+    same(l, ref);
+    CHECK(Counted::live == (int)ref.size());
+}
+
+int main()
+{
+    testAddressStability();
+    CHECK(Counted::live == 0);
+    testDifferential<1>(1);
+    testDifferential<3>(2);
+    testDifferential<10>(3);
+    CHECK(Counted::live == 0);
+    std::puts("SegmentedArrayListTest: ok");
+    return 0;
+}
@@ -0,0 +1,238 @@
+/**
+ * @file
+ * Randomized differential tests of SortedArrayList against std::multiset, with keys from
+ * a small range so that most are duplicated, long runs of adds that keep the side buffer
+ * full and merge it many times, and lookups of keys on both sides of every merge. Also
+ * tests ArrayList's sorted lookups and mergeSorted, which it is built on, against
+ * std::lower_bound, std::upper_bound and std::merge.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/SortedArrayListTest.cpp -o SortedArrayListTest
+ */
+#include "SortedArrayList.h"
+#include "Check.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <vector>
+
+/**
+ * Descending order, to check that the comparator is used everywhere.
+ */
+class Greater
+{
+public:
+    bool operator()(int a, int b) const
+    {
+        return a > b;
+    }
+};
+
+/**
+ * Checks l against ref element by element and through every lookup.
+ */
+template <class C, class R>
+static void same(SortedArrayList<int, C>& l, const R& ref, int keys)
+{
+    CHECK(l.size() == (int)ref.size() && l.isEmpty() == ref.empty());
+    std::vector<int> sorted(ref.begin(), ref.end());
+    for (int i = 0; i < (int)sorted.size(); ++i) CHECK(l.get(i) == sorted[i]);
+    int n = 0;
+    for (typename SortedArrayList<int, C>::Iterator itr = l.iterator(); itr.hasNext(); ++n) CHECK(itr.next() == sorted[n]);
+    CHECK(n == (int)sorted.size());
+    for (int k = -1; k <= keys; ++k)
+    {
+        int lower = (int)(std::lower_bound(sorted.begin(), sorted.end(), k, ref.key_comp()) - sorted.begin());
+        int upper = (int)(std::upper_bound(sorted.begin(), sorted.end(), k, ref.key_comp()) - sorted.begin());
+        CHECK(l.lowerBound(k) == lower && l.upperBound(k) == upper);
+        CHECK(l.binarySearch(k) == (lower == upper ? -1 : lower));
+    }
+}
+
+template <class C, class R>
+static void testDifferential(unsigned long long seed, int keys)
+{
+    TestRandom random(seed);
+    SortedArrayList<int, C> l;
+    R ref;
+    for (int step = 0; step < 40000; ++step)
+    {
+        int k = random.below(keys);
+        switch (random.below(12))
+        {
+        case 0:
+        case 1:
+        case 2:
+        case 3:
+        case 4:
+            l.add(k), ref.insert(k);
+            break;
+        case 5:
+        {
+            // a batch, sometimes large enough to dwarf the list
+            std::vector<int> batch;
+            for (int i = random.below(random.below(10) == 0 ? 2000 : 40); i > 0; --i) batch.push_back(random.below(keys));
+            l.addAll(batch.begin(), batch.end());
+            ref.insert(batch.begin(), batch.end());
+            break;
+        }
+        case 6:
+        case 7:
+            // answered from the main array and the side buffer without merging
+            CHECK(l.contains(k) == (ref.count(k) > 0));
+            break;
+        case 8:
+        {
+            typename R::iterator i = ref.find(k);
+            CHECK(l.remove(k) == (i != ref.end()));
+            if (i != ref.end()) ref.erase(i);
+            break;
+        }
+        case 9:
+            if (!ref.empty())
+            {
+                int i = random.below((int)ref.size());
+                typename R::iterator at = ref.begin();
+                std::advance(at, i);
+                CHECK(l.get(i) == *at);
+                l.removeIndex(i), ref.erase(at);
+            }
+            else CHECK_THROWS(IndexOutOfBound, l.removeIndex(0));
+            break;
+        case 10:
+            if (random.below(20) == 0)
+            {
+                // iterating removes every element not above a threshold
+                int threshold = random.below(keys);
+                for (typename SortedArrayList<int, C>::Iterator itr = l.iterator(); itr.hasNext();)
+                    if (!C()(threshold, itr.next())) itr.remove();
+                for (typename R::iterator i = ref.begin(); i != ref.end();)
+                    if (!C()(threshold, *i)) ref.erase(i++);
+                    else ++i;
+            }
+            break;
+        case 11:
+            if ((random.below(500) == 0) || (ref.size() > 8000)) l.clear(), ref.clear();
+            break;
+        }
+        CHECK(l.size() == (int)ref.size());
+        if (step % 2003 == 0) same(l, ref, keys);
+    }
+    same(l, ref, keys);
+}
+
+/**
+ * Adds only, so the side buffer fills and merges over and over as the list grows, and
+ * checks every key right before and right after each merge.
+ */
+static void testMergeBoundaries()
+{
+    TestRandom random(9);
+    SortedArrayList<int> l;
+    std::multiset<int> ref;
+    for (int i = 0; i < 20000; ++i)
+    {
+        int k = random.below(64);
+        l.add(k), ref.insert(k);
+        // the buffer holds at least 32 elements before it merges
+        if ((i % 32 == 31) || (i % 32 == 0))
+            for (int j = -1; j <= 64; ++j) CHECK(l.contains(j) == (ref.count(j) > 0));
+    }
+    same(l, ref, 64);
+    // removing everything one key at a time, from the buffer first
+    for (int i = 0; i < 500; ++i) l.add(i % 64), ref.insert(i % 64);
+    for (int k = 0; k < 64; ++k)
+    {
+        int n = (int)ref.count(k);
+        for (int i = 0; i < n; ++i) CHECK(l.remove(k));
+        CHECK(!l.remove(k) && !l.contains(k));
+    }
+    CHECK(l.isEmpty() && l.size() == 0);
+}
+
+/**
+ * A key and the order it was made in; ordered by key alone.
+ */
+class Item
+{
+public:
+    int key, id;
+
+    Item(int key = 0, int id = 0):key(key), id(id) {}
+};
+
+class ItemLess
+{
+public:
+    bool operator()(const Item& a, const Item& b) const
+    {
+        return a.key < b.key;
+    }
+};
+
+/**
+ * ArrayList::mergeSorted keeps the elements of this list before equivalent elements of
+ * x, as std::merge does, leaves x empty, and merges a list with itself.
+ */
+static void testMergeSorted()
+{
+    TestRandom random(10);
+    int id = 0;
+    for (int round = 0; round < 2000; ++round)
+    {
+        std::vector<Item> a, b;
+        for (int i = round % 10 == 0 ? 0 : random.below(40); i > 0; --i) a.push_back(Item(random.below(20), id++));
+        for (int i = round % 7 == 0 ? 0 : random.below(40); i > 0; --i) b.push_back(Item(random.below(20), id++));
+        std::stable_sort(a.begin(), a.end(), ItemLess());
+        std::stable_sort(b.begin(), b.end(), ItemLess());
+        std::vector<Item> merged;
+        std::merge(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(merged), ItemLess());
+        ArrayList<Item> x, y;
+        x.addAll(0, a.begin(), a.end());
+        y.addAll(0, b.begin(), b.end());
+        x.mergeSorted(y, ItemLess());
+        CHECK(y.isEmpty() && x.size() == (int)merged.size());
+        for (int i = 0; i < x.size(); ++i) CHECK(x.get(i).id == merged[i].id);
+
+        ArrayList<Item> self;
+        self.addAll(0, a.begin(), a.end());
+        self.mergeSorted(self, ItemLess());
+        CHECK(self.size() == 2 * (int)a.size());
+        for (int i = 0; i + 1 < self.size(); ++i) CHECK(self.get(i).key <= self.get(i + 1).key);
+    }
+}
+
+/**
+ * ArrayList's lowerBound, upperBound and binarySearch against the standard algorithms.
+ */
+static void testBounds()
+{
+    TestRandom random(11);
+    for (int round = 0; round < 2000; ++round)
+    {
+        std::vector<int> v;
+        for (int i = random.below(50); i > 0; --i) v.push_back(random.below(15));
+        std::sort(v.begin(), v.end());
+        ArrayList<int> l;
+        l.addAll(0, v.begin(), v.end());
+        for (int k = -1; k <= 15; ++k)
+        {
+            int lower = (int)(std::lower_bound(v.begin(), v.end(), k) - v.begin());
+            int upper = (int)(std::upper_bound(v.begin(), v.end(), k) - v.begin());
+            CHECK(l.lowerBound(k, Less<int>()) == lower && l.upperBound(k, Less<int>()) == upper);
+            CHECK(l.binarySearch(k, Less<int>()) == (lower == upper ? -1 : lower));
+        }
+    }
+}
+
+int main()
+{
+    testDifferential<Less<int>, std::multiset<int> >(1, 50);
+    testDifferential<Less<int>, std::multiset<int> >(2, 5000);
+    testDifferential<Greater, std::multiset<int, Greater> >(3, 50);
+    testMergeBoundaries();
+    testMergeSorted();
+    testBounds();
+    std::puts("SortedArrayListTest: ok");
+    return 0;
+}
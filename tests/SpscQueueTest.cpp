@@ -0,0 +1,97 @@
+/**
+ * @file
+ * Tests SpscQueue on one thread (full, empty, batches, n <= 0, element lifetimes) and
+ * between a producer and a consumer thread, checking that every element arrives once
+ * and in order.
+ *
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=address,undefined -I. tests/SpscQueueTest.cpp -o SpscQueueTest
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=thread -I. tests/SpscQueueTest.cpp -o SpscQueueTest
+ */
+#include "SpscQueue.h"
+#include "Check.h"
+#include <string>
+#include <thread>
+
+static void testSingleThread()
+{
+    SpscQueue<std::string> q(5);
+    CHECK(q.capacity() == 8);
+    CHECK(q.isEmpty());
+    std::string out;
+    CHECK(!q.tryPop(out));
+    for (int i = 0; i < 8; ++i) CHECK(q.tryPush(std::to_string(i)));
+    CHECK(!q.tryPush("full"));
+    CHECK(q.size() == 8);
+
+    std::string items[4] = { "a", "b", "c", "d" };
+    std::string popped[8];
+    CHECK(q.tryPushBatch(items, 4) == 0);
+    CHECK(q.tryPushBatch(items, 0) == 0);
+    CHECK(q.tryPushBatch(items, -1) == 0);
+    CHECK(q.tryPopBatch(popped, 0) == 0);
+    CHECK(q.tryPopBatch(popped, -5) == 0);
+    CHECK(q.tryPopBatch(popped, 3) == 3);
+    CHECK(popped[0] == "0" && popped[2] == "2");
+    CHECK(q.tryPushBatch(items, 4) == 3);
+    CHECK(q.tryPopBatch(popped, 8) == 8);
+    CHECK(popped[0] == "3" && popped[4] == "7" && popped[5] == "a" && popped[7] == "c");
+    CHECK(q.isEmpty());
+
+    // elements left in the queue are destroyed with it
+    for (int i = 0; i < 5; ++i) q.tryPush(std::string(100, 'x'));
+}
+
+static void testProducerConsumer()
+{
+    const int N = 1000000;
+    SpscQueue<long long> q(64);
+    std::thread producer([&]()
+    {
+        TestRandom random(1);
+        long long next = 0, batch[16];
+        while (next < N)
+        {
+            if (random.below(2))
+            {
+                if (q.tryPush(next)) ++next;
+                else std::this_thread::yield();
+            }
+            else
+            {
+                int n = 1 + random.below(16);
+                if (n > N - next) n = (int)(N - next);
+                for (int i = 0; i < n; ++i) batch[i] = next + i;
+                int pushed = q.tryPushBatch(batch, n);
+                if (pushed == 0) std::this_thread::yield();
+                next += pushed;
+            }
+        }
+    });
+    TestRandom random(2);
+    long long expected = 0, batch[16];
+    while (expected < N)
+    {
+        long long v;
+        if (random.below(2))
+        {
+            if (q.tryPop(v)) CHECK(v == expected++);
+            else std::this_thread::yield();
+        }
+        else
+        {
+            int k = q.tryPopBatch(batch, 1 + random.below(16));
+            if (k == 0) std::this_thread::yield();
+            for (int i = 0; i < k; ++i) CHECK(batch[i] == expected++);
+        }
+    }
+    producer.join();
+    CHECK(q.isEmpty());
+}
+
+int main()
+{
+    testSingleThread();
+    testProducerConsumer();
+    std::puts("SpscQueueTest: ok");
+    return 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file
+ * Tests TaskScheduler: recursive fork-join with nested waits, many independent counters,
+ * spawning from several outside threads at once, and a destructor that finishes pending
+ * tasks, for several pool sizes; that parked workers are woken for tasks pushed both to
+ * the injection queue and to a worker's own deque; and that an idle pool stays asleep.
+ *
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=address,undefined -I. tests/TaskSchedulerTest.cpp -o TaskSchedulerTest
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=thread -I. tests/TaskSchedulerTest.cpp -o TaskSchedulerTest
+ */
+#include "TaskScheduler.h"
+#include "Check.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+
+static long long fib(TaskScheduler& pool, int n)
+{
+    if (n < 2) return n;
+    TaskScheduler::Counter done;
+    long long a = 0, b = 0;
+    pool.spawn(done, [&pool, &a, n]() { a = fib(pool, n - 1); });
+    pool.spawn(done, [&pool, &b, n]() { b = fib(pool, n - 2); });
+    pool.wait(done);
+    return a + b;
+}
+
+/**
+ * Sums [from, to) by splitting it in halves down to leaves of 16 elements.
+ */
+static long long sum(TaskScheduler& pool, const std::vector<int>& v, int from, int to)
+{
+    if (to - from <= 16)
+    {
+        long long s = 0;
+        for (int i = from; i < to; ++i) s += v[i];
+        return s;
+    }
+    int mid = from + (to - from) / 2;
+    TaskScheduler::Counter done;
+    long long left = 0;
+    pool.spawn(done, [&]() { left = sum(pool, v, from, mid); });
+    long long right = sum(pool, v, mid, to);
+    pool.wait(done);
+    return left + right;
+}
+
+static void testForkJoin(int threads)
+{
+    TaskScheduler pool(threads);
+    CHECK(pool.size() == threads);
+    CHECK(fib(pool, 18) == 2584);
+    std::vector<int> v;
+    for (int i = 0; i < 100000; ++i) v.push_back(i % 1000 - 300);
+    long long expected = 0;
+    for (int x : v) expected += x;
+    CHECK(sum(pool, v, 0, (int)v.size()) == expected);
+    CHECK(sum(pool, v, 0, 0) == 0);
+}
+
+/**
+ * Many groups in flight at once; each counter reports done only after its own tasks.
+ */
+static void testCounters(int threads)
+{
+    TaskScheduler pool(threads);
+    const int GROUPS = 50, TASKS = 40;
+    std::vector<TaskScheduler::Counter> done(GROUPS);
+    std::vector<std::atomic<int>> ran(GROUPS);
+    for (int g = 0; g < GROUPS; ++g) ran[g].store(0);
+    for (int g = 0; g < GROUPS; ++g)
+        for (int t = 0; t < TASKS; ++t) pool.spawn(done[g], [&ran, g]() { ran[g].fetch_add(1); });
+    for (int g = GROUPS - 1; g >= 0; --g)
+    {
+        pool.wait(done[g]);
+        CHECK(done[g].isDone());
+        CHECK(ran[g].load() == TASKS);
+    }
+    TaskScheduler::Counter empty;
+    CHECK(empty.isDone());
+    pool.wait(empty);
+}
+
+/**
+ * Several non-worker threads spawn into the injection queue and wait concurrently.
+ */
+static void testOutsideSpawners(int threads)
+{
+    TaskScheduler pool(threads);
+    std::atomic<long long> total(0);
+    std::vector<std::thread> spawners;
+    for (int k = 0; k < 4; ++k)
+        spawners.push_back(std::thread([&pool, &total, k]()
+        {
+            TaskScheduler::Counter done;
+            for (int i = 0; i < 2000; ++i)
+                pool.spawn(done, [&pool, &total, &done, k, i]()
+                {
+                    total.fetch_add(k + 1);
+                    // every tenth task forks children into the same group from inside the pool
+                    if (i % 10 == 0)
+                        for (int j = 0; j < 3; ++j) pool.spawn(done, [&total, k]() { total.fetch_add(k + 1); });
+                });
+            pool.wait(done);
+        }));
+    for (size_t k = 0; k < spawners.size(); ++k) spawners[k].join();
+    CHECK(total.load() == 2600LL * (1 + 2 + 3 + 4));
+}
+
+/**
+ * Tasks that spawn children from inside workers, waited on only by the pool-wide wait().
+ */
+static void testNestedSpawnAndWaitAll(int threads)
+{
+    std::atomic<int> count(0);
+    {
+        TaskScheduler pool(threads);
+        for (int i = 0; i < 100; ++i)
+            pool.spawn([&pool, &count]()
+            {
+                count.fetch_add(1);
+                for (int j = 0; j < 10; ++j) pool.spawn([&count]() { count.fetch_add(1); });
+            });
+        pool.wait();
+        CHECK(count.load() == 100 * 11);
+        // the destructor finishes tasks spawned but never waited for
+        for (int i = 0; i < 100; ++i) pool.spawn([&count]() { count.fetch_add(1); });
+    }
+    CHECK(count.load() == 100 * 12);
+}
+
+/**
+ * Spins until counter is done, without running tasks, so that only another worker can
+ * complete it. Fails after a few seconds instead of hanging.
+ */
+static void spinUntil(TaskScheduler::Counter& counter)
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!counter.isDone())
+    {
+        CHECK(std::chrono::steady_clock::now() < deadline);
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * Lets the workers run out of spins and park, then gives them one task at a time: from
+ * outside, through the injection queue, and from inside a task that spins on its child
+ * instead of running it, so a parked worker must be woken to steal it from the deque.
+ * Sleep lengths vary so that spawns land before, during and after workers go to sleep.
+ */
+static void testWakeUp(int threads)
+{
+    TaskScheduler pool(threads);
+    TestRandom random(threads);
+    for (int i = 0; i < 300; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(random.below(2000)));
+        TaskScheduler::Counter done;
+        std::atomic<int> ran(0);
+        if ((i % 2 == 0) || (threads < 2)) pool.spawn(done, [&ran]() { ran.fetch_add(1); });
+        else
+            pool.spawn(done, [&pool, &ran]()
+            {
+                TaskScheduler::Counter child;
+                pool.spawn(child, [&ran]() { ran.fetch_add(1); });
+                spinUntil(child);
+            });
+        spinUntil(done);
+        CHECK(ran.load() == 1);
+    }
+}
+
+static long contextSwitches()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+/**
+ * Workers of an idle pool park without a timeout: over half a second they do not wake
+ * up, where polling every millisecond would switch contexts thousands of times.
+ */
+static void testIdlePoolSleeps()
+{
+    TaskScheduler pool(4);
+    pool.spawn([]() {});
+    pool.wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    long before = contextSwitches();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    long switches = contextSwitches() - before;
+    CHECK(switches < 100);
+}
+
+int main()
+{
+    const int threads[] = { 1, 2, 4 };
+    for (int t : threads)
+    {
+        testForkJoin(t);
+        testCounters(t);
+        testOutsideSpawners(t);
+        testNestedSpawnAndWaitAll(t);
+        testWakeUp(t);
+    }
+    testIdlePoolSleeps();
+    std::puts("TaskSchedulerTest: ok");
+    return 0;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file
+ * Randomized differential tests of UnrolledLinkedList against std::vector, with small
+ * node sizes so that splits, merges and borrowing happen constantly. A counted element
+ * type checks that every element constructed is destroyed exactly once.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/UnrolledLinkedListTest.cpp -o UnrolledLinkedListTest
+ */
+#include "UnrolledLinkedList.h"
+#include "Check.h"
+#include <string>
+#include <vector>
+
+/**
+ * A string that counts its live instances.
+ */
+class Counted
+{
+public:
+    static int live;
+    std::string s;
+
+    Counted(const std::string& s):s(s) { ++live; }
+    Counted(const Counted& o):s(o.s) { ++live; }
+    Counted(Counted&& o):s(std::move(o.s)) { ++live; }
+    Counted& operator=(const Counted& o) { s = o.s; return *this; }
+    ~Counted() { --live; }
+    bool operator==(const Counted& o) const { return s == o.s; }
+};
+
+int Counted::live = 0;
+
+template <int N>
+static void same(UnrolledLinkedList<Counted, N>& l, const std::vector<Counted>& ref)
+{
+    CHECK(l.size() == (int)ref.size());
+    CHECK(l.isEmpty() == ref.empty());
+    typename UnrolledLinkedList<Counted, N>::Iterator itr = l.iterator();
+    for (size_t i = 0; i < ref.size(); ++i) CHECK(itr.hasNext() && itr.next() == ref[i]);
+    CHECK(!itr.hasNext());
+    for (int i = 0; i < (int)ref.size(); i += 7) CHECK(l.get(i) == ref[i]);
+    if (!ref.empty()) CHECK(l.getFirst() == ref.front() && l.getLast() == ref.back());
+}
+
+template <int N>
+static void testDifferential(unsigned long long seed)
+{
+    TestRandom random(seed);
+    {
+        UnrolledLinkedList<Counted, N> l;
+        std::vector<Counted> ref;
+        for (int step = 0; step < 30000; ++step)
+        {
+            Counted c(std::to_string(step));
+            int n = (int)ref.size();
+            // drift between growing and shrinking phases, so nodes both split and merge
+            bool grow = (step / 3000) % 2 == 0;
+            switch (random.below(grow ? 7 : 10))
+            {
+            case 0:
+            {
+                int i = random.below(n + 1);
+                l.add(i, c), ref.insert(ref.begin() + i, c);
+                break;
+            }
+            case 1:
+                l.addFirst(c), ref.insert(ref.begin(), c);
+                break;
+            case 2:
+                l.addLast(c), ref.push_back(c);
+                break;
+            case 3:
+                if (n > 0)
+                {
+                    int i = random.below(n);
+                    l.set(i, c), ref[i] = c;
+                }
+                break;
+            case 4:
+                if (n > 0)
+                {
+                    int i = random.below(n);
+                    CHECK(l.get(i) == ref[i]);
+                    CHECK(l.contains(ref[i]));
+                }
+                CHECK(!l.contains(Counted("absent")));
+                break;
+            case 5:
+                if (n > 0 && random.below(2))
+                {
+                    const Counted x = ref[random.below(n)];
+                    CHECK(l.remove(x));
+                    for (size_t i = 0; i < ref.size(); ++i)
+                        if (ref[i] == x)
+                        {
+                            ref.erase(ref.begin() + i);
+                            break;
+                        }
+                }
+                break;
+            case 6:
+                if (random.below(30) == 0)
+                {
+                    typename UnrolledLinkedList<Counted, N>::Iterator itr = l.iterator();
+                    std::vector<Counted> kept;
+                    while (itr.hasNext())
+                    {
+                        Counted v = itr.next();
+                        if (random.below(3) == 0) itr.remove();
+                        else kept.push_back(v);
+                    }
+                    ref.swap(kept);
+                }
+                break;
+            case 7:
+            case 8:
+                if (n > 0)
+                {
+                    int i = random.below(n);
+                    l.removeIndex(i), ref.erase(ref.begin() + i);
+                }
+                break;
+            case 9:
+                if (n > 0)
+                {
+                    if (random.below(2)) l.removeFirst(), ref.erase(ref.begin());
+                    else l.removeLast(), ref.pop_back();
+                }
+                break;
+            }
+            if (step % 601 == 0) same(l, ref);
+        }
+        same(l, ref);
+        UnrolledLinkedList<Counted, N> copy(l), assigned;
+        assigned.addLast(Counted("old"));
+        assigned = l;
+        same(copy, ref);
+        same(assigned, ref);
+        CHECK(!l.remove(Counted("absent")));
+        CHECK_THROWS(IndexOutOfBound, l.get((int)ref.size()));
+        CHECK_THROWS(IndexOutOfBound, l.add((int)ref.size() + 1, Counted("x")));
+        CHECK_THROWS(IndexOutOfBound, l.removeIndex(-1));
+        typename UnrolledLinkedList<Counted, N>::Iterator itr = l.iterator();
+        CHECK_THROWS(ElementNotExist, itr.remove());
+        while (itr.hasNext()) itr.next(), itr.remove();
+        CHECK(l.isEmpty());
+        CHECK_THROWS(ElementNotExist, itr.next());
+        CHECK_THROWS(ElementNotExist, l.getFirst());
+        CHECK_THROWS(ElementNotExist, l.removeLast());
+        copy.clear();
+        CHECK(copy.isEmpty());
+        copy.addLast(Counted("after clear"));
+        CHECK(copy.size() == 1);
+    }
+    CHECK(Counted::live == 0);
+}
+
+int main()
+{
+    testDifferential<4>(1);
+    testDifferential<5>(2);
+    testDifferential<8>(3);
+    testDifferential<64>(4);
+    std::puts("UnrolledLinkedListTest: ok");
+    return 0;
+}
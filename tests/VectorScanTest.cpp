@@ -0,0 +1,79 @@
+/**
+ * @file
+ * Checks the vector scans behind ArrayList::indexOf/lastIndexOf/count/contains against
+ * the scalar loops, for every element kind, length and alignment around the vector width.
+ * Build it once as is (SSE2) and once with -mavx2 to cover both kernels.
+ *
+ *      g++ -std=c++11 -Wall -fsanitize=address,undefined -I. tests/VectorScanTest.cpp -o VectorScanTest
+ */
+#include "ArrayList.h"
+#include "Check.h"
+#include <cmath>
+#include <vector>
+
+template <class T>
+static void testKind(TestRandom& random)
+{
+    typedef VectorScan::Scalar<T> Reference;
+    std::vector<T> buffer(200);
+    for (int n = 0; n <= 130; ++n)
+        for (int offset = 0; offset < 4; ++offset)
+        {
+            // few distinct values, so keys hit at several positions including both ends
+            for (int i = 0; i < n; ++i) buffer[offset + i] = (T)random.below(5);
+            const T *p = buffer.data() + offset;
+            for (int k = 0; k < 6; ++k)
+            {
+                T key = (T)k;
+                CHECK(VectorScan::Scan<T>::indexOf(p, n, key) == Reference::indexOf(p, n, key));
+                CHECK(VectorScan::Scan<T>::lastIndexOf(p, n, key) == Reference::lastIndexOf(p, n, key));
+                CHECK(VectorScan::Scan<T>::count(p, n, key) == Reference::count(p, n, key));
+            }
+        }
+}
+
+template <class T>
+static void testFloatingPoint()
+{
+    ArrayList<T> list;
+    for (int i = 0; i < 100; ++i) list.add((T)i);
+    list.set(50, std::nan(""));
+    list.set(70, (T)-0.0);
+    CHECK(list.indexOf(std::nan("")) == -1);
+    CHECK(!list.contains((T)std::nan("")));
+    CHECK(list.indexOf((T)0.0) == 0);
+    CHECK(list.lastIndexOf((T)0.0) == 70);
+    CHECK(list.count((T)0.0) == 2);
+}
+
+static void testThroughArrayList()
+{
+    ArrayList<int> list;
+    for (int i = 0; i < 1000; ++i) list.add(i % 100);
+    CHECK(list.indexOf(42) == 42);
+    CHECK(list.lastIndexOf(42) == 942);
+    CHECK(list.count(42) == 10);
+    CHECK(!list.contains(100));
+    ArrayList<int>::Iterator itr = list.iterator();
+    // scans must see the list without the elements removed through an iterator
+    for (int i = 0; i < 50; ++i) itr.next();
+    while (itr.hasNext()) if (itr.next() == 99) itr.remove();
+    CHECK(list.count(99) == 0);
+    CHECK(list.indexOf(0) == 0);
+}
+
+int main()
+{
+    TestRandom random;
+    testKind<signed char>(random);
+    testKind<unsigned short>(random);
+    testKind<int>(random);
+    testKind<long long>(random);
+    testKind<float>(random);
+    testKind<double>(random);
+    testFloatingPoint<float>();
+    testFloatingPoint<double>();
+    testThroughArrayList();
+    std::puts("VectorScanTest: ok");
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file
+ * Tests WorkStealingDeque on one thread (LIFO at the back, FIFO from the front, growth
+ * while wrapped) and with an owner racing several thieves, checking that every element
+ * is taken exactly once.
+ *
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=address,undefined -I. tests/WorkStealingDequeTest.cpp -o WorkStealingDequeTest
+ *      g++ -std=c++11 -Wall -pthread -fsanitize=thread -I. tests/WorkStealingDequeTest.cpp -o WorkStealingDequeTest
+ */
+#include "WorkStealingDeque.h"
+#include "Check.h"
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+static void testSingleThread()
+{
+    WorkStealingDeque<int> d(2);
+    std::deque<int> ref;
+    TestRandom random;
+    int x, next = 0;
+    CHECK(d.isEmpty() && !d.removeLast(x) && !d.steal(x));
+    for (int step = 0; step < 100000; ++step)
+    {
+        // drift between growing and draining phases, so the ring wraps before it grows
+        bool grow = (step / 5000) % 2 == 0;
+        switch (random.below(grow ? 4 : 6))
+        {
+        case 0:
+        case 1:
+        case 2:
+            d.addLast(next), ref.push_back(next++);
+            break;
+        case 3:
+        case 4:
+            if (ref.empty()) CHECK(!d.removeLast(x));
+            else
+            {
+                CHECK(d.removeLast(x) && x == ref.back());
+                ref.pop_back();
+            }
+            break;
+        case 5:
+            if (ref.empty()) CHECK(!d.steal(x));
+            else
+            {
+                CHECK(d.steal(x) && x == ref.front());
+                ref.pop_front();
+            }
+            break;
+        }
+        CHECK(d.size() == (int)ref.size());
+    }
+    for (; !ref.empty(); ref.pop_front()) CHECK(d.steal(x) && x == ref.front());
+    CHECK(d.isEmpty() && !d.steal(x) && !d.removeLast(x));
+}
+
+/**
+ * The owner pushes N numbered items in bursts and pops some of them back while THIEVES
+ * threads steal; afterwards every number must have been taken exactly once.
+ */
+static void testOwnerAndThieves()
+{
+    const int N = 200000, THIEVES = 3;
+    WorkStealingDeque<int> d(4);
+    std::vector<std::atomic<int>> taken(N);
+    for (int i = 0; i < N; ++i) taken[i].store(0, std::memory_order_relaxed);
+    std::atomic<int> total(0);
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> thieves;
+    for (int k = 0; k < THIEVES; ++k)
+        thieves.push_back(std::thread([&]()
+        {
+            int x;
+            while (!done.load(std::memory_order_acquire))
+                if (d.steal(x)) taken[x].fetch_add(1), total.fetch_add(1);
+                else std::this_thread::yield();
+        }));
+
+    TestRandom random;
+    int x;
+    for (int next = 0; next < N;)
+    {
+        // bursts larger than the initial capacity make the owner grow while thieves read
+        for (int burst = 1 + random.below(64); burst > 0 && next < N; --burst) d.addLast(next++);
+        for (int pops = random.below(32); pops > 0; --pops)
+            if (d.removeLast(x)) taken[x].fetch_add(1), total.fetch_add(1);
+        if (random.below(8) == 0) std::this_thread::yield();
+    }
+    while (d.removeLast(x)) taken[x].fetch_add(1), total.fetch_add(1);
+    // a failed removeLast can mean a thief is finishing the last steal
+    while (total.load() < N) std::this_thread::yield();
+    done.store(true, std::memory_order_release);
+    for (size_t k = 0; k < thieves.size(); ++k) thieves[k].join();
+
+    CHECK(total.load() == N);
+    for (int i = 0; i < N; ++i) CHECK(taken[i].load() == 1);
+    CHECK(d.isEmpty());
+}
+
+/**
+ * Slots hold pointers in practice: a stolen pointer's target must be fully visible.
+ */
+static void testPublishesPointees()
+{
+    const int N = 50000;
+    WorkStealingDeque<std::vector<int> *> d;
+    std::atomic<long long> sum(0);
+    std::atomic<int> count(0);
+    std::thread thief([&]()
+    {
+        std::vector<int> *v;
+        while (count.load() < N)
+            if (d.steal(v)) sum.fetch_add((*v)[0] + (*v)[1]), count.fetch_add(1), delete v;
+            else std::this_thread::yield();
+    });
+    std::vector<int> *v;
+    for (int i = 0; i < N; ++i)
+    {
+        d.addLast(new std::vector<int>{ i, 1 });
+        if (i % 3 == 0 && d.removeLast(v)) sum.fetch_add((*v)[0] + (*v)[1]), count.fetch_add(1), delete v;
+    }
+    thief.join();
+    CHECK(sum.load() == (long long)N * (N - 1) / 2 + N);
+}
+
+int main()
+{
+    testSingleThread();
+    testOwnerAndThieves();
+    testPublishesPointees();
+    std::puts("WorkStealingDequeTest: ok");
+    return 0;
+}